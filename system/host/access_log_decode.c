@@ -0,0 +1,181 @@
+#include "src/access_log.h"
+#include "src/crc32.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Decodifica o registro de eventos de acesso.
+ *
+ * Lê a saída do comando "log dump" capturada do console (linhas "L <base64>";
+ * as demais são ignoradas) ou, com -f, uma imagem da região de dados da flash
+ * (o arquivo de ALPHA_SIM_FLASH ou uma cópia da placa), e imprime um evento
+ * por linha em ordem de sequência.
+ *
+ * Uso: access_log_decode [-c] [captura.txt | -f flash.bin]
+ *   -c  saída em CSV
+ */
+
+static const char *type_name(uint8_t type) {
+  switch (type) {
+  case LOG_EVENT_BOOT: return "boot";
+  case LOG_EVENT_ACCESS: return "access";
+  case LOG_EVENT_LOCK: return "lock";
+  case LOG_EVENT_UNLOCK: return "unlock";
+  case LOG_EVENT_FAULT: return "fault";
+  case LOG_EVENT_CRED_ADD: return "cred_add";
+  case LOG_EVENT_CRED_REVOKE: return "cred_revoke";
+  }
+  return "?";
+}
+
+static const char *result_name(uint8_t result) {
+  switch (result) {
+  case LOG_RESULT_OK: return "ok";
+  case LOG_RESULT_DENIED: return "denied";
+  case LOG_RESULT_TIMEOUT: return "timeout";
+  }
+  return "?";
+}
+
+// Fatores aprovados (acesso) ou componentes com falha (diagnóstico)
+static void flags_text(const access_log_record_t *r, char *dst, size_t size) {
+  static const char *factors[] = {"code", "voice", "iris"};
+  static const char *faults[] = {"keypad", "buzzer", "iris"};
+  const char **names = r->type == LOG_EVENT_FAULT ? faults : factors;
+  size_t n = 0;
+  dst[0] = '\0';
+  if (r->type != LOG_EVENT_ACCESS && r->type != LOG_EVENT_FAULT) {
+    snprintf(dst, size, "%s", r->type == LOG_EVENT_CRED_ADD ? (r->flags ? "admin" : "user") : "-");
+    return;
+  }
+  for (int i = 0; i < 3; ++i)
+    if (r->flags & (1u << i))
+      n += snprintf(dst + n, n < size ? size - n : 0, "%s%s", n ? "+" : "", names[i]);
+  if (n == 0)
+    snprintf(dst, size, "-");
+}
+
+static bool record_valid(const access_log_record_t *r) {
+  return r->seq != 0xFFFFFFFFu && r->check == (uint16_t)crc32_update(0, r, offsetof(access_log_record_t, check));
+}
+
+static int base64_value(char c) {
+  if (c >= 'A' && c <= 'Z') return c - 'A';
+  if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+  if (c >= '0' && c <= '9') return c - '0' + 52;
+  if (c == '+') return 62;
+  if (c == '/') return 63;
+  return -1;
+}
+
+static bool base64_record(const char *text, access_log_record_t *r) {
+  uint8_t *out = (uint8_t *)r;
+  size_t n = 0;
+  uint32_t acc = 0;
+  int bits = 0;
+  for (const char *c = text; *c && *c != '=' && *c != '\n' && *c != '\r'; ++c) {
+    int v = base64_value(*c);
+    if (v < 0)
+      return false;
+    acc = acc << 6 | (uint32_t)v;
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      if (n == sizeof(*r))
+        return false;
+      out[n++] = (uint8_t)(acc >> bits);
+    }
+  }
+  return n == sizeof(*r);
+}
+
+static int by_seq(const void *a, const void *b) {
+  uint32_t x = ((const access_log_record_t *)a)->seq, y = ((const access_log_record_t *)b)->seq;
+  return x < y ? -1 : x > y;
+}
+
+int main(int argc, char **argv) {
+  bool csv = false, image = false;
+  const char *path = NULL;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-c") == 0)
+      csv = true;
+    else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+      image = true, path = argv[++i];
+    else if (argv[i][0] != '-')
+      path = argv[i];
+    else {
+      fprintf(stderr, "uso: %s [-c] [captura.txt | -f flash.bin]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  FILE *f = path ? fopen(path, image ? "rb" : "r") : stdin;
+  if (f == NULL) {
+    perror(path);
+    return 1;
+  }
+
+  size_t cap = ACCESS_LOG_SECTORS * ACCESS_LOG_PER_SECTOR, count = 0, invalid = 0;
+  access_log_record_t *records = malloc(cap * sizeof(*records));
+  if (image) {
+    // A região do registro começa em ACCESS_LOG_FLASH_OFFSET na imagem
+    if (fseek(f, ACCESS_LOG_FLASH_OFFSET, SEEK_SET) != 0) {
+      perror(path);
+      return 1;
+    }
+    access_log_record_t r;
+    for (size_t i = 0; i < cap && fread(&r, sizeof(r), 1, f) == 1; ++i) {
+      if (r.seq == 0xFFFFFFFFu)
+        continue;
+      if (record_valid(&r))
+        records[count++] = r;
+      else
+        ++invalid;
+    }
+  } else {
+    char line[256];
+    while (fgets(line, sizeof(line), f) != NULL) {
+      if (strncmp(line, "L ", 2) != 0)
+        continue;
+      if (count == cap)
+        records = realloc(records, (cap *= 2) * sizeof(*records));
+      if (base64_record(line + 2, &records[count]) && record_valid(&records[count]))
+        ++count;
+      else
+        ++invalid;
+    }
+  }
+  if (f != stdin)
+    fclose(f);
+  qsort(records, count, sizeof(*records), by_seq);
+
+  // Capturas com mais de um "log dump" repetem registros
+  size_t unique = 0;
+  for (size_t i = 0; i < count; ++i)
+    if (unique == 0 || memcmp(&records[i], &records[unique - 1], sizeof(*records)) != 0)
+      records[unique++] = records[i];
+  count = unique;
+
+  if (csv)
+    printf("seq,boot,time_ms,type,result,user,flags,entry_us,check_us,voice_us,iris_us,decision_ms\n");
+  else
+    printf("%8s %4s %12s %-11s %-7s %5s %-16s %10s %8s %10s %10s %10s\n", "seq", "boot", "tempo (ms)", "evento",
+           "result", "user", "fatores/falhas", "senha us", "verif us", "voz us", "iris us", "decisao ms");
+  for (size_t i = 0; i < count; ++i) {
+    const access_log_record_t *r = &records[i];
+    char flags[40];
+    flags_text(r, flags, sizeof(flags));
+    printf(csv ? "%u,%u,%u,%s,%s,%u,%s,%u,%u,%u,%u,%u\n"
+               : "%8u %4u %12u %-11s %-7s %5u %-16s %10u %8u %10u %10u %10u\n",
+           r->seq, r->boot, r->time_ms, type_name(r->type), result_name(r->result), r->user, flags,
+           r->stage_us[LOG_STAGE_ENTRY], r->check_us, r->stage_us[LOG_STAGE_VOICE], r->stage_us[LOG_STAGE_IRIS],
+           r->decision_ms);
+  }
+  if (invalid)
+    fprintf(stderr, "%zu registros inválidos ignorados\n", invalid);
+  free(records);
+  return 0;
+}
@@ -0,0 +1,49 @@
+#include "src/audio_features.h"
+#include "wav.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Passa um arquivo WAV pelo extrator de características da placa e imprime
+ * um vetor por quadro (CSV). O áudio é reamostrado para AUDIO_SAMPLE_RATE_HZ
+ * pelo vizinho mais próximo e convertido para a faixa de 12 bits do ADC em
+ * torno do nível de polarização do microfone.
+ *
+ * Uso: audio_features_wav <arquivo.wav> [polarização, padrão 2048]
+ */
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "uso: %s <arquivo.wav> [polarização]\n", argv[0]);
+    return 2;
+  }
+  wav_t wav;
+  if (!wav_load(argv[1], &wav))
+    return 1;
+  int bias = argc > 2 ? atoi(argv[2]) : 2048;
+
+  audio_features_t af;
+  audio_frame_t frame;
+  audio_features_init(&af);
+
+  printf("t_ms,rms,zcr");
+  for (uint b = 0; b < AUDIO_BANDS; ++b)
+    printf(",b%u", audio_band_hz(b));
+  printf(",dc\n");
+
+  size_t n = wav_adc_length(&wav, AUDIO_SAMPLE_RATE_HZ);
+  unsigned frames = 0;
+  for (size_t i = 0; i < n; ++i) {
+    if (!audio_features_push(&af, wav_adc_sample(&wav, i, AUDIO_SAMPLE_RATE_HZ, bias), &frame))
+      continue;
+    printf("%u,%u,%u", frames * AUDIO_FRAME_SAMPLES * 1000u / AUDIO_SAMPLE_RATE_HZ, frame.rms, frame.zcr);
+    for (uint b = 0; b < AUDIO_BANDS; ++b)
+      printf(",%u", frame.band[b]);
+    printf(",%u\n", frame.dc);
+    ++frames;
+  }
+
+  wav_free(&wav);
+  return 0;
+}
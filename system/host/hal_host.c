@@ -0,0 +1,1348 @@
+#define _GNU_SOURCE
+#include "src/hal/hal.h"
+#include "iris_file.h"
+#include "wav.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Implementação da HAL para o simulador em Linux.
+ *
+ * O tempo é um relógio virtual em microssegundos: as esperas o avançam
+ * instantaneamente e cada acesso de polling a um periférico custa
+ * SIM_POLL_COST_US, de modo que laços de espera ativa também progridem.
+ * Entradas vêm de um roteiro (ALPHA_SIM_SCRIPT) com eventos temporizados e
+ * da entrada padrão (repassada como stdio USB); saídas vão para arquivos em
+ * ALPHA_SIM_OUT (oled.pbm, matrix.txt) e para um log em stderr.
+ *
+ * Variáveis de ambiente:
+ *   ALPHA_SIM_SCRIPT       roteiro de eventos ("<ms> press|release <pino>",
+ *                          "<ms> adc <canal> <valor>", "<ms> usb|uart <texto, \n = fim de linha>",
+ *                          "<ms> tone <canal> <Hz> <amplitude> <duração ms>",
+ *                          "<ms> wav <canal> <arquivo.wav>", "<ms> noise <canal> <amplitude>",
+ *                          "<ms> keypad <teclas fechadas, ex. 15#, ou ->",
+ *                          "<ms> iris <arquivo.iris, ou - para tirar o olho do leitor>",
+ *                          "<ms> quit"); linhas iniciadas por '#' são ignoradas
+ *   ALPHA_SIM_OUT          diretório de saída (padrão: diretório atual)
+ *   ALPHA_SIM_DURATION_MS  encerra a simulação neste instante virtual
+ *   ALPHA_SIM_REALTIME     se 1, segura o relógio virtual ao tempo real
+ *   ALPHA_SIM_UART_PTY     se 1, expõe a UART em um pseudo-terminal
+ *   ALPHA_SIM_QUIET        se 1, suprime o log de eventos em stderr
+ *   ALPHA_SIM_FLASH        arquivo que guarda a região de dados da flash entre
+ *                          execuções (padrão: flash apagada a cada execução)
+ */
+
+#define SIM_NUM_GPIO       30
+#define SIM_NUM_ADC        5
+#define SIM_CLK_SYS_HZ     125000000
+#define SIM_POLL_COST_US   1
+#define SIM_QUEUE_SIZE     4096
+#define SIM_MATRIX_LEDS    25
+#define SIM_WS2812_WORD_US 30     // 24 bits a 800 kHz
+#define SIM_WS2812_RESET_US 50
+#define SIM_KEYPAD_LAYOUT  "123A456B789C*0#D"   // Teclas por linha, como em src/keypad.c
+#define SIM_KEYPAD_FIFO    8
+#define SIM_OLED_ADDRESS   0x3C
+#define SIM_OLED_WIDTH     128
+#define SIM_OLED_PAGES     8
+#define SIM_MAX_STREAMS    4
+#define SIM_FLASH_ERASE_US 45000  // Apagamento de um setor de 4 KB
+#define SIM_FLASH_PAGE_US  700    // Gravação de uma página de 256 bytes
+
+typedef enum {
+  EV_PRESS,
+  EV_RELEASE,
+  EV_ADC,
+  EV_TONE,
+  EV_WAV,
+  EV_NOISE,
+  EV_KEYPAD,
+  EV_IRIS,
+  EV_USB,
+  EV_UART,
+  EV_QUIT
+} sim_event_type_t;
+
+typedef struct {
+  uint64_t time_us;
+  sim_event_type_t type;
+  int arg1, arg2, arg3;
+  uint64_t duration_us;
+  char text[64];
+  wav_t *wav;
+  uint32_t *iris;       // Código e máscara (NULL: olho fora do leitor)
+} sim_event_t;
+
+typedef struct {
+  char data[SIM_QUEUE_SIZE];
+  size_t head, tail;
+  bool fresh;           // Chegaram dados desde a última notificação
+} sim_queue_t;
+
+typedef struct {
+  uint bus;
+  hal_callback_t done;
+  void *ctx;
+} sim_stream_t;
+
+// Relógio virtual e configuração
+static uint64_t now_us;
+static uint64_t duration_us;
+static bool realtime, quiet, ready;
+static struct timespec start_real;
+static const char *out_dir = ".";
+
+// Roteiro de eventos
+static sim_event_t *events;
+static size_t event_count, event_next;
+
+// GPIO
+static bool gpio_level[SIM_NUM_GPIO];
+static bool gpio_is_output[SIM_NUM_GPIO];
+static uint32_t gpio_irq_mask[SIM_NUM_GPIO];
+static uint32_t gpio_irq_pending[SIM_NUM_GPIO];
+static hal_gpio_irq_t gpio_irq_callback;
+static bool in_irq;
+
+// ADC
+static uint16_t adc_value[SIM_NUM_ADC] = {2048, 2048, 1800, 0, 0};
+static uint adc_channel;
+
+// Sinal de áudio somado ao nível do canal (tom senoidal ou arquivo WAV)
+typedef struct {
+  uint64_t start_us, end_us;
+  uint32_t freq_hz;
+  int amplitude;
+  const wav_t *wav;
+} sim_audio_t;
+static sim_audio_t adc_audio[SIM_NUM_ADC];
+static int adc_noise[SIM_NUM_ADC];      // Amplitude do ruído uniforme somado ao canal
+static uint32_t noise_state = 2463534242u;
+
+// Fluxo contínuo do ADC: o anel é preenchido sob demanda até o instante atual
+static uint16_t *adc_ring;
+static size_t adc_ring_len;
+static uint adc_order[SIM_NUM_ADC], adc_order_len;
+static uint64_t adc_start_us, adc_written;
+static uint32_t adc_total_rate;
+
+// PWM
+static float pwm_clkdiv[SIM_NUM_GPIO];
+static uint16_t pwm_wrap[SIM_NUM_GPIO], pwm_level[SIM_NUM_GPIO];
+
+// UART / stdio
+static sim_queue_t usb_rx, uart_rx;
+static bool stdin_open = true;
+static int pty_master = -1;
+static uint uart_baud;
+static uint uart_stream_uart;
+static uint64_t uart_stream_end_us;   // Fim da transmissão por "DMA" em andamento
+// Teclado matricial: contatos fechados pelo roteiro e leituras na "FIFO RX" da varredura
+static uint16_t keypad_switches;
+static uint16_t keypad_last_scan;
+static uint16_t keypad_fifo[SIM_KEYPAD_FIFO];
+static unsigned keypad_fifo_count;
+static hal_callback_t keypad_handler;
+static void *keypad_ctx;
+
+// Leitor de íris: código do olho diante do sensor (NULL: nenhum)
+static const uint32_t *iris_eye;
+
+static hal_callback_t uart_rx_handler, usb_rx_handler;
+static void *uart_rx_ctx, *usb_rx_ctx;
+static bool uart_rx_irq_on;
+static uint64_t input_poll_us;
+
+// I2C
+static uint i2c_baud[2] = {100000, 100000};
+static sim_stream_t streams[SIM_MAX_STREAMS];
+static int stream_count;
+
+// Modelo do SSD1306
+static uint8_t oled_ram[SIM_OLED_PAGES][SIM_OLED_WIDTH];
+static uint8_t oled_mode = 2, oled_col0, oled_col1 = SIM_OLED_WIDTH - 1, oled_page0, oled_page1 = SIM_OLED_PAGES - 1;
+static uint8_t oled_col, oled_page;
+static uint8_t oled_cmd[3];
+static uint8_t oled_cmd_len, oled_cmd_need;
+static bool oled_on;
+
+// Flash
+static uint8_t flash_data[HAL_FLASH_DATA_SIZE] __attribute__((aligned(4)));
+static const char *flash_path;
+static unsigned oled_frames;
+
+// Alarmes do timer; as últimas HAL_MAX_TIMERS posições são os temporizadores periódicos
+typedef struct {
+  int id;
+  uint64_t time_us;
+  uint32_t period_us;   // 0 para alarmes de disparo único
+  hal_callback_t callback;
+  void *ctx;
+} sim_alarm_t;
+static sim_alarm_t alarms[HAL_MAX_ALARMS + HAL_MAX_TIMERS];
+static int alarm_next_id = 1;
+
+// Matriz WS2812
+static uint32_t matrix_frame[SIM_MATRIX_LEDS];
+static int matrix_index;
+static uint64_t matrix_last_put_us;
+
+/*=========*/
+/* Log     */
+/*=========*/
+
+static void sim_log(const char *fmt, ...) {
+  if (quiet)
+    return;
+  va_list args;
+  va_start(args, fmt);
+  fprintf(stderr, "[sim %8llu.%03llu ms] ", (unsigned long long)(now_us / 1000), (unsigned long long)(now_us % 1000));
+  vfprintf(stderr, fmt, args);
+  fputc('\n', stderr);
+  va_end(args);
+}
+
+/*==========*/
+/* Filas    */
+/*==========*/
+
+static void queue_push(sim_queue_t *q, char c) {
+  size_t next = (q->head + 1) % SIM_QUEUE_SIZE;
+  if (next != q->tail) {
+    q->data[q->head] = c;
+    q->head = next;
+    q->fresh = true;
+  }
+}
+
+static int queue_pop(sim_queue_t *q) {
+  if (q->head == q->tail)
+    return HAL_NO_CHAR;
+  char c = q->data[q->tail];
+  q->tail = (q->tail + 1) % SIM_QUEUE_SIZE;
+  return (unsigned char)c;
+}
+
+static bool queue_empty(const sim_queue_t *q) {
+  return q->head == q->tail;
+}
+
+// Transfere o que estiver disponível em fd para a fila, sem bloquear
+static bool drain_fd(int fd, sim_queue_t *q) {
+  struct pollfd pfd = {.fd = fd, .events = POLLIN};
+  char buf[256];
+  while (poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLIN | POLLHUP))) {
+    ssize_t n = read(fd, buf, sizeof(buf));
+    if (n <= 0)
+      return n < 0 && (errno == EAGAIN || errno == EIO);
+    for (ssize_t i = 0; i < n; ++i)
+      queue_push(q, buf[i]);
+  }
+  return true;
+}
+
+static void poll_inputs(void) {
+  if (stdin_open)
+    stdin_open = drain_fd(STDIN_FILENO, &usb_rx);
+  if (pty_master >= 0)
+    drain_fd(pty_master, &uart_rx);
+}
+
+/*==========*/
+/* Roteiro  */
+/*==========*/
+
+static void load_script(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    fprintf(stderr, "sim: não foi possível abrir o roteiro '%s'\n", path);
+    exit(1);
+  }
+  char line[256];
+  size_t capacity = 0;
+  unsigned line_no = 0;
+  while (fgets(line, sizeof(line), f)) {
+    ++line_no;
+    char *p = line;
+    while (*p == ' ' || *p == '\t')
+      ++p;
+    if (*p == '#' || *p == '\n' || *p == '\0')
+      continue;
+
+    sim_event_t ev = {0};
+    double ms;
+    char cmd[16];
+    int consumed = 0;
+    if (sscanf(p, "%lf %15s %n", &ms, cmd, &consumed) < 2) {
+      fprintf(stderr, "sim: roteiro:%u: linha inválida\n", line_no);
+      exit(1);
+    }
+    ev.time_us = (uint64_t)(ms * 1000.0);
+    char *rest = p + consumed;
+    rest[strcspn(rest, "\r\n")] = '\0';
+
+    if (strcmp(cmd, "press") == 0 || strcmp(cmd, "release") == 0) {
+      ev.type = cmd[0] == 'p' ? EV_PRESS : EV_RELEASE;
+      ev.arg1 = atoi(rest);
+    } else if (strcmp(cmd, "adc") == 0) {
+      ev.type = EV_ADC;
+      if (sscanf(rest, "%d %d", &ev.arg1, &ev.arg2) != 2 || ev.arg1 < 0 || ev.arg1 >= SIM_NUM_ADC) {
+        fprintf(stderr, "sim: roteiro:%u: uso: <ms> adc <canal> <valor>\n", line_no);
+        exit(1);
+      }
+    } else if (strcmp(cmd, "usb") == 0 || strcmp(cmd, "uart") == 0) {
+      ev.type = cmd[1] == 's' ? EV_USB : EV_UART;
+      // "\n" no texto vira fim de linha (comandos do console)
+      size_t n = 0;
+      for (const char *c = rest; *c && n + 1 < sizeof(ev.text); ++c) {
+        if (c[0] == '\\' && c[1] == 'n') {
+          ev.text[n++] = '\n';
+          ++c;
+        } else {
+          ev.text[n++] = *c;
+        }
+      }
+      ev.text[n] = '\0';
+    } else if (strcmp(cmd, "tone") == 0) {
+      ev.type = EV_TONE;
+      double duration_ms;
+      if (sscanf(rest, "%d %d %d %lf", &ev.arg1, &ev.arg2, &ev.arg3, &duration_ms) != 4 ||
+          ev.arg1 < 0 || ev.arg1 >= SIM_NUM_ADC) {
+        fprintf(stderr, "sim: roteiro:%u: uso: <ms> tone <canal> <Hz> <amplitude> <duração ms>\n", line_no);
+        exit(1);
+      }
+      ev.duration_us = (uint64_t)(duration_ms * 1000.0);
+    } else if (strcmp(cmd, "wav") == 0) {
+      ev.type = EV_WAV;
+      char path[sizeof(ev.text)];
+      if (sscanf(rest, "%d %63s", &ev.arg1, path) != 2 || ev.arg1 < 0 || ev.arg1 >= SIM_NUM_ADC) {
+        fprintf(stderr, "sim: roteiro:%u: uso: <ms> wav <canal> <arquivo.wav>\n", line_no);
+        exit(1);
+      }
+      ev.wav = malloc(sizeof(*ev.wav));
+      if (!wav_load(path, ev.wav))
+        exit(1);
+      ev.duration_us = ev.wav->count * 1000000ull / ev.wav->rate_hz;
+      snprintf(ev.text, sizeof(ev.text), "%s", path);
+    } else if (strcmp(cmd, "noise") == 0) {
+      ev.type = EV_NOISE;
+      if (sscanf(rest, "%d %d", &ev.arg1, &ev.arg2) != 2 || ev.arg1 < 0 || ev.arg1 >= SIM_NUM_ADC) {
+        fprintf(stderr, "sim: roteiro:%u: uso: <ms> noise <canal> <amplitude>\n", line_no);
+        exit(1);
+      }
+    } else if (strcmp(cmd, "keypad") == 0) {
+      ev.type = EV_KEYPAD;
+      ev.arg1 = 0;
+      for (const char *k = rest; *k && *k != '-' && *k != ' '; ++k) {
+        const char *pos = strchr(SIM_KEYPAD_LAYOUT, *k);
+        if (pos == NULL) {
+          fprintf(stderr, "sim: roteiro:%u: tecla '%c' não existe em %s\n", line_no, *k, SIM_KEYPAD_LAYOUT);
+          exit(1);
+        }
+        ev.arg1 |= 1 << (pos - SIM_KEYPAD_LAYOUT);
+      }
+    } else if (strcmp(cmd, "iris") == 0) {
+      ev.type = EV_IRIS;
+      char path[sizeof(ev.text)];
+      if (sscanf(rest, "%63s", path) != 1) {
+        fprintf(stderr, "sim: roteiro:%u: uso: <ms> iris <arquivo.iris | ->\n", line_no);
+        exit(1);
+      }
+      if (strcmp(path, "-") != 0) {
+        ev.iris = malloc(2 * HAL_IRIS_CODE_WORDS * sizeof(uint32_t));
+        if (!iris_file_load(path, ev.iris, ev.iris + HAL_IRIS_CODE_WORDS))
+          exit(1);
+      }
+      snprintf(ev.text, sizeof(ev.text), "%s", path);
+    } else if (strcmp(cmd, "quit") == 0) {
+      ev.type = EV_QUIT;
+    } else {
+      fprintf(stderr, "sim: roteiro:%u: comando desconhecido '%s'\n", line_no, cmd);
+      exit(1);
+    }
+
+    if (event_count == capacity) {
+      capacity = capacity ? capacity * 2 : 32;
+      events = realloc(events, capacity * sizeof(*events));
+    }
+    events[event_count++] = ev;
+  }
+  fclose(f);
+}
+
+static void set_input_level(uint pin, bool level) {
+  if (pin >= SIM_NUM_GPIO || gpio_level[pin] == level)
+    return;
+  gpio_level[pin] = level;
+  uint32_t edge = level ? HAL_GPIO_EDGE_RISE : HAL_GPIO_EDGE_FALL;
+  if (gpio_irq_mask[pin] & edge)
+    gpio_irq_pending[pin] |= edge;
+}
+
+/*
+ * Leitura do teclado sem diodos: com a linha r em nível 0, uma coluna lê 0 se
+ * houver caminho até r por contatos fechados, o que inclui os fantasmas
+ * (r -> coluna -> outra linha -> outra coluna).
+ */
+static uint16_t keypad_scan(uint16_t switches) {
+  uint16_t scan = 0;
+  for (uint row = 0; row < HAL_KEYPAD_ROWS; ++row) {
+    uint rows = 1u << row, cols = 0, prev_rows = 0;
+    while (rows != prev_rows) {
+      prev_rows = rows;
+      for (uint r = 0; r < HAL_KEYPAD_ROWS; ++r)
+        if (rows & (1u << r))
+          cols |= (switches >> (r * HAL_KEYPAD_COLS)) & 0xF;
+      for (uint r = 0; r < HAL_KEYPAD_ROWS; ++r)
+        if ((switches >> (r * HAL_KEYPAD_COLS)) & cols)
+          rows |= 1u << r;
+    }
+    scan |= (uint16_t)(cols << (row * HAL_KEYPAD_COLS));
+  }
+  return scan;
+}
+
+// Como a PIO: só leituras diferentes da última enviada entram na FIFO
+static void keypad_update(void) {
+  uint16_t scan = keypad_scan(keypad_switches);
+  if (keypad_handler == NULL || scan == keypad_last_scan || keypad_fifo_count == SIM_KEYPAD_FIFO)
+    return;
+  keypad_last_scan = scan;
+  keypad_fifo[keypad_fifo_count++] = scan;
+}
+
+static void run_event(const sim_event_t *ev) {
+  switch (ev->type) {
+    case EV_PRESS:
+      sim_log("gpio %d pressionado", ev->arg1);
+      set_input_level(ev->arg1, false);
+      break;
+    case EV_RELEASE:
+      sim_log("gpio %d solto", ev->arg1);
+      set_input_level(ev->arg1, true);
+      break;
+    case EV_ADC:
+      adc_value[ev->arg1] = ev->arg2;
+      break;
+    case EV_TONE:
+      sim_log("adc %d: tom de %d Hz, amplitude %d", ev->arg1, ev->arg2, ev->arg3);
+      adc_audio[ev->arg1] = (sim_audio_t){now_us, now_us + ev->duration_us, ev->arg2, ev->arg3, NULL};
+      break;
+    case EV_NOISE:
+      sim_log("adc %d: ruído de amplitude %d", ev->arg1, ev->arg2);
+      adc_noise[ev->arg1] = ev->arg2;
+      break;
+    case EV_WAV:
+      sim_log("adc %d: reproduzindo %s", ev->arg1, ev->text);
+      adc_audio[ev->arg1] = (sim_audio_t){now_us, now_us + ev->duration_us, 0, 0, ev->wav};
+      break;
+    case EV_USB:
+      for (const char *c = ev->text; *c; ++c)
+        queue_push(&usb_rx, *c);
+      break;
+    case EV_UART:
+      for (const char *c = ev->text; *c; ++c)
+        queue_push(&uart_rx, *c);
+      break;
+    case EV_KEYPAD:
+      sim_log("teclado: contatos 0x%04x", ev->arg1);
+      keypad_switches = (uint16_t)ev->arg1;
+      keypad_update();
+      break;
+    case EV_IRIS:
+      if (ev->iris != NULL)
+        sim_log("íris: olho %s no leitor", ev->text);
+      else
+        sim_log("íris: leitor vazio");
+      iris_eye = ev->iris;
+      break;
+    case EV_QUIT:
+      sim_log("fim do roteiro");
+      fflush(stdout);
+      exit(0);
+  }
+}
+
+// Entrega as interrupções de GPIO pendentes; como no hardware, não há aninhamento
+static void dispatch_irqs(void) {
+  if (in_irq)
+    return;
+  for (uint pin = 0; gpio_irq_callback != NULL && pin < SIM_NUM_GPIO; ++pin) {
+    uint32_t pending = gpio_irq_pending[pin];
+    if (pending) {
+      gpio_irq_pending[pin] = 0;
+      in_irq = true;
+      gpio_irq_callback(pin, pending);
+      in_irq = false;
+    }
+  }
+
+  if (keypad_handler != NULL && keypad_fifo_count > 0) {
+    in_irq = true;
+    keypad_handler(keypad_ctx);
+    in_irq = false;
+  }
+
+  // Com recepção por interrupção, a entrada padrão e o pty são lidos a cada 1 ms virtual
+  if (uart_rx_handler == NULL && usb_rx_handler == NULL)
+    return;
+  if (now_us - input_poll_us >= 1000) {
+    input_poll_us = now_us;
+    poll_inputs();
+  }
+  // A UART interrompe enquanto houver dados (nível); a USB avisa só quando chegam dados novos
+  if (uart_rx_handler != NULL && uart_rx_irq_on && !queue_empty(&uart_rx)) {
+    uart_rx.fresh = false;
+    in_irq = true;
+    uart_rx_handler(uart_rx_ctx);
+    in_irq = false;
+  }
+  if (usb_rx_handler != NULL && usb_rx.fresh) {
+    usb_rx.fresh = false;
+    in_irq = true;
+    usb_rx_handler(usb_rx_ctx);
+    in_irq = false;
+  }
+}
+
+/*=================*/
+/* Relógio virtual */
+/*=================*/
+
+static void flash_load(const char *path);
+
+__attribute__((constructor))
+static void sim_setup(void) {
+  if (ready)
+    return;
+  ready = true;
+
+  const char *env = getenv("ALPHA_SIM_OUT");
+  if (env != NULL && *env)
+    out_dir = env;
+  env = getenv("ALPHA_SIM_DURATION_MS");
+  if (env != NULL)
+    duration_us = strtoull(env, NULL, 10) * 1000ull;
+  env = getenv("ALPHA_SIM_REALTIME");
+  realtime = env != NULL && atoi(env) == 1;
+  env = getenv("ALPHA_SIM_QUIET");
+  quiet = env != NULL && atoi(env) == 1;
+  env = getenv("ALPHA_SIM_SCRIPT");
+  if (env != NULL && *env)
+    load_script(env);
+  env = getenv("ALPHA_SIM_FLASH");
+  flash_load(env != NULL && *env ? env : NULL);
+
+  for (uint pin = 0; pin < SIM_NUM_GPIO; ++pin)
+    pwm_clkdiv[pin] = 1.0f;
+  clock_gettime(CLOCK_MONOTONIC, &start_real);
+}
+
+// Próximo alarme ativo com instante <= limit, ou NULL
+static sim_alarm_t *next_alarm(uint64_t limit) {
+  sim_alarm_t *next = NULL;
+  for (int i = 0; i < HAL_MAX_ALARMS + HAL_MAX_TIMERS; ++i)
+    if (alarms[i].callback != NULL && alarms[i].time_us <= limit &&
+        (next == NULL || alarms[i].time_us < next->time_us))
+      next = &alarms[i];
+  return next;
+}
+
+/*
+ * Amostragem do PC pelo relógio virtual: cada função da HAL em que o tempo
+ * passa registra o ponto da aplicação que a chamou (SIM_CALLER), e os
+ * instantes de amostragem que caem nesse tempo são atribuídos a ele.
+ */
+static hal_pc_sample_t pc_sample;
+static uint64_t pc_period_us, pc_next_us;
+static uintptr_t sim_pc;
+#define SIM_CALLER() (sim_pc = (uintptr_t)__builtin_return_address(0))
+
+static void sim_set_time(uint64_t t) {
+  while (pc_sample != NULL && pc_next_us <= t) {
+    pc_sample(sim_pc);
+    pc_next_us += pc_period_us;
+  }
+  now_us = t;
+}
+
+static void sim_advance(uint64_t us) {
+  uint64_t target = now_us + us;
+
+  // Alarmes disparam no instante exato, em ordem, como interrupções não aninhadas
+  sim_alarm_t *alarm;
+  while (!in_irq && (alarm = next_alarm(target)) != NULL) {
+    if (alarm->time_us > now_us)
+      sim_set_time(alarm->time_us);
+    hal_callback_t callback = alarm->callback;
+    if (alarm->period_us)
+      alarm->time_us += alarm->period_us;
+    else
+      alarm->callback = NULL;
+    uintptr_t pc = sim_pc;
+    in_irq = true;
+    callback(alarm->ctx);
+    in_irq = false;
+    sim_pc = pc;
+  }
+  if (target > now_us)
+    sim_set_time(target);
+
+  while (event_next < event_count && events[event_next].time_us <= now_us)
+    run_event(&events[event_next++]);
+  dispatch_irqs();
+
+  if (duration_us && now_us >= duration_us) {
+    sim_log("duração da simulação atingida");
+    fflush(stdout);
+    exit(0);
+  }
+
+  if (realtime) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t real_us = (uint64_t)(ts.tv_sec - start_real.tv_sec) * 1000000ull +
+                       (ts.tv_nsec - start_real.tv_nsec) / 1000;
+    if (now_us > real_us + 2000)
+      usleep(now_us - real_us);
+  }
+}
+
+uint32_t hal_time_us_32(void) {
+  SIM_CALLER();
+  sim_advance(SIM_POLL_COST_US);
+  return (uint32_t)now_us;
+}
+
+// Leitura dos pontos de rastreamento: não pode alterar a linha do tempo simulada
+uint32_t hal_trace_time_us(void) {
+  return (uint32_t)now_us;
+}
+
+uint64_t hal_time_us_64(void) {
+  SIM_CALLER();
+  sim_advance(SIM_POLL_COST_US);
+  return now_us;
+}
+
+uint32_t hal_time_ms(void) {
+  SIM_CALLER();
+  sim_advance(SIM_POLL_COST_US);
+  return (uint32_t)(now_us / 1000);
+}
+
+void hal_busy_wait_us(uint32_t us) {
+  SIM_CALLER();
+  sim_advance(us);
+}
+
+void hal_busy_wait_ms(uint32_t ms) {
+  SIM_CALLER();
+  // Avança em passos de 1 ms para que eventos do roteiro caiam no instante certo
+  for (uint32_t i = 0; i < ms; ++i)
+    sim_advance(1000);
+}
+
+/*
+ * O núcleo 1 é simulado de forma cooperativa: o trabalho sinalizado roda quando
+ * o núcleo 0 vai dormir em hal_wait_until(), de modo que o tempo de renderização
+ * não é contado nos trechos ocupados do núcleo 0.
+ */
+static hal_callback_t core1_work;
+static void *core1_ctx;
+static bool core1_pending;
+static bool in_core1;
+
+void hal_core1_start(hal_callback_t work, void *ctx) {
+  core1_work = work;
+  core1_ctx = ctx;
+  sim_log("núcleo 1 iniciado");
+}
+
+void hal_core1_signal(void) {
+  core1_pending = core1_work != NULL;
+}
+
+uint hal_core_num(void) {
+  return in_core1 ? 1 : 0;
+}
+
+// Avança até o prazo, parando antes se houver um evento do roteiro (que pode gerar interrupção)
+void hal_wait_until(uint64_t deadline_us) {
+  SIM_CALLER();
+  if (core1_pending) {
+    core1_pending = false;
+    in_core1 = true;
+    core1_work(core1_ctx);
+    in_core1 = false;
+  }
+  uint64_t target = deadline_us;
+  if (event_next < event_count && events[event_next].time_us < target)
+    target = events[event_next].time_us;
+  sim_alarm_t *alarm = next_alarm(target);
+  if (alarm != NULL)
+    target = alarm->time_us;
+  sim_advance(target > now_us ? target - now_us : SIM_POLL_COST_US);
+}
+
+uint32_t hal_clock_sys_hz(void) {
+  return SIM_CLK_SYS_HZ;
+}
+
+int hal_alarm_in_us(uint32_t delay_us, hal_callback_t callback, void *ctx) {
+  for (int i = 0; i < HAL_MAX_ALARMS; ++i) {
+    if (alarms[i].callback == NULL) {
+      alarms[i].id = alarm_next_id++;
+      alarms[i].time_us = now_us + delay_us;
+      alarms[i].callback = callback;
+      alarms[i].ctx = ctx;
+      return alarms[i].id;
+    }
+  }
+  return 0;
+}
+
+bool hal_timer_every_us(uint32_t period_us, hal_callback_t callback, void *ctx) {
+  for (int i = HAL_MAX_ALARMS; i < HAL_MAX_ALARMS + HAL_MAX_TIMERS; ++i) {
+    if (alarms[i].callback == NULL) {
+      alarms[i].id = alarm_next_id++;
+      alarms[i].time_us = now_us + period_us;
+      alarms[i].period_us = period_us ? period_us : 1;
+      alarms[i].callback = callback;
+      alarms[i].ctx = ctx;
+      return true;
+    }
+  }
+  return false;
+}
+
+void hal_alarm_cancel(int id) {
+  for (int i = 0; i < HAL_MAX_ALARMS; ++i)
+    if (alarms[i].callback != NULL && alarms[i].id == id)
+      alarms[i].callback = NULL;
+}
+
+// Não há concorrência real no simulador: interrupções só ocorrem dentro de sim_advance()
+uint32_t hal_irq_save(void) {
+  return 0;
+}
+
+void hal_irq_restore(uint32_t state) {
+  (void)state;
+}
+
+/*==================*/
+/* Amostragem do PC */
+/*==================*/
+
+bool hal_pc_sampler_start(uint32_t period_us, hal_pc_sample_t sample) {
+  pc_period_us = period_us ? period_us : 1;
+  pc_next_us = now_us + pc_period_us;
+  pc_sample = sample;
+  sim_log("amostragem do PC a cada %u us", period_us);
+  return true;
+}
+
+void hal_pc_sampler_stop(void) {
+  pc_sample = NULL;
+}
+
+/*=======*/
+/* Flash */
+/*=======*/
+
+// Flash apagada é toda 0xFF; com ALPHA_SIM_FLASH o conteúdo vem do arquivo
+static void flash_load(const char *path) {
+  memset(flash_data, 0xFF, sizeof(flash_data));
+  flash_path = path;
+  if (path == NULL)
+    return;
+  FILE *f = fopen(path, "rb");
+  if (f == NULL)
+    return;
+  size_t n = fread(flash_data, 1, sizeof(flash_data), f);
+  fclose(f);
+  sim_log("flash: %zu bytes carregados de %s", n, path);
+}
+
+static void flash_save(void) {
+  if (flash_path == NULL)
+    return;
+  FILE *f = fopen(flash_path, "wb");
+  if (f == NULL || fwrite(flash_data, 1, sizeof(flash_data), f) != sizeof(flash_data))
+    fprintf(stderr, "sim: não foi possível gravar %s: %s\n", flash_path, strerror(errno));
+  if (f != NULL)
+    fclose(f);
+}
+
+// Com as interrupções mascaradas, alarmes vencidos durante a operação atrasam
+static void flash_busy(uint64_t us) {
+  bool was_in_irq = in_irq;
+  in_irq = true;
+  sim_advance(us);
+  in_irq = was_in_irq;
+}
+
+const uint8_t *hal_flash_data(uint32_t offset) {
+  return &flash_data[offset];
+}
+
+void hal_flash_erase(uint32_t offset, uint32_t len) {
+  SIM_CALLER();
+  if (offset % HAL_FLASH_SECTOR_SIZE || len % HAL_FLASH_SECTOR_SIZE || offset + len > HAL_FLASH_DATA_SIZE) {
+    fprintf(stderr, "sim: apagamento desalinhado na flash (%u, %u)\n", offset, len);
+    abort();
+  }
+  memset(&flash_data[offset], 0xFF, len);
+  flash_busy((uint64_t)(len / HAL_FLASH_SECTOR_SIZE) * SIM_FLASH_ERASE_US);
+  flash_save();
+}
+
+// Como na flash NOR, a gravação só leva bits de 1 para 0
+void hal_flash_program(uint32_t offset, const void *data, uint32_t len) {
+  SIM_CALLER();
+  if (offset % HAL_FLASH_PAGE_SIZE || len % HAL_FLASH_PAGE_SIZE || offset + len > HAL_FLASH_DATA_SIZE) {
+    fprintf(stderr, "sim: gravação desalinhada na flash (%u, %u)\n", offset, len);
+    abort();
+  }
+  const uint8_t *src = data;
+  for (uint32_t i = 0; i < len; ++i)
+    flash_data[offset + i] &= src[i];
+  flash_busy((uint64_t)(len / HAL_FLASH_PAGE_SIZE) * SIM_FLASH_PAGE_US);
+  flash_save();
+}
+
+void hal_random_bytes(void *dst, size_t len) {
+  int fd = open("/dev/urandom", O_RDONLY);
+  ssize_t n = fd >= 0 ? read(fd, dst, len) : -1;
+  if (fd >= 0)
+    close(fd);
+  if (n != (ssize_t)len) {
+    // Sem /dev/urandom: sequência do relógio real, suficiente para a simulação
+    uint8_t *out = dst;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint32_t x = (uint32_t)ts.tv_nsec ^ (uint32_t)ts.tv_sec;
+    for (size_t i = 0; i < len; ++i) {
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      out[i] = (uint8_t)x;
+    }
+  }
+}
+
+/*======*/
+/* GPIO */
+/*======*/
+
+void hal_gpio_init_output(uint pin) {
+  gpio_is_output[pin] = true;
+  gpio_level[pin] = false;
+}
+
+void hal_gpio_init_input_pullup(uint pin) {
+  gpio_is_output[pin] = false;
+  gpio_level[pin] = true;
+}
+
+void hal_gpio_put(uint pin, bool value) {
+  if (gpio_level[pin] != value)
+    sim_log("gpio %u = %d", pin, value);
+  gpio_level[pin] = value;
+}
+
+bool hal_gpio_get(uint pin) {
+  SIM_CALLER();
+  sim_advance(SIM_POLL_COST_US);
+  return gpio_level[pin];
+}
+
+uint32_t hal_gpio_get_all(void) {
+  SIM_CALLER();
+  sim_advance(SIM_POLL_COST_US);
+  uint32_t levels = 0;
+  for (uint pin = 0; pin < SIM_NUM_GPIO; ++pin)
+    levels |= (uint32_t)gpio_level[pin] << pin;
+  return levels;
+}
+
+void hal_gpio_set_irq(uint pin, uint32_t events_mask, hal_gpio_irq_t callback) {
+  gpio_irq_mask[pin] |= events_mask;
+  gpio_irq_callback = callback;
+}
+
+/*=====*/
+/* ADC */
+/*=====*/
+
+void hal_adc_init(void) {
+}
+
+void hal_adc_gpio_init(uint pin) {
+  (void)pin;
+}
+
+void hal_adc_select_input(uint channel) {
+  adc_channel = channel < SIM_NUM_ADC ? channel : 0;
+}
+
+// Valor do canal no instante t: nível do roteiro mais o áudio em reprodução
+static uint16_t adc_sample_at(uint ch, uint64_t t_us) {
+  const sim_audio_t *a = &adc_audio[ch];
+  int value = adc_value[ch];
+  if (t_us >= a->start_us && t_us < a->end_us) {
+    uint64_t dt = t_us - a->start_us;
+    if (a->wav != NULL) {
+      // 16 bits com sinal para a excursão de 12 bits do ADC
+      size_t i = (size_t)(dt * a->wav->rate_hz / 1000000u);
+      if (i < a->wav->count)
+        value += a->wav->samples[i] / 16;
+    } else {
+      value += (int)lround(a->amplitude * sin(2.0 * M_PI * a->freq_hz * (double)dt / 1e6));
+    }
+  }
+  if (adc_noise[ch] > 0) {
+    // xorshift32: ruído reprodutível entre execuções
+    noise_state ^= noise_state << 13;
+    noise_state ^= noise_state >> 17;
+    noise_state ^= noise_state << 5;
+    value += (int)(noise_state % (2u * adc_noise[ch] + 1)) - adc_noise[ch];
+  }
+  return value < 0 ? 0 : value > 4095 ? 4095 : (uint16_t)value;
+}
+
+uint16_t hal_adc_read(void) {
+  SIM_CALLER();
+  sim_advance(2); // Conversão de ~2 us a 48 MHz / 96 ciclos
+  return adc_sample_at(adc_channel, now_us);
+}
+
+int hal_adc_stream_start(uint32_t channel_mask, uint32_t sample_rate_hz, uint16_t *ring, size_t ring_len) {
+  adc_order_len = 0;
+  for (uint ch = 0; ch < SIM_NUM_ADC; ++ch)
+    if (channel_mask & (1u << ch))
+      adc_order[adc_order_len++] = ch;
+  adc_ring = ring;
+  adc_ring_len = ring_len;
+  adc_total_rate = sample_rate_hz * adc_order_len;
+  adc_start_us = now_us;
+  adc_written = 0;
+  sim_log("adc em rodízio: %u canais a %u Hz cada", adc_order_len, sample_rate_hz);
+  return 0;
+}
+
+// Grava no anel as conversões que o ADC teria feito até agora (no máximo um anel inteiro)
+size_t hal_adc_stream_position(int stream) {
+  (void)stream;
+  uint64_t due = (now_us - adc_start_us) * adc_total_rate / 1000000u;
+  if (due - adc_written > adc_ring_len)
+    adc_written = due - adc_ring_len - (due - adc_ring_len) % adc_order_len;
+  for (; adc_written < due; ++adc_written)
+    adc_ring[adc_written % adc_ring_len] =
+        adc_sample_at(adc_order[adc_written % adc_order_len], adc_start_us + adc_written * 1000000u / adc_total_rate);
+  return adc_written % adc_ring_len;
+}
+
+/*=====*/
+/* PWM */
+/*=====*/
+
+void hal_pwm_init_pin(uint pin) {
+  (void)pin;
+}
+
+void hal_pwm_configure(uint pin, float clkdiv, uint16_t wrap, uint16_t level) {
+  pwm_clkdiv[pin] = clkdiv;
+  pwm_wrap[pin] = wrap;
+  pwm_level[pin] = level;
+}
+
+void hal_pwm_enable(uint pin, bool enabled) {
+  if (enabled) {
+    double freq = (double)SIM_CLK_SYS_HZ / (pwm_clkdiv[pin] * (pwm_wrap[pin] + 1.0));
+    double duty = pwm_level[pin] > pwm_wrap[pin] ? 100.0 : 100.0 * pwm_level[pin] / (pwm_wrap[pin] + 1.0);
+    sim_log("pwm %u ligado: %.1f Hz, duty %.0f%%", pin, freq, duty);
+  } else {
+    sim_log("pwm %u desligado", pin);
+  }
+}
+
+/*==================*/
+/* I2C e SSD1306    */
+/*==================*/
+
+static void oled_dump(void) {
+  char path[512], tmp[520];
+  snprintf(path, sizeof(path), "%s/oled.pbm", out_dir);
+  snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+  FILE *f = fopen(tmp, "w");
+  if (f == NULL)
+    return;
+  fprintf(f, "P1\n# quadro %u, t=%llu us\n%d %d\n", oled_frames, (unsigned long long)now_us,
+          SIM_OLED_WIDTH, SIM_OLED_PAGES * 8);
+  for (int y = 0; y < SIM_OLED_PAGES * 8; ++y) {
+    for (int x = 0; x < SIM_OLED_WIDTH; ++x) {
+      bool on = oled_on && (oled_ram[y >> 3][x] & (1u << (y & 7)));
+      fputc(on ? '1' : '0', f);
+    }
+    fputc('\n', f);
+  }
+  fclose(f);
+  rename(tmp, path);
+}
+
+static void oled_command(uint8_t byte) {
+  if (oled_cmd_need) {
+    oled_cmd[oled_cmd_len++] = byte;
+    if (--oled_cmd_need)
+      return;
+  } else {
+    oled_cmd[0] = byte;
+    oled_cmd_len = 1;
+    switch (byte) {
+      case 0x21: case 0x22:
+        oled_cmd_need = 2;
+        return;
+      case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+      case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        oled_cmd_need = 1;
+        return;
+      default:
+        break;
+    }
+  }
+
+  switch (oled_cmd[0]) {
+    case 0x20:
+      oled_mode = oled_cmd[1] & 0x03;
+      break;
+    case 0x21:
+      oled_col0 = oled_col = oled_cmd[1] & 0x7F;
+      oled_col1 = oled_cmd[2] & 0x7F;
+      break;
+    case 0x22:
+      oled_page0 = oled_page = oled_cmd[1] & 0x07;
+      oled_page1 = oled_cmd[2] & 0x07;
+      break;
+    case 0xAE:
+      oled_on = false;
+      break;
+    case 0xAF:
+      oled_on = true;
+      break;
+    default:
+      break;
+  }
+}
+
+static void oled_data(uint8_t byte) {
+  oled_ram[oled_page][oled_col] = byte;
+  if (oled_mode == 1) {
+    // Vertical: desce as páginas e depois avança a coluna
+    if (oled_page++ >= oled_page1) {
+      oled_page = oled_page0;
+      oled_col = oled_col >= oled_col1 ? oled_col0 : oled_col + 1;
+    }
+  } else if (oled_mode == 0) {
+    if (oled_col++ >= oled_col1) {
+      oled_col = oled_col0;
+      oled_page = oled_page >= oled_page1 ? oled_page0 : oled_page + 1;
+    }
+  } else if (oled_col < SIM_OLED_WIDTH - 1) {
+    ++oled_col;
+  }
+}
+
+// Interpreta uma transação I2C endereçada ao display (bytes de controle Co/D#C)
+static void oled_transaction(const uint8_t *src, size_t len) {
+  bool wrote_data = false;
+  size_t i = 0;
+  while (i < len) {
+    uint8_t control = src[i++];
+    bool data = control & 0x40;
+    bool single = control & 0x80;
+    size_t end = single ? (i < len ? i + 1 : i) : len;
+    for (; i < end; ++i) {
+      if (data) {
+        oled_data(src[i]);
+        wrote_data = true;
+      } else {
+        oled_command(src[i]);
+      }
+    }
+  }
+  if (wrote_data) {
+    ++oled_frames;
+    oled_dump();
+  }
+}
+
+static void i2c_deliver(uint bus, uint8_t address, const uint8_t *src, size_t len) {
+  // Start + endereço + bytes, 9 bits cada, + stop
+  sim_advance(((len + 1) * 9 + 2) * 1000000ull / i2c_baud[bus & 1]);
+  if (address == SIM_OLED_ADDRESS)
+    oled_transaction(src, len);
+}
+
+void hal_i2c_init(uint bus, uint baudrate, uint sda, uint scl) {
+  (void)sda;
+  (void)scl;
+  i2c_baud[bus & 1] = baudrate;
+}
+
+int hal_i2c_write(uint bus, uint8_t address, const uint8_t *src, size_t len, bool nostop) {
+  SIM_CALLER();
+  (void)nostop;
+  i2c_deliver(bus, address, src, len);
+  return (int)len;
+}
+
+int hal_i2c_stream_claim(uint bus, hal_callback_t done, void *ctx) {
+  if (stream_count >= SIM_MAX_STREAMS) {
+    fprintf(stderr, "sim: sem canais de fluxo I2C livres\n");
+    exit(1);
+  }
+  streams[stream_count].bus = bus;
+  streams[stream_count].done = done;
+  streams[stream_count].ctx = ctx;
+  return stream_count++;
+}
+
+// O fluxo é entregue de forma síncrona; a conclusão é sinalizada como se viesse da IRQ
+void hal_i2c_stream_start(int stream, uint8_t address, const uint16_t *words, size_t count) {
+  SIM_CALLER();
+  static uint8_t transaction[2048];
+  size_t len = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (len < sizeof(transaction))
+      transaction[len++] = words[i] & 0xFF;
+    if (words[i] & HAL_I2C_STOP || i + 1 == count) {
+      i2c_deliver(streams[stream].bus, address, transaction, len);
+      len = 0;
+    }
+  }
+  if (streams[stream].done != NULL)
+    streams[stream].done(streams[stream].ctx);
+}
+
+bool hal_i2c_stream_busy(int stream) {
+  (void)stream;
+  return false;
+}
+
+/*================*/
+/* UART e stdio   */
+/*================*/
+
+static void open_pty(void) {
+  pty_master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (pty_master < 0 || grantpt(pty_master) < 0 || unlockpt(pty_master) < 0) {
+    perror("sim: pty");
+    exit(1);
+  }
+  const char *name = ptsname(pty_master);
+  // Mantém o lado escravo aberto e em modo bruto para que o mestre não receba EIO
+  int slave = open(name, O_RDWR | O_NOCTTY);
+  if (slave >= 0) {
+    struct termios tio;
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+  }
+  fcntl(pty_master, F_SETFL, fcntl(pty_master, F_GETFL) | O_NONBLOCK);
+  fprintf(stderr, "sim: UART disponível em %s\n", name);
+}
+
+void hal_stdio_init(void) {
+  setvbuf(stdout, NULL, _IONBF, 0);
+}
+
+int hal_stdio_getchar(uint32_t timeout_us) {
+  SIM_CALLER();
+  sim_advance(timeout_us ? timeout_us : SIM_POLL_COST_US);
+  poll_inputs();
+  return queue_pop(&usb_rx);
+}
+
+void hal_uart_init(uint uart, uint baudrate, uint tx_pin, uint rx_pin) {
+  (void)uart;
+  (void)tx_pin;
+  (void)rx_pin;
+  uart_baud = baudrate;
+  const char *env = getenv("ALPHA_SIM_UART_PTY");
+  if (env != NULL && atoi(env) == 1 && pty_master < 0)
+    open_pty();
+  sim_log("uart %u a %u baud", uart, baudrate);
+}
+
+bool hal_uart_readable(uint uart) {
+  SIM_CALLER();
+  (void)uart;
+  sim_advance(SIM_POLL_COST_US);
+  poll_inputs();
+  return !queue_empty(&uart_rx);
+}
+
+char hal_uart_getc(uint uart) {
+  SIM_CALLER();
+  (void)uart;
+  while (queue_empty(&uart_rx)) {
+    sim_advance(SIM_POLL_COST_US);
+    poll_inputs();
+  }
+  return (char)queue_pop(&uart_rx);
+}
+
+void hal_uart_set_rx_irq(uint uart, hal_callback_t handler, void *ctx) {
+  (void)uart;
+  uart_rx_handler = handler;
+  uart_rx_ctx = ctx;
+  uart_rx_irq_on = true;
+}
+
+void hal_uart_rx_irq_enable(uint uart, bool enable) {
+  (void)uart;
+  uart_rx_irq_on = enable;
+}
+
+void hal_stdio_set_rx_callback(hal_callback_t handler, void *ctx) {
+  usb_rx_handler = handler;
+  usb_rx_ctx = ctx;
+}
+
+void hal_uart_putc(uint uart, char c) {
+  (void)uart;
+  if (pty_master >= 0) {
+    ssize_t n = write(pty_master, &c, 1);
+    (void)n;
+  } else {
+    putchar(c);
+  }
+}
+
+// Os bytes saem de uma vez pelo mesmo caminho de hal_uart_putc; o canal fica
+// ocupado pelo tempo que a UART levaria para transmiti-los (10 bits por byte)
+int hal_uart_stream_claim(uint uart) {
+  uart_stream_uart = uart;
+  return 0;
+}
+
+void hal_uart_stream_start(int stream, const uint8_t *data, size_t len) {
+  (void)stream;
+  for (size_t i = 0; i < len; ++i)
+    hal_uart_putc(uart_stream_uart, (char)data[i]);
+  uart_stream_end_us = now_us + len * 10ull * 1000000ull / (uart_baud ? uart_baud : 115200);
+}
+
+bool hal_uart_stream_busy(int stream) {
+  (void)stream;
+  return now_us < uart_stream_end_us;
+}
+
+/*=================*/
+/* Matriz WS2812   */
+/*=================*/
+
+static char matrix_char(uint32_t grb) {
+  bool g = (grb >> 24) & 0xFF, r = (grb >> 16) & 0xFF, b = (grb >> 8) & 0xFF;
+  static const char names[8] = {'.', 'B', 'G', 'C', 'R', 'M', 'Y', 'W'};
+  return names[(r << 2) | (g << 1) | b];
+}
+
+static void matrix_dump(void) {
+  char grid[SIM_MATRIX_LEDS / 5][6];
+  for (int row = 0; row < 5; ++row) {
+    for (int col = 0; col < 5; ++col)
+      grid[row][col] = matrix_char(matrix_frame[row * 5 + col]);
+    grid[row][5] = '\0';
+  }
+  sim_log("matriz %s|%s|%s|%s|%s", grid[0], grid[1], grid[2], grid[3], grid[4]);
+
+  char path[512];
+  snprintf(path, sizeof(path), "%s/matrix.txt", out_dir);
+  FILE *f = fopen(path, "w");
+  if (f == NULL)
+    return;
+  for (int row = 0; row < 5; ++row)
+    fprintf(f, "%s\n", grid[row]);
+  fclose(f);
+}
+
+void hal_matrix_init(hal_pio_t pio, uint sm, uint pin) {
+  sim_log("matriz WS2812 em pio%u sm%u, gpio %u", pio, sm, pin);
+}
+
+int hal_matrix_stream_claim(hal_pio_t pio, uint sm) {
+  (void)pio;
+  (void)sm;
+  return 0;
+}
+
+// O DMA não ocupa a CPU: o quadro é registrado de uma vez, com o instante em que a última palavra sai
+void hal_matrix_stream_start(int stream, const uint32_t *words, size_t count) {
+  (void)stream;
+  // Sem a pausa de reset os LEDs repassam os dados adiante e o quadro se perde
+  if (now_us >= matrix_last_put_us + SIM_WS2812_RESET_US)
+    matrix_index = 0;
+  else
+    sim_log("matriz: quadro iniciado sem pausa de reset (descartado pelos LEDs)");
+  for (size_t i = 0; i < count; ++i) {
+    if (matrix_index < SIM_MATRIX_LEDS)
+      matrix_frame[matrix_index] = words[i];
+    if (++matrix_index == SIM_MATRIX_LEDS)
+      matrix_dump();
+  }
+  matrix_last_put_us = now_us + count * SIM_WS2812_WORD_US;
+}
+
+bool hal_matrix_stream_busy(int stream) {
+  (void)stream;
+  return now_us < matrix_last_put_us;
+}
+
+/*=================*/
+/* Teclado 4x4     */
+/*=================*/
+
+void hal_keypad_init(hal_pio_t pio, uint sm, hal_callback_t on_change, void *ctx) {
+  (void)pio;
+  (void)sm;
+  keypad_handler = on_change;
+  keypad_ctx = ctx;
+  // A primeira varredura sempre é enviada
+  keypad_last_scan = keypad_scan(keypad_switches);
+  keypad_fifo[0] = keypad_last_scan;
+  keypad_fifo_count = 1;
+}
+
+bool hal_keypad_read(uint16_t *closed) {
+  if (keypad_fifo_count == 0)
+    return false;
+  *closed = keypad_fifo[0];
+  memmove(keypad_fifo, keypad_fifo + 1, --keypad_fifo_count * sizeof(keypad_fifo[0]));
+  keypad_update();
+  return true;
+}
+
+/*=================*/
+/* Leitor de íris  */
+/*=================*/
+
+bool hal_iris_capture(uint32_t *code, uint32_t *mask) {
+  if (iris_eye == NULL)
+    return false;
+  memcpy(code, iris_eye, HAL_IRIS_CODE_WORDS * sizeof(uint32_t));
+  memcpy(mask, iris_eye + HAL_IRIS_CODE_WORDS, HAL_IRIS_CODE_WORDS * sizeof(uint32_t));
+  return true;
+}
@@ -0,0 +1,255 @@
+#include "src/iris_match.h"
+#include "iris_file.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Avalia a comparação de íris sobre uma coleção de códigos (.iris).
+ *
+ * A coleção é uma lista de linhas "<identidade> <arquivo.iris>". O primeiro
+ * código de cada identidade vai para a galeria; os demais são buscados na
+ * galeria inteira (1:N) como na placa. O relatório traz o tempo e as palavras
+ * comparadas por busca, com o limiar e sem ele (distâncias exatas), a taxa de
+ * identificação correta e, com as distâncias exatas, as distribuições genuína
+ * e impostora, a separação d' e FAR/FRR no limiar (-t).
+ *
+ * Sem uma coleção real, -g gera uma sintética: códigos aleatórios por
+ * identidade e capturas com rotação de até ±4 posições, bits trocados
+ * (ruído, padrão 10%) e máscaras de pálpebra e reflexos.
+ *
+ * Uso: iris_bench [-t limiar] <lista.txt>
+ *      iris_bench -g <diretório> <identidades> <capturas por identidade> [ruído %]
+ */
+
+#define MAX_NAME 32
+
+typedef struct {
+  char name[MAX_NAME];
+  int identity;
+  iris_code_t code;
+  int gallery_index;                // -1 se não está na galeria
+} sample_t;
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+
+static uint32_t rng(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return (uint32_t)(rng_state >> 16);
+}
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void mask_region(iris_code_t *c, int ring0, int ring1, int angle0, int width) {
+  for (int ring = ring0; ring <= ring1; ++ring)
+    for (int a = angle0; a < angle0 + width; ++a)
+      for (int b = 0; b < IRIS_BITS_PER_ANGLE; ++b) {
+        int bit = ring * IRIS_RING_WORDS * 32 + ((a + IRIS_ANGLES) % IRIS_ANGLES) * IRIS_BITS_PER_ANGLE + b;
+        c->mask[bit / 32] &= ~(1u << (bit % 32));
+      }
+}
+
+// Uma captura da identidade: rotação, ruído e oclusões
+static void synth_capture(const iris_code_t *identity, double noise, iris_code_t *out) {
+  static iris_probe_t rotations;
+  iris_probe_prepare(identity, &rotations);
+  int shift = (int)(rng() % 9) - 4;      // Entre duas capturas: até ±IRIS_MAX_SHIFT
+  *out = rotations.rot[IRIS_MAX_SHIFT + shift];
+
+  uint32_t flip_limit = (uint32_t)(noise * 65536.0);
+  for (int i = 0; i < IRIS_CODE_BITS; ++i)
+    if ((rng() & 0xFFFF) < flip_limit)
+      out->code[i / 32] ^= 1u << (i % 32);
+
+  memset(out->mask, 0xFF, sizeof(out->mask));
+  mask_region(out, 5, 7, 32 - 10 - (int)(rng() % 15), 20 + (int)(rng() % 30));  // Pálpebra superior
+  mask_region(out, 6, 7, 96 - 5 - (int)(rng() % 10), 10 + (int)(rng() % 20));   // Pálpebra inferior
+  for (int spot = 0; spot < 2; ++spot)                                            // Reflexos
+    mask_region(out, (int)(rng() % 7), 0, (int)(rng() % IRIS_ANGLES), 3);
+  for (int i = 0; i < IRIS_CODE_WORDS; ++i)
+    out->code[i] = (out->code[i] & out->mask[i]) | (rng() & ~out->mask[i]);
+}
+
+static int generate(const char *dir, int identities, int captures, double noise) {
+  char path[1024];
+  snprintf(path, sizeof(path), "%s/lista.txt", dir);
+  FILE *list = fopen(path, "w");
+  if (list == NULL) {
+    perror(path);
+    return 1;
+  }
+  for (int id = 0; id < identities; ++id) {
+    iris_code_t identity;
+    for (int i = 0; i < IRIS_CODE_WORDS; ++i)
+      identity.code[i] = rng();
+    memset(identity.mask, 0xFF, sizeof(identity.mask));
+    for (int c = 0; c < captures; ++c) {
+      iris_code_t capture;
+      synth_capture(&identity, noise, &capture);
+      snprintf(path, sizeof(path), "%s/id%03d_%d.iris", dir, id, c);
+      if (!iris_file_save(path, capture.code, capture.mask))
+        return 1;
+      fprintf(list, "id%03d id%03d_%d.iris\n", id, id, c);
+    }
+  }
+  fclose(list);
+  printf("%d identidades x %d capturas em %s (ruído %.0f%%)\n", identities, captures, dir, noise * 100);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc >= 5 && strcmp(argv[1], "-g") == 0)
+    return generate(argv[2], atoi(argv[3]), atoi(argv[4]), argc > 5 ? atof(argv[5]) / 100.0 : 0.10);
+
+  double threshold = IRIS_ACCEPT_HD / 65536.0;
+  int opt = 1;
+  if (argc == 4 && strcmp(argv[1], "-t") == 0) {
+    threshold = atof(argv[2]);
+    opt = 3;
+  }
+  if (opt != argc - 1) {
+    fprintf(stderr, "uso: %s [-t limiar] <lista.txt>\n"
+                    "     %s -g <diretório> <identidades> <capturas por identidade> [ruído %%]\n",
+            argv[0], argv[0]);
+    return 2;
+  }
+  uint32_t limit = IRIS_HD(threshold);
+
+  FILE *list = fopen(argv[opt], "r");
+  if (list == NULL) {
+    fprintf(stderr, "não foi possível abrir '%s'\n", argv[opt]);
+    return 1;
+  }
+  // Caminhos relativos na lista partem do diretório da própria lista
+  char base[512] = "";
+  const char *slash = strrchr(argv[opt], '/');
+  if (slash != NULL)
+    snprintf(base, sizeof(base), "%.*s/", (int)(slash - argv[opt]), argv[opt]);
+
+  sample_t *samples = NULL;
+  size_t count = 0, capacity = 0;
+  iris_code_t *gallery = NULL;
+  int *gallery_identity = NULL;
+  size_t gallery_count = 0;
+  int identities = 0;
+  char (*names)[MAX_NAME] = NULL;
+
+  char line[600], name[MAX_NAME], file[512], path[1100];
+  while (fgets(line, sizeof(line), list)) {
+    if (line[0] == '#' || sscanf(line, "%31s %511s", name, file) != 2)
+      continue;
+    if (count == capacity) {
+      capacity = capacity ? capacity * 2 : 256;
+      samples = realloc(samples, capacity * sizeof(*samples));
+      gallery = realloc(gallery, capacity * sizeof(*gallery));
+      gallery_identity = realloc(gallery_identity, capacity * sizeof(*gallery_identity));
+      names = realloc(names, capacity * sizeof(*names));
+    }
+    sample_t *s = &samples[count];
+    snprintf(path, sizeof(path), "%s%s", file[0] == '/' ? "" : base, file);
+    if (!iris_file_load(path, s->code.code, s->code.mask))
+      return 1;
+    snprintf(s->name, sizeof(s->name), "%s", name);
+    s->identity = -1;
+    for (int i = 0; i < identities; ++i)
+      if (strcmp(names[i], name) == 0)
+        s->identity = i;
+    s->gallery_index = -1;
+    if (s->identity < 0) {
+      // Primeira captura da identidade: cadastro
+      snprintf(names[identities], MAX_NAME, "%s", name);
+      s->identity = identities++;
+      s->gallery_index = (int)gallery_count;
+      gallery[gallery_count] = s->code;
+      gallery_identity[gallery_count++] = s->identity;
+    }
+    ++count;
+  }
+  fclose(list);
+
+  // Busca 1:N como na placa e, depois, distâncias exatas para as estatísticas
+  static iris_probe_t probe;
+  size_t probes = 0, correct = 0, wrong = 0, missed = 0;
+  double search_ns = 0, search_max_ns = 0, full_ns = 0;
+  uint64_t words = 0, full_words = 0, early = 0, comparisons = 0;
+  double genuine_sum = 0, genuine_sq = 0, impostor_sum = 0, impostor_sq = 0;
+  size_t genuine_n = 0, impostor_n = 0, false_reject = 0, false_accept = 0;
+  for (size_t i = 0; i < count; ++i) {
+    sample_t *s = &samples[i];
+    if (s->gallery_index >= 0)
+      continue;
+    ++probes;
+    iris_probe_prepare(&s->code, &probe);
+
+    iris_match_t best;
+    double t0 = now_ns();
+    bool found = iris_search(&probe, gallery, gallery_count, limit, &best);
+    double dt = now_ns() - t0;
+    search_ns += dt;
+    if (dt > search_max_ns)
+      search_max_ns = dt;
+    words += best.words;
+    early += best.early_exits;
+    comparisons += (uint64_t)gallery_count * IRIS_ROTATIONS;
+    if (!found)
+      ++missed;
+    else if (gallery_identity[best.index] == s->identity)
+      ++correct;
+    else
+      ++wrong;
+
+    // Distâncias exatas contra toda a galeria
+    iris_match_t m = {0};
+    t0 = now_ns();
+    for (size_t g = 0; g < gallery_count; ++g) {
+      uint32_t hd = iris_distance(&probe, &gallery[g], IRIS_HD_REJECT, &m);
+      double x = hd == IRIS_HD_REJECT ? 1.0 : hd / 65536.0;
+      if (gallery_identity[g] == s->identity) {
+        genuine_sum += x, genuine_sq += x * x, ++genuine_n;
+        false_reject += hd > limit;
+      } else {
+        impostor_sum += x, impostor_sq += x * x, ++impostor_n;
+        false_accept += hd <= limit;
+      }
+    }
+    full_ns += now_ns() - t0;
+    full_words += m.words;
+  }
+
+  double gm = genuine_n ? genuine_sum / genuine_n : 0, im = impostor_n ? impostor_sum / impostor_n : 0;
+  double gs = genuine_n ? sqrt(fmax(genuine_sq / genuine_n - gm * gm, 0)) : 0;
+  double is = impostor_n ? sqrt(fmax(impostor_sq / impostor_n - im * im, 0)) : 0;
+  double dprime = gs + is > 0 ? fabs(im - gm) / sqrt((gs * gs + is * is) / 2) : 0;
+
+  printf("códigos: %zu (%d identidades; galeria %zu, buscas %zu)\n", count, identities, gallery_count, probes);
+  printf("memória: código %zu B, amostra com %d rotações %zu B, galeria %zu B\n", sizeof(iris_code_t),
+         IRIS_ROTATIONS, sizeof(iris_probe_t), gallery_count * sizeof(iris_code_t));
+  if (probes == 0)
+    return 0;
+  printf("busca 1:N: %.1f us média, %.1f us máximo; %.0f palavras por busca (%.1f%% das comparações encerradas cedo)\n",
+         search_ns / 1e3 / probes, search_max_ns / 1e3, (double)words / probes,
+         comparisons ? 100.0 * early / comparisons : 0);
+  printf("distâncias exatas, sem limiar: %.1f us média; %.0f palavras por busca (%.1fx)\n", full_ns / 1e3 / probes,
+         (double)full_words / probes, words ? (double)full_words / words : 0);
+  printf("identificação no limiar %.3f: %zu corretas, %zu erradas, %zu sem correspondência\n", threshold,
+         correct, wrong, missed);
+  printf("distâncias: genuínas %.3f ± %.3f, impostoras %.3f ± %.3f, d' %.1f\n", gm, gs, im, is, dprime);
+  printf("limiar %.3f: FRR %.2f%% (%zu/%zu), FAR %.4f%% (%zu/%zu)\n", threshold,
+         genuine_n ? 100.0 * false_reject / genuine_n : 0, false_reject, genuine_n,
+         impostor_n ? 100.0 * false_accept / impostor_n : 0, false_accept, impostor_n);
+
+  free(samples);
+  free(gallery);
+  free(gallery_identity);
+  free(names);
+  return 0;
+}
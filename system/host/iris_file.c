@@ -0,0 +1,51 @@
+#include "iris_file.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#define IRIS_FILE_WORDS (IRIS_FILE_SIZE / 8)
+
+static void put_words(uint8_t *dst, const uint32_t *words) {
+  for (int i = 0; i < IRIS_FILE_WORDS; ++i)
+    for (int b = 0; b < 4; ++b)
+      dst[4 * i + b] = (uint8_t)(words[i] >> (8 * b));
+}
+
+static void get_words(const uint8_t *src, uint32_t *words) {
+  for (int i = 0; i < IRIS_FILE_WORDS; ++i)
+    words[i] = (uint32_t)src[4 * i] | (uint32_t)src[4 * i + 1] << 8 | (uint32_t)src[4 * i + 2] << 16 |
+               (uint32_t)src[4 * i + 3] << 24;
+}
+
+bool iris_file_load(const char *path, uint32_t *code, uint32_t *mask) {
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) {
+    fprintf(stderr, "%s: %s\n", path, strerror(errno));
+    return false;
+  }
+  uint8_t buf[IRIS_FILE_SIZE + 1];
+  size_t n = fread(buf, 1, sizeof(buf), f);
+  fclose(f);
+  if (n != IRIS_FILE_SIZE) {
+    fprintf(stderr, "%s: código de íris deve ter %d bytes\n", path, IRIS_FILE_SIZE);
+    return false;
+  }
+  get_words(buf, code);
+  get_words(buf + IRIS_FILE_SIZE / 2, mask);
+  return true;
+}
+
+bool iris_file_save(const char *path, const uint32_t *code, const uint32_t *mask) {
+  uint8_t buf[IRIS_FILE_SIZE];
+  put_words(buf, code);
+  put_words(buf + IRIS_FILE_SIZE / 2, mask);
+  FILE *f = fopen(path, "wb");
+  if (f == NULL || fwrite(buf, 1, sizeof(buf), f) != sizeof(buf)) {
+    fprintf(stderr, "%s: %s\n", path, strerror(errno));
+    if (f != NULL)
+      fclose(f);
+    return false;
+  }
+  return fclose(f) == 0;
+}
@@ -0,0 +1,17 @@
+#ifndef IRIS_FILE_H
+#define IRIS_FILE_H
+
+#include "src/hal/hal.h"
+
+/*
+ * Arquivos de código de íris (.iris) para o simulador e as ferramentas de
+ * host: HAL_IRIS_CODE_WORDS palavras do código seguidas de HAL_IRIS_CODE_WORDS
+ * palavras da máscara, em 32 bits little-endian (IRIS_FILE_SIZE bytes).
+ */
+
+#define IRIS_FILE_SIZE (2 * HAL_IRIS_CODE_WORDS * 4)
+
+bool iris_file_load(const char *path, uint32_t *code, uint32_t *mask);
+bool iris_file_save(const char *path, const uint32_t *code, const uint32_t *mask);
+
+#endif // IRIS_FILE_H
@@ -0,0 +1,207 @@
+#include "src/bench.h"
+#include "src/display.h"
+#include "src/ui.h"
+#include "src/debouncer.h"
+#include "src/input_stream.h"
+#include "src/hardwareFiles/buttons.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Roda os micro-benchmarks de src/bench.c no host.
+ *
+ * Os módulos rodam sobre a HAL simulada, com o mesmo preparo do firmware
+ * (display, núcleo 1 simulado, botões no debouncer). O tempo é o relógio
+ * real do host, não o simulado, e inclui o custo da própria simulação nas
+ * chamadas à HAL. As alocações são contadas substituindo malloc e afins.
+ *
+ * Cada caso é medido em BENCH_ROUNDS rodadas de ao menos -t ms e vale a
+ * mais rápida, que é a menos afetada por outros processos. O tempo também
+ * sai relativo a um laço de referência fixo (coluna "rel."), o que desconta
+ * o clock da máquina, mas não as diferenças de microarquitetura (cache,
+ * largura de memória).
+ *
+ * A saída serve de base para comparações futuras (host/bench_baseline.txt):
+ * com -b, o tempo relativo de cada caso é comparado com o da base e variações
+ * acima de -r por cento são marcadas como regressão, o que também muda o
+ * código de saída para 1. A base só vale para a máquina em que foi gerada:
+ * para usar a comparação como critério, gere-a antes na mesma máquina.
+ *
+ * Uso: micro_bench [-t ms por caso] [-r limite %] [-b base.txt]
+ */
+
+#define ALLOC_CHECK_ITERATIONS 1000
+#define MAX_BASELINE           32
+#define BENCH_ROUNDS           5
+#define HOST_MAX_ITERATIONS    (1u << 31)  // Não limita: o relógio do host sempre anda
+
+/*=======================*/
+/* Contagem de alocações */
+/*=======================*/
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static size_t allocations;
+
+void *malloc(size_t size) {
+  ++allocations;
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+  ++allocations;
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  ++allocations;
+  return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) {
+  __libc_free(ptr);
+}
+
+/*=========*/
+/* Medição */
+/*=========*/
+
+typedef struct {
+  char name[64];
+  double relative;                  // ns/op dividido pelo da referência
+} baseline_t;
+
+static volatile uint32_t reference_sink;
+
+// Referência da máquina: cadeia de multiplicações dependentes, fora da aplicação
+static void reference_run(uint32_t n) {
+  uint32_t x = 1;
+  for (uint32_t i = 0; i < n; ++i)
+    x = x * 1664525u + 1013904223u;
+  reference_sink = x;
+}
+
+static const bench_case_t reference_case = {"referencia", reference_run};
+
+static uint64_t host_clock_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static size_t load_baseline(const char *path, baseline_t *base) {
+  FILE *f = fopen(path, "r");
+  if (f == NULL)
+    return 0;
+  size_t count = 0;
+  char line[256];
+  while (count < MAX_BASELINE && fgets(line, sizeof(line), f))
+    if (line[0] != '#' && sscanf(line, "%63s %*f %lf", base[count].name, &base[count].relative) == 2)
+      ++count;
+  fclose(f);
+  return count;
+}
+
+// O mesmo preparo de main(): display, interface no núcleo 1 e botões
+static void bench_setup(void) {
+  static event_queue_t events;
+  static const debounce_config_t button_config = {.long_press_ms = 1000};
+  init_buttons();
+  input_stream_init(0);
+  init_display();
+  ui_init();
+  event_queue_init(&events);
+  debouncer_init(&events);
+  debouncer_add(BUTTON_A, true, &button_config);
+  debouncer_add(BUTTON_B, true, &button_config);
+  debouncer_add(JOYSTICK_BTN, true, &button_config);
+}
+
+// Menor ns/op entre as rodadas
+static double measure(const bench_case_t *c, double min_ms, uint32_t *iterations) {
+  double best = 0;
+  for (int round = 0; round < BENCH_ROUNDS; ++round) {
+    bench_result_t r;
+    bench_measure(c, host_clock_ns, (uint64_t)(min_ms * 1e6), HOST_MAX_ITERATIONS, &r);
+    double ns_per_op = (double)r.elapsed_ns / r.iterations;
+    if (round == 0 || ns_per_op < best) {
+      best = ns_per_op;
+      *iterations = r.iterations;
+    }
+  }
+  return best;
+}
+
+int main(int argc, char **argv) {
+  double min_ms = 50, threshold = 25;
+  const char *baseline_path = NULL;
+  int opt = 1;
+  for (; opt < argc - 1 && argv[opt][0] == '-'; opt += 2) {
+    if (strcmp(argv[opt], "-t") == 0)
+      min_ms = atof(argv[opt + 1]);
+    else if (strcmp(argv[opt], "-r") == 0)
+      threshold = atof(argv[opt + 1]);
+    else if (strcmp(argv[opt], "-b") == 0)
+      baseline_path = argv[opt + 1];
+    else
+      break;
+  }
+  if (opt != argc || min_ms <= 0) {
+    fprintf(stderr, "uso: %s [-t ms por caso] [-r limite %%] [-b base.txt]\n", argv[0]);
+    return 2;
+  }
+
+  baseline_t base[MAX_BASELINE];
+  size_t base_count = 0;
+  if (baseline_path != NULL && (base_count = load_baseline(baseline_path, base)) == 0) {
+    fprintf(stderr, "'%s' não tem resultados de base\n", baseline_path);
+    return 1;
+  }
+
+  bench_setup();
+
+  uint32_t iterations;
+  double reference_ns = measure(&reference_case, min_ms, &iterations);
+
+  printf("# micro_bench: relógio do host, melhor de %d rodadas de ao menos %.0f ms por caso\n", BENCH_ROUNDS, min_ms);
+  printf("# %-22s %10s %8s %8s %10s", "caso", "ns/op", "rel.", "aloc/op", "repetições");
+  if (base_count)
+    printf(" %9s %9s", "base rel.", "variação");
+  printf("\n");
+  printf("%-24s %10.2f %8.3f %8.2f %10u\n", reference_case.name, reference_ns, 1.0, 0.0, iterations);
+
+  int regressions = 0;
+  for (uint32_t i = 0; i < bench_case_count; ++i) {
+    const bench_case_t *c = &bench_cases[i];
+    double ns_per_op = measure(c, min_ms, &iterations);
+    double relative = ns_per_op / reference_ns;
+
+    size_t before = allocations;
+    c->run(ALLOC_CHECK_ITERATIONS);
+    double allocs_per_op = (double)(allocations - before) / ALLOC_CHECK_ITERATIONS;
+
+    printf("%-24s %10.2f %8.3f %8.2f %10u", c->name, ns_per_op, relative, allocs_per_op, iterations);
+    for (size_t k = 0; k < base_count; ++k) {
+      if (strcmp(base[k].name, c->name) != 0)
+        continue;
+      double change = 100.0 * (relative - base[k].relative) / base[k].relative;
+      printf(" %9.3f %+8.1f%%", base[k].relative, change);
+      if (change > threshold) {
+        printf("  <- regressão");
+        ++regressions;
+      }
+      break;
+    }
+    printf("\n");
+  }
+
+  if (base_count)
+    printf("# %d regressões acima de %.0f%%\n", regressions, threshold);
+  return regressions ? 1 : 0;
+}
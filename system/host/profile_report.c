@@ -0,0 +1,247 @@
+#include <elf.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Associa o histograma do perfilador por amostragem às funções do programa.
+ *
+ * Lê a saída do comando "prof dump" capturada do console (linhas entre
+ * "PROF BEGIN" e "PROF END"; as demais são ignoradas) e a tabela de símbolos
+ * do ELF que estava rodando: build/main.elf na placa ou o main_host do
+ * simulador. A diferença entre o endereço de profiler_start informado na
+ * captura e o do ELF desconta a relocação (zero na placa). Imprime as funções
+ * por número de amostras e, com -a, também os endereços mais amostrados.
+ *
+ * Uso: profile_report [-a] <programa.elf> [captura.txt]
+ */
+
+#define ANCHOR_SYMBOL "profiler_start"
+
+typedef struct {
+  uint64_t addr;
+  uint64_t size;
+  const char *name;
+} symbol_t;
+
+typedef struct {
+  uint64_t pc;
+  uint32_t count;
+  int symbol;                       // -1 fora de qualquer função
+} sample_t;
+
+typedef struct {
+  int symbol;
+  uint64_t count;
+} function_t;
+
+static symbol_t *symbols;
+static size_t symbol_count;
+
+static void add_symbol(uint64_t addr, uint64_t size, const char *name, bool thumb) {
+  symbols = realloc(symbols, (symbol_count + 1) * sizeof(*symbols));
+  symbols[symbol_count].addr = thumb ? addr & ~1ull : addr;   // Bit 0 marca código Thumb
+  symbols[symbol_count].size = size;
+  symbols[symbol_count].name = name;
+  ++symbol_count;
+}
+
+// Funções da tabela .symtab (ELF de 32 ou 64 bits, little-endian)
+static bool load_symbols(const uint8_t *elf, size_t len) {
+  if (len < sizeof(Elf32_Ehdr) || memcmp(elf, ELFMAG, SELFMAG) != 0 || elf[EI_DATA] != ELFDATA2LSB)
+    return false;
+  if (elf[EI_CLASS] == ELFCLASS32) {
+    const Elf32_Ehdr *eh = (const Elf32_Ehdr *)elf;
+    if (eh->e_shoff + (size_t)eh->e_shnum * sizeof(Elf32_Shdr) > len)
+      return false;
+    const Elf32_Shdr *sh = (const Elf32_Shdr *)(elf + eh->e_shoff);
+    bool thumb = eh->e_machine == EM_ARM;
+    for (int i = 0; i < eh->e_shnum; ++i) {
+      if (sh[i].sh_type != SHT_SYMTAB || sh[i].sh_link >= eh->e_shnum)
+        continue;
+      const Elf32_Sym *sym = (const Elf32_Sym *)(elf + sh[i].sh_offset);
+      const char *strtab = (const char *)elf + sh[sh[i].sh_link].sh_offset;
+      for (size_t k = 0; k < sh[i].sh_size / sizeof(Elf32_Sym); ++k)
+        if (ELF32_ST_TYPE(sym[k].st_info) == STT_FUNC && sym[k].st_value != 0)
+          add_symbol(sym[k].st_value, sym[k].st_size, strtab + sym[k].st_name, thumb);
+    }
+  } else if (elf[EI_CLASS] == ELFCLASS64) {
+    const Elf64_Ehdr *eh = (const Elf64_Ehdr *)elf;
+    if (eh->e_shoff + (size_t)eh->e_shnum * sizeof(Elf64_Shdr) > len)
+      return false;
+    const Elf64_Shdr *sh = (const Elf64_Shdr *)(elf + eh->e_shoff);
+    for (int i = 0; i < eh->e_shnum; ++i) {
+      if (sh[i].sh_type != SHT_SYMTAB || sh[i].sh_link >= eh->e_shnum)
+        continue;
+      const Elf64_Sym *sym = (const Elf64_Sym *)(elf + sh[i].sh_offset);
+      const char *strtab = (const char *)elf + sh[sh[i].sh_link].sh_offset;
+      for (size_t k = 0; k < sh[i].sh_size / sizeof(Elf64_Sym); ++k)
+        if (ELF64_ST_TYPE(sym[k].st_info) == STT_FUNC && sym[k].st_value != 0)
+          add_symbol(sym[k].st_value, sym[k].st_size, strtab + sym[k].st_name, false);
+    }
+  } else {
+    return false;
+  }
+  return symbol_count > 0;
+}
+
+static int by_addr(const void *a, const void *b) {
+  const symbol_t *x = a, *y = b;
+  return x->addr < y->addr ? -1 : x->addr > y->addr;
+}
+
+static int by_sample_count(const void *a, const void *b) {
+  const sample_t *x = a, *y = b;
+  return x->count < y->count ? 1 : x->count > y->count ? -1 : 0;
+}
+
+static int by_function_count(const void *a, const void *b) {
+  const function_t *x = a, *y = b;
+  return x->count < y->count ? 1 : x->count > y->count ? -1 : 0;
+}
+
+// Função que contém addr; símbolos sem tamanho vão até o próximo
+static int find_symbol(uint64_t addr) {
+  size_t lo = 0, hi = symbol_count;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (symbols[mid].addr <= addr)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo == 0)
+    return -1;
+  const symbol_t *s = &symbols[lo - 1];
+  bool inside = s->size ? addr < s->addr + s->size : lo == symbol_count || addr < symbols[lo].addr;
+  return inside ? (int)(lo - 1) : -1;
+}
+
+static uint8_t *read_file(const char *path, size_t *len) {
+  FILE *f = fopen(path, "rb");
+  if (f == NULL)
+    return NULL;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  uint8_t *data = size > 0 ? malloc(size) : NULL;
+  if (data != NULL && fread(data, 1, size, f) != (size_t)size) {
+    free(data);
+    data = NULL;
+  }
+  fclose(f);
+  *len = size > 0 ? (size_t)size : 0;
+  return data;
+}
+
+int main(int argc, char **argv) {
+  int opt = 1;
+  bool addresses = false;
+  if (opt < argc && strcmp(argv[opt], "-a") == 0) {
+    addresses = true;
+    ++opt;
+  }
+  if (opt >= argc || argc - opt > 2) {
+    fprintf(stderr, "uso: %s [-a] <programa.elf> [captura.txt]\n", argv[0]);
+    return 2;
+  }
+
+  size_t elf_len;
+  uint8_t *elf = read_file(argv[opt], &elf_len);
+  if (elf == NULL || !load_symbols(elf, elf_len)) {
+    fprintf(stderr, "'%s' não é um ELF com tabela de símbolos\n", argv[opt]);
+    return 1;
+  }
+  qsort(symbols, symbol_count, sizeof(*symbols), by_addr);
+
+  FILE *in = argc - opt == 2 ? fopen(argv[opt + 1], "r") : stdin;
+  if (in == NULL) {
+    fprintf(stderr, "não foi possível abrir '%s'\n", argv[opt + 1]);
+    return 1;
+  }
+
+  sample_t *samples = NULL;
+  size_t count = 0;
+  unsigned long total = 0, lost = 0, period_us = 0, pc, hits;
+  unsigned long long anchor = 0;
+  bool inside = false, found = false;
+  char line[256];
+  while (fgets(line, sizeof(line), in)) {
+    // O console pode prefixar as linhas (eco, "\r"): procura o marcador na linha
+    char *p = strstr(line, "PROF BEGIN ");
+    if (p != NULL) {
+      unsigned long n;
+      if (sscanf(p, "PROF BEGIN %lu %lu %lu %lu %llx", &n, &total, &lost, &period_us, &anchor) == 5) {
+        count = 0;                  // Vale o último envio da captura
+        inside = found = true;
+      }
+      continue;
+    }
+    if (strstr(line, "PROF END") != NULL) {
+      inside = false;
+      continue;
+    }
+    if (inside && sscanf(line, "P %lx %lu", &pc, &hits) == 2) {
+      samples = realloc(samples, (count + 1) * sizeof(*samples));
+      samples[count].pc = pc;
+      samples[count++].count = (uint32_t)hits;
+    }
+  }
+  if (in != stdin)
+    fclose(in);
+  if (!found) {
+    fprintf(stderr, "nenhum \"PROF BEGIN\" na captura\n");
+    return 1;
+  }
+
+  // Relocação: endereço de profiler_start na execução menos o do ELF
+  uint64_t bias = 0;
+  for (size_t i = 0; i < symbol_count; ++i)
+    if (strcmp(symbols[i].name, ANCHOR_SYMBOL) == 0)
+      bias = (anchor & ~1ull) - symbols[i].addr;
+
+  function_t *functions = calloc(symbol_count + 1, sizeof(*functions));
+  for (size_t i = 0; i <= symbol_count; ++i)
+    functions[i].symbol = i < symbol_count ? (int)i : -1;
+  uint64_t sampled = 0;
+  for (size_t i = 0; i < count; ++i) {
+    samples[i].symbol = find_symbol(samples[i].pc - bias);
+    functions[samples[i].symbol >= 0 ? (size_t)samples[i].symbol : symbol_count].count += samples[i].count;
+    sampled += samples[i].count;
+  }
+  qsort(functions, symbol_count + 1, sizeof(*functions), by_function_count);
+  if (sampled == 0) {
+    printf("nenhuma amostra na captura\n");
+    return 0;
+  }
+
+  printf("%lu amostras (%lu perdidas) a cada %lu us = %.2f s; %zu endereços\n", total, lost, period_us,
+         total * (double)period_us / 1e6, count);
+  printf("%10s %7s %7s  %s\n", "amostras", "%", "acum. %", "função");
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i <= symbol_count && functions[i].count > 0; ++i) {
+    cumulative += functions[i].count;
+    printf("%10llu %6.2f%% %6.2f%%  %s\n", (unsigned long long)functions[i].count,
+           100.0 * functions[i].count / sampled, 100.0 * cumulative / sampled,
+           functions[i].symbol >= 0 ? symbols[functions[i].symbol].name : "(fora de funções)");
+  }
+
+  if (addresses) {
+    qsort(samples, count, sizeof(*samples), by_sample_count);
+    printf("\n%10s %7s  %-18s %s\n", "amostras", "%", "endereço", "função+deslocamento");
+    for (size_t i = 0; i < count && i < 40; ++i) {
+      uint64_t addr = samples[i].pc - bias;
+      const symbol_t *s = samples[i].symbol >= 0 ? &symbols[samples[i].symbol] : NULL;
+      printf("%10u %6.2f%%  0x%-16llx %s+0x%llx\n", samples[i].count, 100.0 * samples[i].count / sampled,
+             (unsigned long long)addr, s ? s->name : "?", (unsigned long long)(s ? addr - s->addr : 0));
+    }
+  }
+
+  free(functions);
+  free(samples);
+  free(symbols);
+  free(elf);
+  return 0;
+}
@@ -0,0 +1,195 @@
+#include "src/trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Converte o fluxo de rastreamento da UART (src/trace.c) para o formato de
+ * trace do Chrome (JSON), aberto em chrome://tracing ou no Perfetto.
+ *
+ * A entrada é a captura crua da UART, com o texto do console intercalado:
+ * bytes fora de quadros são ignorados e quadros com a soma errada são
+ * descartados. Como o tempo vem em deltas, após um quadro descartado os
+ * quadros são ignorados até o próximo tempo absoluto. Cada núcleo vira uma
+ * thread; operações assíncronas (transferência I2C, etapas do acesso) viram
+ * trilhas próprias. No stderr sai um resumo com a duração de cada trecho.
+ *
+ * Uso: trace_to_json [captura.bin] > trace.json
+ */
+
+static const char *const trace_names[] = {
+#define TRACE_ID_NAME(id, name) name,
+  TRACE_IDS(TRACE_ID_NAME)
+#undef TRACE_ID_NAME
+};
+
+static const char phase_codes[] = {'i', 'B', 'E', 'b', 'e'};
+
+typedef struct {
+  bool have_time;
+  uint64_t time_us;                 // Tempo do último quadro, sem a volta dos 32 bits
+  uint64_t stack[16][2];            // Trechos B abertos: id e início
+  int depth;
+} core_state_t;
+
+typedef struct {
+  uint32_t count;
+  uint64_t total_us;
+  uint64_t max_us;
+  uint64_t async_start_us;
+  bool async_open;
+} id_stats_t;
+
+static core_state_t cores[2];
+static id_stats_t stats[TRACE_ID_COUNT];
+
+static void add_duration(uint8_t id, uint64_t us) {
+  stats[id].count++;
+  stats[id].total_us += us;
+  if (us > stats[id].max_us)
+    stats[id].max_us = us;
+}
+
+// Lê um varint de até max_bytes; retorna o número de bytes ou 0 se inválido
+static size_t get_varint(const uint8_t *p, size_t avail, size_t max_bytes, uint32_t *value) {
+  uint32_t v = 0;
+  for (size_t i = 0; i < avail && i < max_bytes; ++i) {
+    v |= (uint32_t)(p[i] & 0x7F) << (7 * i);
+    if (!(p[i] & 0x80)) {
+      *value = v;
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+// Valida o quadro em p (p[0] == TRACE_SYNC); retorna seu tamanho ou 0
+static size_t parse_frame(const uint8_t *p, size_t avail, uint8_t *hdr, uint8_t *id, uint32_t *time, uint32_t *arg) {
+  if (avail < 6)
+    return 0;
+  *hdr = p[1];
+  *id = p[2];
+  if ((*hdr & 0x38) || (*hdr & TRACE_HDR_PHASE) > TRACE_PHASE_ASYNC_END || *id >= TRACE_ID_COUNT)
+    return 0;
+  size_t n = 3;
+  size_t k = get_varint(p + n, avail - n, 5, time);
+  if (k == 0)
+    return 0;
+  n += k;
+  k = get_varint(p + n, avail - n, 3, arg);
+  if (k == 0 || *arg > UINT16_MAX || n + k >= avail)
+    return 0;
+  n += k;
+  uint8_t sum = 0;
+  for (size_t i = 1; i < n; ++i)
+    sum += p[i];
+  if ((uint8_t)~sum != p[n])
+    return 0;
+  return n + 1;
+}
+
+int main(int argc, char **argv) {
+  FILE *in = stdin;
+  if (argc > 2 || (argc == 2 && argv[1][0] == '-')) {
+    fprintf(stderr, "uso: %s [captura.bin] > trace.json\n", argv[0]);
+    return 2;
+  }
+  if (argc == 2 && (in = fopen(argv[1], "rb")) == NULL) {
+    fprintf(stderr, "não foi possível abrir '%s'\n", argv[1]);
+    return 1;
+  }
+
+  uint8_t *data = NULL;
+  size_t len = 0, capacity = 0, n;
+  do {
+    if (len == capacity) {
+      capacity = capacity ? capacity * 2 : 1 << 16;
+      data = realloc(data, capacity);
+    }
+    n = fread(data + len, 1, capacity - len, in);
+    len += n;
+  } while (n > 0);
+  if (in != stdin)
+    fclose(in);
+
+  printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  for (int core = 0; core < 2; ++core)
+    printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"núcleo %d\"}},\n",
+           core, core);
+
+  size_t frames = 0, corrupt = 0, skipped = 0, text = 0;
+  uint64_t dropped = 0;
+  bool first = true;
+  for (size_t i = 0; i < len;) {
+    uint8_t hdr, id;
+    uint32_t time, arg;
+    size_t size = data[i] == TRACE_SYNC ? parse_frame(data + i, len - i, &hdr, &id, &time, &arg) : 0;
+    if (size == 0) {
+      if (data[i] == TRACE_SYNC) {
+        // Quadro corrompido (provavelmente por texto intercalado): os deltas perdem a referência
+        ++corrupt;
+        cores[0].have_time = cores[1].have_time = false;
+      } else {
+        ++text;
+      }
+      ++i;
+      continue;
+    }
+    i += size;
+
+    core_state_t *c = &cores[(hdr & TRACE_HDR_CORE1) ? 1 : 0];
+    if (hdr & TRACE_HDR_ABS) {
+      // Tempo absoluto de 32 bits: desfaz a volta do contador a partir do anterior
+      c->time_us = c->have_time ? c->time_us + (uint32_t)(time - (uint32_t)c->time_us) : time;
+      c->have_time = true;
+    } else if (c->have_time) {
+      c->time_us += time;
+    } else {
+      ++skipped;
+      continue;
+    }
+    ++frames;
+
+    uint8_t phase = hdr & TRACE_HDR_PHASE;
+    int tid = c == &cores[1];
+    if (id == TRACE_DROPPED)
+      dropped += arg;
+    printf("%s{\"name\":\"%s\",\"cat\":\"trace\",\"ph\":\"%c\",\"ts\":%llu,\"pid\":1,\"tid\":%d", first ? "" : ",\n",
+           trace_names[id], phase_codes[phase], (unsigned long long)c->time_us, tid);
+    first = false;
+    if (phase == TRACE_PHASE_INSTANT)
+      printf(",\"s\":\"t\"");
+    else if (phase >= TRACE_PHASE_ASYNC_BEGIN)
+      printf(",\"id\":%u", id);
+    printf(",\"args\":{\"arg\":%u}}", arg);
+
+    // Durações para o resumo: trechos B/E aninham por núcleo; assíncronos, um por id
+    if (phase == TRACE_PHASE_BEGIN && c->depth < 16) {
+      c->stack[c->depth][0] = id;
+      c->stack[c->depth++][1] = c->time_us;
+    } else if (phase == TRACE_PHASE_END && c->depth > 0 && c->stack[c->depth - 1][0] == id) {
+      add_duration(id, c->time_us - c->stack[--c->depth][1]);
+    } else if (phase == TRACE_PHASE_END) {
+      c->depth = 0;                 // Início perdido: recomeça o aninhamento
+    } else if (phase == TRACE_PHASE_ASYNC_BEGIN) {
+      stats[id].async_start_us = c->time_us;
+      stats[id].async_open = true;
+    } else if (phase == TRACE_PHASE_ASYNC_END && stats[id].async_open) {
+      stats[id].async_open = false;
+      add_duration(id, c->time_us - stats[id].async_start_us);
+    }
+  }
+  printf("\n]}\n");
+  free(data);
+
+  fprintf(stderr, "%zu eventos, %zu quadros corrompidos, %zu ignorados sem referência de tempo, "
+                  "%zu bytes de texto, %llu registros perdidos na placa\n",
+          frames, corrupt, skipped, text, (unsigned long long)dropped);
+  fprintf(stderr, "%-24s %8s %10s %10s\n", "trecho", "n", "média us", "máx. us");
+  for (int id = 0; id < TRACE_ID_COUNT; ++id)
+    if (stats[id].count)
+      fprintf(stderr, "%-24s %8u %10.1f %10llu\n", trace_names[id], stats[id].count,
+              (double)stats[id].total_us / stats[id].count, (unsigned long long)stats[id].max_us);
+  return 0;
+}
@@ -0,0 +1,203 @@
+#include "src/voiceprint.h"
+#include "wav.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Avalia o voiceprint sobre um corpus de gravações WAV.
+ *
+ * O corpus é uma lista de linhas "<locutor> <arquivo.wav>". As primeiras
+ * gravações de cada locutor (-e, padrão 2) viram os modelos dele; as demais
+ * são tentativas genuínas contra os próprios modelos, e todas as gravações
+ * dos outros locutores são tentativas de impostor. O relatório traz o tempo
+ * de extração e de verificação (no host), a memória das estruturas e as
+ * taxas de falsa aceitação/rejeição no limiar (-t) e no ponto de igual erro.
+ *
+ * Uso: voiceprint_bench [-e cadastros] [-t limiar] <lista.txt>
+ */
+
+#define MAX_SPEAKERS 32
+#define MAX_NAME     32
+
+typedef struct {
+  char speaker[MAX_NAME];
+  int speaker_id;
+  voiceprint_utterance_t utt;
+  bool usable;
+  bool enrolled;
+} recording_t;
+
+typedef struct {
+  uint32_t distance;
+  bool genuine;
+} trial_t;
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int cmp_trial(const void *a, const void *b) {
+  uint32_t da = ((const trial_t *)a)->distance, db = ((const trial_t *)b)->distance;
+  return da < db ? -1 : da > db;
+}
+
+int main(int argc, char **argv) {
+  int enroll_count = 2;
+  long threshold = VOICEPRINT_ACCEPT_DISTANCE;
+  int opt = 1;
+  for (; opt < argc - 1 && argv[opt][0] == '-'; opt += 2) {
+    if (strcmp(argv[opt], "-e") == 0)
+      enroll_count = atoi(argv[opt + 1]);
+    else if (strcmp(argv[opt], "-t") == 0)
+      threshold = atol(argv[opt + 1]);
+    else
+      break;
+  }
+  if (opt != argc - 1 || enroll_count < 1 || enroll_count > VOICEPRINT_MAX_TEMPLATES) {
+    fprintf(stderr, "uso: %s [-e cadastros (1..%d)] [-t limiar] <lista.txt>\n", argv[0], VOICEPRINT_MAX_TEMPLATES);
+    return 2;
+  }
+
+  FILE *list = fopen(argv[opt], "r");
+  if (list == NULL) {
+    fprintf(stderr, "não foi possível abrir '%s'\n", argv[opt]);
+    return 1;
+  }
+  // Caminhos relativos na lista partem do diretório da própria lista
+  char base[512] = "";
+  const char *slash = strrchr(argv[opt], '/');
+  if (slash != NULL)
+    snprintf(base, sizeof(base), "%.*s/", (int)(slash - argv[opt]), argv[opt]);
+
+  recording_t *recs = NULL;
+  size_t rec_count = 0, rec_capacity = 0;
+  char names[MAX_SPEAKERS][MAX_NAME];
+  int speaker_count = 0;
+  static voiceprint_frontend_t fe;
+  double extract_ns = 0, audio_s = 0;
+
+  char line[600], name[MAX_NAME], file[512], path[1100];
+  while (fgets(line, sizeof(line), list)) {
+    if (line[0] == '#' || sscanf(line, "%31s %511s", name, file) != 2)
+      continue;
+    snprintf(path, sizeof(path), "%s%s", file[0] == '/' ? "" : base, file);
+    wav_t wav;
+    if (!wav_load(path, &wav))
+      return 1;
+
+    if (rec_count == rec_capacity) {
+      rec_capacity = rec_capacity ? rec_capacity * 2 : 64;
+      recs = realloc(recs, rec_capacity * sizeof(*recs));
+    }
+    recording_t *r = &recs[rec_count++];
+    memset(r, 0, sizeof(*r));
+    snprintf(r->speaker, sizeof(r->speaker), "%s", name);
+    r->speaker_id = -1;
+    for (int s = 0; s < speaker_count; ++s)
+      if (strcmp(names[s], name) == 0)
+        r->speaker_id = s;
+    if (r->speaker_id < 0) {
+      if (speaker_count == MAX_SPEAKERS) {
+        fprintf(stderr, "mais de %d locutores\n", MAX_SPEAKERS);
+        return 1;
+      }
+      snprintf(names[speaker_count], MAX_NAME, "%s", name);
+      r->speaker_id = speaker_count++;
+    }
+
+    size_t n = wav_adc_length(&wav, 8000);
+    double t0 = now_ns();
+    voiceprint_frontend_init(&fe, &r->utt);
+    for (size_t i = 0; i < n; ++i)
+      voiceprint_frontend_push(&fe, wav_adc_sample(&wav, i, 8000, 2048));
+    r->usable = voiceprint_utterance_finish(&r->utt);
+    extract_ns += now_ns() - t0;
+    audio_s += n / 8000.0;
+    wav_free(&wav);
+  }
+  fclose(list);
+
+  // Cadastro: as primeiras gravações utilizáveis de cada locutor
+  voiceprint_store_t *stores = calloc(speaker_count, sizeof(*stores));
+  for (size_t i = 0; i < rec_count; ++i) {
+    recording_t *r = &recs[i];
+    if (r->usable && stores[r->speaker_id].count < enroll_count)
+      r->enrolled = voiceprint_enroll(&stores[r->speaker_id], &r->utt);
+  }
+
+  trial_t *trials = malloc((rec_count * speaker_count + 1) * sizeof(*trials));
+  size_t trial_count = 0, genuine = 0, impostor = 0, unusable = 0;
+  double verify_ns = 0, verify_max_ns = 0;
+  for (size_t i = 0; i < rec_count; ++i) {
+    recording_t *r = &recs[i];
+    if (r->enrolled)
+      continue;
+    if (!r->usable)
+      ++unusable;
+    for (int s = 0; s < speaker_count; ++s) {
+      if (stores[s].count == 0)
+        continue;
+      uint32_t d;
+      double t0 = now_ns();
+      voiceprint_verify(&stores[s], &r->utt, &d);
+      double dt = now_ns() - t0;
+      verify_ns += dt;
+      if (dt > verify_max_ns)
+        verify_max_ns = dt;
+      trials[trial_count].distance = d;
+      trials[trial_count].genuine = s == r->speaker_id;
+      genuine += trials[trial_count].genuine;
+      impostor += !trials[trial_count].genuine;
+      ++trial_count;
+    }
+  }
+
+  size_t false_reject = 0, false_accept = 0;
+  for (size_t i = 0; i < trial_count; ++i) {
+    bool accept = trials[i].distance <= (uint32_t)threshold;
+    false_reject += trials[i].genuine && !accept;
+    false_accept += !trials[i].genuine && accept;
+  }
+
+  // Ponto de igual erro: percorre os limiares em ordem de distância
+  qsort(trials, trial_count, sizeof(*trials), cmp_trial);
+  double eer = 1.0;
+  uint32_t eer_threshold = 0;
+  size_t accepted_genuine = 0, accepted_impostor = 0;
+  for (size_t i = 0; i < trial_count; ++i) {
+    accepted_genuine += trials[i].genuine;
+    accepted_impostor += !trials[i].genuine;
+    if (i + 1 < trial_count && trials[i + 1].distance == trials[i].distance)
+      continue;
+    double frr = genuine ? 1.0 - (double)accepted_genuine / genuine : 0;
+    double far = impostor ? (double)accepted_impostor / impostor : 0;
+    double worst = frr > far ? frr : far;
+    if (worst < eer) {
+      eer = worst;
+      eer_threshold = trials[i].distance;
+    }
+  }
+
+  printf("gravações: %zu (%d locutores, %.1f s de áudio, %zu curtas demais)\n",
+         rec_count, speaker_count, audio_s, unusable);
+  printf("extração: %.1f us por segundo de áudio\n", audio_s > 0 ? extract_ns / 1e3 / audio_s : 0);
+  printf("verificação: %.1f us média, %.1f us máximo (%zu tentativas)\n",
+         trial_count ? verify_ns / 1e3 / trial_count : 0, verify_max_ns / 1e3, trial_count);
+  printf("memória: extrator %zu B, frase %zu B, cadastro %zu B (%d modelos)\n",
+         sizeof(voiceprint_frontend_t), sizeof(voiceprint_utterance_t), sizeof(voiceprint_store_t),
+         VOICEPRINT_MAX_TEMPLATES);
+  printf("limiar %ld: FRR %.1f%% (%zu/%zu), FAR %.1f%% (%zu/%zu)\n", threshold,
+         genuine ? 100.0 * false_reject / genuine : 0, false_reject, genuine,
+         impostor ? 100.0 * false_accept / impostor : 0, false_accept, impostor);
+  printf("igual erro: %.1f%% no limiar %u\n", 100.0 * eer, eer_threshold);
+
+  free(trials);
+  free(stores);
+  free(recs);
+  return 0;
+}
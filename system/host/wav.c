@@ -0,0 +1,92 @@
+#include "wav.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t le32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t le16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+bool wav_load(const char *path, wav_t *out) {
+  memset(out, 0, sizeof(*out));
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) {
+    fprintf(stderr, "wav: não foi possível abrir '%s'\n", path);
+    return false;
+  }
+
+  uint8_t header[12];
+  uint16_t format = 0, channels = 0, bits = 0;
+  bool ok = fread(header, 1, sizeof(header), f) == sizeof(header) &&
+            memcmp(header, "RIFF", 4) == 0 && memcmp(header + 8, "WAVE", 4) == 0;
+
+  // Percorre os blocos até "data", guardando o formato de "fmt "
+  while (ok) {
+    uint8_t chunk[8];
+    if (fread(chunk, 1, sizeof(chunk), f) != sizeof(chunk)) {
+      ok = false;
+      break;
+    }
+    uint32_t size = le32(chunk + 4);
+    if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+      uint8_t fmt[16];
+      ok = fread(fmt, 1, sizeof(fmt), f) == sizeof(fmt);
+      format = le16(fmt);
+      channels = le16(fmt + 2);
+      out->rate_hz = le32(fmt + 4);
+      bits = le16(fmt + 14);
+      fseek(f, (long)(size - 16 + (size & 1)), SEEK_CUR);
+    } else if (memcmp(chunk, "data", 4) == 0) {
+      if (format != 1 || channels == 0 || (bits != 8 && bits != 16) || out->rate_hz == 0) {
+        fprintf(stderr, "wav: '%s' não é PCM de 8 ou 16 bits\n", path);
+        fclose(f);
+        return false;
+      }
+      size_t frame_bytes = (size_t)channels * (bits / 8);
+      uint8_t *raw = malloc(size ? size : 1);
+      size = (uint32_t)fread(raw, 1, size, f);
+      out->count = size / frame_bytes;
+      out->samples = malloc((out->count ? out->count : 1) * sizeof(int16_t));
+      for (size_t i = 0; i < out->count; ++i) {
+        int32_t sum = 0;
+        for (uint16_t c = 0; c < channels; ++c) {
+          const uint8_t *p = raw + i * frame_bytes + c * (bits / 8);
+          sum += bits == 16 ? (int16_t)le16(p) : ((int32_t)p[0] - 128) << 8;
+        }
+        out->samples[i] = (int16_t)(sum / channels);
+      }
+      free(raw);
+      break;
+    } else {
+      fseek(f, (long)(size + (size & 1)), SEEK_CUR);
+    }
+  }
+  fclose(f);
+
+  if (!ok) {
+    fprintf(stderr, "wav: '%s' inválido\n", path);
+    wav_free(out);
+  }
+  return ok;
+}
+
+void wav_free(wav_t *wav) {
+  free(wav->samples);
+  wav->samples = NULL;
+  wav->count = 0;
+}
+
+size_t wav_adc_length(const wav_t *wav, uint32_t rate_hz) {
+  return (size_t)((uint64_t)wav->count * rate_hz / wav->rate_hz);
+}
+
+// Amostra i do áudio reamostrado para rate_hz, como o ADC a leria em torno de bias
+uint16_t wav_adc_sample(const wav_t *wav, size_t i, uint32_t rate_hz, int bias) {
+  int v = bias + wav->samples[(size_t)((uint64_t)i * wav->rate_hz / rate_hz)] / 16;
+  return v < 0 ? 0 : v > 4095 ? 4095 : (uint16_t)v;
+}
@@ -0,0 +1,27 @@
+#ifndef WAV_H
+#define WAV_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Leitura de arquivos WAV PCM (8 ou 16 bits, qualquer número de canais)
+ * para o simulador e as ferramentas de host. Os canais são misturados em
+ * um único canal de 16 bits com sinal.
+ */
+
+typedef struct {
+  int16_t *samples;
+  size_t count;
+  uint32_t rate_hz;
+} wav_t;
+
+bool wav_load(const char *path, wav_t *out);
+void wav_free(wav_t *wav);
+
+// Reamostragem (vizinho mais próximo) para a escala de 12 bits do ADC
+size_t wav_adc_length(const wav_t *wav, uint32_t rate_hz);
+uint16_t wav_adc_sample(const wav_t *wav, size_t i, uint32_t rate_hz, int bias);
+
+#endif // WAV_H
@@ -1,20 +1,25 @@
 #include "main.h"
 
-// --- Variáveis globais ---
-uint32_t last_interrupt_time_A = 0;
-uint32_t last_interrupt_time_B = 0;
-uint32_t last_interrupt_time_JOYSTICK = 0;
-
 // --- Variáveis usada para mudança de funcionamento do sistema ---
 volatile bool access_control_mode = false;
 bool keypad_fault = false;
 bool buzzer_fault = false;
-volatile bool action_executed = false;
+bool flow_active = false;           // Um fluxo do menu está em andamento
+uint32_t flow_end_time = 0;         // Instante em que o último fluxo terminou
 bool bloq_system = false;
 
 
+// Eventos de botões gerados pelo debouncer (interrupção do temporizador) e consumidos no laço principal
+event_queue_t input_events;
+
+// Eventos de navegação gerados pelo joystick e consumidos pelo menu
+event_queue_t nav_events;
+
+// Teclas do teclado matricial (fonte = caractere da tecla)
+event_queue_t keypad_events;
+
 // Para a matriz de LEDs
-PIO pio = pio0;
+hal_pio_t pio = HAL_PIO0;
 uint sm = 0;
 
 
@@ -26,44 +31,40 @@ int code_index = 0;
 /* Funções de Inicialização */
 /*==========================*/
 
-void lock_system(void) {
-    bloq_system = true;
-}
-
 /**
  * @brief Inicializa um pino GPIO como saída para LED
  * @param pin Número do pino GPIO a ser configurado
  */
 void Led_init(uint pin){
-    gpio_init(pin);
-    gpio_set_dir(pin, GPIO_OUT);
-    gpio_put(pin, 0);
+    hal_gpio_init_output(pin);
 }
 
 /**
  * @brief Inicializa a comunicação UART com configurações padrão
  */
 void uart_init_function(void) {
-    uart_init(UART_ID, BAUD_RATE);
-    gpio_set_function(0, GPIO_FUNC_UART);
-    gpio_set_function(1, GPIO_FUNC_UART);
-    uart_set_format(UART_ID, 8, 1, UART_PARITY_NONE);
-    uart_set_fifo_enabled(UART_ID, true);
+    hal_uart_init(UART_ID, BAUD_RATE, UART_TX_PIN, UART_RX_PIN);
 }
 
 /**
- * @brief Inicializa o sistema ADC para o microfone
+ * @brief Carrega as senhas da flash; sem cadastro, grava as senhas padrão
  */
-void microphone_init(void) {
-    adc_init();
-    adc_gpio_init(MIC_PIN);
-    adc_select_input(2);
+void init_credentials(void) {
+    uint16_t count = credentials_init();
+    if (count == 0) {
+        credentials_add(DEFAULT_USER_CODE, CRED_ROLE_USER, NULL);
+        credentials_add(DEFAULT_ADMIN_CODE, CRED_ROLE_ADMIN, NULL);
+        printf("Cadastro de senhas vazio: senhas padrao gravadas (troque pelo comando cred)\n");
+    } else {
+        printf("%u senhas cadastradas\n", count);
+    }
 }
 
+/**
+ * @brief Inicia a amostragem contínua do joystick e do microfone
+ */
 void init_adc_system(void) {
-    adc_init();
-    adc_gpio_init(JOYSTICK_ADC_Y);
-    adc_gpio_init(JOYSTICK_ADC_X);
+    adc_sampler_init();
 }
 
 /*=======================*/
@@ -71,91 +72,246 @@ void init_adc_system(void) {
 /*=======================*/
 
 /**
- * @brief Gera tom em buzzer usando PWM
+ * @brief Melodias de erro e sucesso (frequência em Hz, duração em ms, ciclo em %)
+ */
+const melody_note_t error_melody[] = {
+    {262, 300, BUZZER_DUTY}, {294, 300, BUZZER_DUTY}, {330, 300, BUZZER_DUTY}, {349, 300, BUZZER_DUTY}
+};
+
+const melody_note_t success_melody[] = {
+    {400, 200, BUZZER_DUTY}, {500, 200, BUZZER_DUTY}, {600, 400, BUZZER_DUTY}
+};
+
+#define MELODY_LEN(m) (sizeof(m) / sizeof((m)[0]))
+
+/**
+ * @brief Toca sequência som para erro e sucesso no buzzer, em segundo plano
  * @param buzzer_pin Pino GPIO do buzzer
- * @param freq Frequência do tom em Hz
- * @param duration Duração do tom em ms
+ * @return Duração da sequência em ms
+ * @note O som de erro tem prioridade e interrompe o que estiver tocando
  */
-const uint error_melody[] = {262, 294, 330, 349};
-const uint error_durations[] = {300, 300, 300, 300};
+uint32_t play_error(uint buzzer_pin) {
+    melody_play(buzzer_pin, error_melody, MELODY_LEN(error_melody), MELODY_PRIO_HIGH);
+    return melody_duration_ms(error_melody, MELODY_LEN(error_melody));
+}
+
+uint32_t play_success(uint buzzer_pin) {
+    melody_play(buzzer_pin, success_melody, MELODY_LEN(success_melody), MELODY_PRIO_NORMAL);
+    return melody_duration_ms(success_melody, MELODY_LEN(success_melody));
+}
 
-const uint success_melody[] = {400, 500, 600};
-const uint success_durations[] = {200, 200, 400};
+/*=======================*/
+/* Funções do Microfone  */
+/*=======================*/
 
-void tocar_buzzer(uint buzzer_pin, uint freq, uint duration) {
-    gpio_set_function(buzzer_pin, GPIO_FUNC_PWM);
-    uint slice = pwm_gpio_to_slice_num(buzzer_pin);
-    uint chan = pwm_gpio_to_channel(buzzer_pin);
-    
-    pwm_set_wrap(slice, 125000000 / freq);
-    pwm_set_chan_level(slice, chan, DUTY_CYCLE);
-    pwm_set_enabled(slice, true);
-    
-    busy_wait_ms(duration);
-    pwm_set_enabled(slice, false);
+#if AUDIO_SAMPLE_RATE_HZ != ADC_SAMPLER_RATE_HZ
+#error "O extrator de áudio assume a taxa de amostragem do ADC"
+#endif
+
+#define MIC_SAMPLE_US (1000000u / ADC_SAMPLER_RATE_HZ)
+
+static audio_features_t mic_features;
+static noise_floor_t mic_noise;         // Piso de ruído, atualizado continuamente
+static uint32_t mic_cursor;
+static bool mic_listening;              // Uma escuta (voz ou teste) está em andamento
+static uint16_t mic_frames;
+static uint16_t mic_voiced_frames;
+static uint16_t mic_peak_rms;
+static bool mic_onset;                  // Houve início de fala durante a escuta
+static uint32_t mic_onset_us;
+static uint32_t mic_listen_us;
+
+// Frase capturada e modelos de voz cadastrados (cópia em RAM dos gravados na flash)
+static voiceprint_frontend_t voice_frontend;
+static voiceprint_utterance_t voice_utterance;
+static voiceprint_store_t voice_store;
+static bool voice_enroll_armed;         // A próxima frase válida vira modelo ("voice enroll")
+static bool voice_store_dirty;          // Modelos alterados, a gravar com o menu ocioso
+
+static bool mic_frame_voiced(const audio_frame_t *frame) {
+    uint32_t speech = (uint32_t)frame->band[0] + frame->band[1] + frame->band[2];
+    return mic_noise.active &&
+           frame->zcr >= MIC_VOICE_ZCR_MIN && frame->zcr <= MIC_VOICE_ZCR_MAX &&
+           speech >= frame->band[3];
 }
 
 /**
- * @brief Toca sequência som para erro e sucesso no buzzer
- * @param buzzer_pin Pino GPIO do buzzer
+ * @brief Consome as amostras novas do microfone, atualiza o piso de ruído e,
+ *        durante uma escuta, classifica os quadros e alimenta o voiceprint
+ * @note Tarefa periódica; cada execução processa ~MIC_TASK_MS de áudio
  */
-void play_error(uint buzzer_pin) {
-    for (int i = 0; i < sizeof(error_melody)/sizeof(error_melody[0]); i++) {
-        tocar_buzzer(buzzer_pin, error_melody[i], error_durations[i]);
+static void mic_task(void *ctx) {
+    uint16_t block[AUDIO_FRAME_SAMPLES];
+    audio_frame_t frame;
+    size_t n;
+    while ((n = adc_sampler_read(ADC_CH_MIC, &mic_cursor, block, AUDIO_FRAME_SAMPLES)) > 0) {
+        // A última amostra do bloco é a conversão mais recente
+        uint32_t last_us = hal_time_us_32();
+        for (size_t i = 0; i < n; i++) {
+            if (mic_listening) {
+                voiceprint_frontend_push(&voice_frontend, block[i]);
+            }
+            if (!audio_features_push(&mic_features, block[i], &frame)) {
+                continue;
+            }
+            uint32_t start_us = last_us - (uint32_t)(n - 1 - i + AUDIO_FRAME_SAMPLES - 1) * MIC_SAMPLE_US;
+            bool onset = noise_floor_update(&mic_noise, frame.rms, start_us);
+            if (!mic_listening) {
+                continue;
+            }
+            if (onset && !mic_onset) {
+                mic_onset = true;
+                mic_onset_us = mic_noise.onset_us;
+            }
+            mic_frames++;
+            if (frame.rms > mic_peak_rms) {
+                mic_peak_rms = frame.rms;
+            }
+            if (mic_frame_voiced(&frame)) {
+                mic_voiced_frames++;
+            }
+        }
     }
 }
 
-void play_success(uint buzzer_pin) {
-    for (int i = 0; i < sizeof(success_melody)/sizeof(success_melody[0]); i++) {
-        tocar_buzzer(buzzer_pin, success_melody[i], success_durations[i]);
+/**
+ * @brief Inicia a análise contínua do microfone e a calibração do piso de ruído
+ */
+void microphone_init(void) {
+    audio_features_init(&mic_features);
+    noise_floor_init(&mic_noise);
+    mic_cursor = adc_sampler_cursor(ADC_CH_MIC);
+    mic_listening = false;
+    sched_every(mic_task, NULL, MIC_TASK_MS);
+}
+
+/**
+ * @brief Começa a contar quadros de fala e a capturar a frase para o voiceprint
+ */
+void microphone_listen_start(void) {
+    mic_task(NULL);     // Descarta o áudio anterior à escuta
+    voiceprint_frontend_init(&voice_frontend, &voice_utterance);
+    mic_frames = 0;
+    mic_voiced_frames = 0;
+    mic_peak_rms = 0;
+    mic_onset = false;
+    mic_listen_us = hal_time_us_32();
+    mic_listening = true;
+}
+
+/**
+ * @brief Encerra a escuta iniciada por microphone_listen_start()
+ * @return Número de quadros classificados como fala
+ */
+uint16_t microphone_listen_stop(void) {
+    mic_task(NULL);
+    mic_listening = false;
+    printf("Quadros com voz: %u de %u (limiar %u)\n",
+           mic_voiced_frames, mic_frames, noise_floor_threshold(&mic_noise));
+    if (mic_onset) {
+        printf("Fala iniciada %ld ms após o aviso\n", (long)(int32_t)(mic_onset_us - mic_listen_us) / 1000);
     }
+    return mic_voiced_frames;
+}
+
+/**
+ * @brief Compara a frase capturada com os modelos de voz, ou a cadastra
+ * @return true se a voz for reconhecida ou cadastrada
+ * @note Só cadastra depois de "voice enroll <senha admin>"; sem modelos
+ *       cadastrados a voz é sempre recusada
+ */
+bool voice_verify(void) {
+    if (!voiceprint_utterance_finish(&voice_utterance)) {
+        printf("Frase curta demais (%u quadros de fala)\n", voice_utterance.frames);
+        return false;
+    }
+    if (voice_enroll_armed) {
+        voice_enroll_armed = false;
+        if (!voiceprint_enroll(&voice_store, &voice_utterance)) {
+            printf("Modelos de voz cheios (%u modelos)\n", VOICEPRINT_MAX_TEMPLATES);
+            return false;
+        }
+        voice_store_dirty = true;
+        printf("Voz cadastrada: modelo %u (%u quadros)\n", voice_store.count - 1, voice_utterance.frames);
+        return true;
+    }
+    if (voice_store.count == 0) {
+        printf("Nenhuma voz cadastrada (use voice enroll)\n");
+        return false;
+    }
+    uint32_t distance;
+    uint32_t start = hal_time_us_32();
+    bool ok = voiceprint_verify(&voice_store, &voice_utterance, &distance);
+    printf("Distância da voz: %lu (limite %u), verificada em %lu us\n",
+           (unsigned long)distance, VOICEPRINT_ACCEPT_DISTANCE, (unsigned long)(hal_time_us_32() - start));
+    return ok;
 }
 
 /*=======================*/
-/* Funções do Microfone  */
+/* Fluxos e Entrada      */
 /*=======================*/
 
-/**
- * @brief Lê valor atual do microfone via ADC
- * @return Valor lido do ADC (12-bit)
+/*
+ * Os fluxos do menu (teste, acesso, travamento e diagnóstico) são máquinas de
+ * estados: cada passo faz o trabalho imediato e agenda o próximo com o tempo
+ * que antes era gasto em busy_wait_ms. Apenas um fluxo fica ativo por vez.
  */
-uint16_t microphone_read(void) {
-    return adc_read();
+
+typedef void (*code_done_t)(const char *code);   // code é NULL se o prazo esgotou
+static code_done_t code_done = NULL;   // Destino dos dígitos lidos pela USB/UART
+static uint8_t flow_state;
+
+static void flow_next(sched_task_t step, uint8_t state, uint32_t delay_ms) {
+    flow_state = state;
+    sched_post(step, NULL, delay_ms);
 }
 
+// Encerra o fluxo atual e devolve o controle ao menu
+static void flow_end(void) {
+    flow_active = false;
+    flow_end_time = hal_time_us_32();
+    draw_menu();
+}
 
 /**
- * @brief faz a detecção para confirmar o reconhecimento de voz
- */
-void microphone_access(void) {
-    display_message("RECONHECIMENTO", "DE", "VOZ");
-    printf("Iniciando Reconhecimento de voz!\n");
-    busy_wait_ms(1000);
-    uint16_t adc_value = microphone_read();
-    if (adc_value > SOUND_THRESHOLD) {
-        printf("Som detectado. Iniciando verificação de acesso...\n");
-        gpio_put(LED_RED, 1);
-        busy_wait_ms(500);
-        gpio_put(LED_RED, 0);
-        busy_wait_ms(1000);
-
-        if ((gpio_get(JOYSTICK_BTN) == 0)) { //usa do botão do joystick para simular voz não reconhecida
-            printf("Acesso negado!\n");
-            display_message("VOZ", "NAO", "RECONHECIDA");
-            gpio_put(LED_RED, 1);
-            busy_wait_ms(1000);
-            gpio_put(LED_RED, 0);
-            busy_wait_ms(1000);
+ * @brief Passa a entregar para done a primeira senha de CODE_LENGTH dígitos
+ * digitada inteira por uma mesma origem (USB ou UART)
+ */
+static void code_begin(code_done_t done) {
+    code_index = 0;
+    memset(entered_code, 0, sizeof(entered_code));
+    code_done = done;
+    input_line_begin(CODE_LENGTH, CODE_TIMEOUT_MS);
+}
 
-        } else {
-            printf("Acesso concedido!\n");
-            display_message("VOZ", "RECONHECIDA", "");
-            play_success(BUZZER1_PIN);
-            gpio_put(LED_GREEN, 1);
-            busy_wait_ms(1000);
-            gpio_put(LED_GREEN, 0);
-            busy_wait_ms(1000);
+/**
+ * @brief Monta a senha com os caracteres recebidos por interrupção
+ * @note Tarefa periódica; com o menu ocioso os caracteres formam linhas de
+ * comando do console. Durante um fluxo que ainda não pediu a senha eles ficam
+ * nos anéis (e, com eles cheios, nos buffers da USB e da UART).
+ */
+static void input_task(void *ctx) {
+    if (code_done == NULL) {
+        if (!flow_active) {
+            console_poll();
         }
+        return;
+    }
+
+    uint8_t source;
+    input_line_status_t status = input_line_poll(entered_code, &source);
+    if (status == INPUT_LINE_PENDING) {
+        return;
+    }
+
+    // Entrega ao fluxo que a solicitou
+    code_done_t done = code_done;
+    code_done = NULL;
+    if (status == INPUT_LINE_READY) {
+        code_index = CODE_LENGTH;
+        done(entered_code);
+    } else {
+        done(NULL);
     }
 }
 
@@ -163,65 +319,177 @@ void microphone_access(void) {
 /* Funções de Controle de Acesso */
 /*===============================*/
 
-/**
- * @brief Processa entrada de código de acesso via UART/USB
- * @note Gerencia a interface de usuário durante a entrada do código
+/*
+ * Cada fator da tentativa é uma verificação do pipeline (src/verify_pipeline.c),
+ * iniciada assim que possível: a captura da voz começa com o resultado da
+ * senha ainda na tela (logo após a melodia, que o microfone ouviria) e a
+ * animação da íris roda enquanto a voz é comparada. A política decide na
+ * primeira falha de um fator obrigatório, interrompendo os que ainda estão em
+ * andamento, ou na aprovação do último deles.
  */
-void process_access_control(void) {
-    // Enquanto o código não estiver completo, mantenha a mensagem "OBTENDO SENHA" exibida
-    display_message("OBTENDO", "SENHA", "");
 
-    // Tenta ler da USB
-    int c_usb = getchar_timeout_us(0);
-    if (c_usb != PICO_ERROR_TIMEOUT && c_usb >= '0' && c_usb <= '9') {
-        entered_code[code_index++] = (char)c_usb;
-        printf("*"); // Exibe um '*' para cada dígito
+enum {
+    ACCESS_CHECK,
+    ACCESS_VOICE,
+    ACCESS_VOICE_SAMPLE,
+    ACCESS_VOICE_SCORE,
+    ACCESS_END
+};
+
+static void access_step(void *ctx);
+
+static cred_user_t access_user;         // Dono da senha aceita
+static access_log_record_t access_record;   // Tentativa em andamento, gravada ao fim
+static verify_pipeline_t access_verify;
+static uint32_t access_start_us;            // Início da digitação
+static bool access_decided;
+
+// Exibe e registra a decisão da política (uma vez por tentativa)
+static void access_decide(void) {
+    if (access_decided || access_verify.decision == VERIFY_PENDING) {
+        return;
     }
-    
-    // Tenta ler da UART
-    if (uart_is_readable(UART_ID)) {
-        char c = uart_getc(UART_ID);
-        if (c >= '0' && c <= '9') {
-            entered_code[code_index++] = c;
-            uart_putc(UART_ID, '*');
+    access_decided = true;
+    TRACE_INSTANT(ACCESS_DECISION, access_verify.decision);
+    if (access_verify.running & LOG_FACTOR_IRIS) {
+        iris_cancel();
+        TRACE_ASYNC_END(ACCESS_IRIS, 2);    // 2: cancelada
+    }
+
+    bool granted = access_verify.decision == VERIFY_GRANTED;
+    uint32_t decision_ms = access_verify.decision_us / 1000;
+    access_record.result = granted ? LOG_RESULT_OK : LOG_RESULT_DENIED;
+    access_record.flags = access_verify.passed;
+    access_record.stage_us[LOG_STAGE_VOICE] = verify_job_us(&access_verify, LOG_FACTOR_VOICE);
+    access_record.stage_us[LOG_STAGE_IRIS] = verify_job_us(&access_verify, LOG_FACTOR_IRIS);
+    access_record.decision_ms = decision_ms > UINT16_MAX ? UINT16_MAX : (uint16_t)decision_ms;
+    printf("Decisão em %lu ms (senha %s, voz %s, íris %s)\n", (unsigned long)decision_ms,
+           access_verify.passed & LOG_FACTOR_CODE ? "ok" : access_verify.failed & LOG_FACTOR_CODE ? "falhou" : "-",
+           access_verify.passed & LOG_FACTOR_VOICE ? "ok" : access_verify.failed & LOG_FACTOR_VOICE ? "falhou" : "-",
+           access_verify.passed & LOG_FACTOR_IRIS ? "ok" : access_verify.failed & LOG_FACTOR_IRIS ? "falhou" : "-");
+
+    if (granted) {
+        printf("Acesso concedido!\n");
+        display_message("ACESSO", "", "LIBERADO");
+        hal_gpio_put(LED_GREEN, 1);
+        play_success(BUZZER1_PIN);
+    } else {
+        printf("Acesso negado!\n");
+        if (access_verify.failed & LOG_FACTOR_CODE) {
+            display_message("CODIGO", "INCORRETO", "");
+        } else if (access_verify.failed & LOG_FACTOR_VOICE) {
+            display_message("VOZ", "NAO", "RECONHECIDA");
+        } else {
+            display_message("IRIS", "NAO", "RECONHECIDA");
         }
+        hal_gpio_put(LED_GREEN, 0);
+        hal_gpio_put(LED_RED, 1);
+        play_error(BUZZER2_PIN);
     }
-    
-    // Se atingiu o tamanho da senha, valida-a
-    if (code_index >= CODE_LENGTH) {
-        entered_code[CODE_LENGTH] = '\0';
-        // Atualiza a mensagem após a conclusão da digitação
-        display_message("SENHA", "DIGITADA", "");
-        busy_wait_ms(200);
-        
-        if (strcmp(entered_code, VALID_CODE) == 0) {
-            printf("\nSenha Correta!\n");
-            play_success(BUZZER1_PIN);
-            display_message("CODIGO", "CORRETO", "");
-            gpio_put(LED_RED, 0);
-            gpio_put(LED_GREEN, 1);
-            busy_wait_ms(1000);
-            gpio_put(LED_GREEN, 0);
-            
-            // Após a senha correta, realiza verificação por microfone e iris
+    flow_next(access_step, ACCESS_END, 2000);
+}
+
+static void access_iris_done(bool ok) {
+    TRACE_ASYNC_END(ACCESS_IRIS, ok);
+    verify_job_done(&access_verify, LOG_FACTOR_IRIS, ok);
+    access_decide();
+}
+
+static void access_code_entered(const char *code) {
+    access_record.stage_us[LOG_STAGE_ENTRY] = hal_time_us_32() - access_start_us;
+    if (code == NULL) {
+        access_record.result = LOG_RESULT_TIMEOUT;
+        printf("\nTempo esgotado!\n");
+        display_message("TEMPO", "ESGOTADO", "");
+        hal_gpio_put(LED_RED, 1);
+        flow_next(access_step, ACCESS_END, play_error(BUZZER2_PIN));
+        return;
+    }
+    // O tempo até a decisão conta a partir da senha digitada
+    verify_begin(&access_verify, ACCESS_REQUIRED_FACTORS);
+    flow_next(access_step, ACCESS_CHECK, 0);
+}
+
+/**
+ * @brief Avança a verificação de acesso: senha, voz e íris
+ * @note Gerencia a interface de usuário durante todo o processo
+ */
+static void access_step(void *ctx) {
+    switch (flow_state) {
+        case ACCESS_CHECK: {
+            verify_job_start(&access_verify, LOG_FACTOR_CODE);
+            TRACE_BEGIN(ACCESS_CHECK, 0);
+            uint32_t start = hal_time_us_32();
+            bool ok = credentials_verify(entered_code, &access_user);
+            access_record.check_us = (uint16_t)(hal_time_us_32() - start);
+            TRACE_END(ACCESS_CHECK, ok);
+            verify_job_done(&access_verify, LOG_FACTOR_CODE, ok);
+            if (ok) {
+                access_record.user = access_user.id;
+                printf("\nSenha Correta! (usuario %u)\n", access_user.id);
+                display_message("CODIGO", "CORRETO", "");
+                hal_gpio_put(LED_RED, 0);
+                hal_gpio_put(LED_GREEN, 1);
+            } else {
+                printf("\nCódigo Incorreto!\n");
+            }
+            if (access_verify.decision != VERIFY_PENDING) {
+                access_decide();
+            } else {
+                // A voz é capturada logo após a melodia, com o resultado ainda na tela
+                flow_next(access_step, ACCESS_VOICE, ok ? play_success(BUZZER1_PIN) : 0);
+            }
+            break;
+        }
+        case ACCESS_VOICE:
+            verify_job_start(&access_verify, LOG_FACTOR_VOICE);
+            TRACE_ASYNC_BEGIN(ACCESS_VOICE, 0);
+            hal_gpio_put(LED_GREEN, 0);
             printf("\nVerificação de voz!\n");
-            microphone_access();
-            busy_wait_ms(2000);
+            display_message("CODIGO CORRETO", "", "FALE AGORA");
+            printf("Iniciando Reconhecimento de voz!\n");
+            microphone_listen_start();
+            flow_next(access_step, ACCESS_VOICE_SAMPLE, MIC_LISTEN_MS);
+            break;
+        case ACCESS_VOICE_SAMPLE:
+            if (microphone_listen_stop() >= MIC_VOICE_FRAMES) {
+                printf("Som detectado. Iniciando verificação de acesso...\n");
+                // Comparada no próximo passo, com a animação da íris já em andamento
+                flow_next(access_step, ACCESS_VOICE_SCORE, 0);
+            } else {
+                printf("Nenhuma fala detectada.\n");
+                TRACE_ASYNC_END(ACCESS_VOICE, 0);
+                verify_job_done(&access_verify, LOG_FACTOR_VOICE, false);
+            }
+            if (access_verify.decision != VERIFY_PENDING) {
+                access_decide();
+                break;
+            }
             printf("\nVerificação de iris!\n");
-            iris_scan(pio, sm, BUTTON_B);
-            busy_wait_ms(2000);
-        } else {
-            printf("\nCódigo Incorreto!\n");
-            play_error(BUZZER2_PIN);
-            display_message("CODIGO", "INCORRETO", "");
-            gpio_put(LED_RED, 1);
-            busy_wait_ms(2000);
+            verify_job_start(&access_verify, LOG_FACTOR_IRIS);
+            TRACE_ASYNC_BEGIN(ACCESS_IRIS, 0);
+            iris_scan(BUTTON_B, access_iris_done);
+            break;
+        case ACCESS_VOICE_SCORE: {
+            TRACE_BEGIN(ACCESS_SCORE, 0);
+            bool ok = voice_verify();
+            TRACE_END(ACCESS_SCORE, ok);
+            TRACE_ASYNC_END(ACCESS_VOICE, ok);
+            printf(ok ? "Voz reconhecida.\n" : "Voz não reconhecida.\n");
+            verify_job_done(&access_verify, LOG_FACTOR_VOICE, ok);
+            access_decide();
+            break;
         }
-        gpio_put(LED_RED, 0);
-        // Reinicia a entrada para nova tentativa
-        code_index = 0;
-        memset(entered_code, 0, sizeof(entered_code));
-        access_control_mode = false;
+        case ACCESS_END:
+            hal_gpio_put(LED_RED, 0);
+            hal_gpio_put(LED_GREEN, 0);
+            // Reinicia a entrada para nova tentativa
+            code_index = 0;
+            memset(entered_code, 0, sizeof(entered_code));
+            access_control_mode = false;
+            access_log_append(&access_record);
+            flow_end();
+            break;
     }
 }
 
@@ -229,93 +497,548 @@ void access_control(void) {
     // Exibe a mensagem de obtenção de senha e ativa o modo de entrada
     display_message("OBTENDO", "SENHA", "");
     printf("\nDigite a senha:\n");
-    code_index = 0;
-    memset(entered_code, 0, sizeof(entered_code));
     access_control_mode = true;
-    busy_wait_ms(2000);
+    memset(&access_record, 0, sizeof(access_record));
+    access_record.type = LOG_EVENT_ACCESS;
+    access_record.result = LOG_RESULT_DENIED;
+    access_record.user = LOG_USER_NONE;
+    access_decided = false;
+    access_start_us = hal_time_us_32();
+    code_begin(access_code_entered);
 }
 
+/*===============================*/
+/* Travamento do Sistema         */
+/*===============================*/
 
-/*================================*/
-/* Funções de Teste e Diagnóstico */
-/*================================*/
+enum {
+    LOCK_READ,
+    LOCK_END
+};
+
+static void lock_step(void *ctx);
+void lock_system(void);
+
+static void lock_code_entered(const char *code) {
+    // Digitação abandonada: o sistema continua travado aguardando nova senha
+    if (code == NULL) {
+        code_begin(lock_code_entered);
+        return;
+    }
+    // Só um administrador destrava o sistema
+    cred_user_t user;
+    uint32_t start = hal_time_us_32();
+    bool known = credentials_verify(code, &user);
+    access_log_record_t r = {.type = LOG_EVENT_UNLOCK, .result = LOG_RESULT_DENIED, .user = known ? user.id : LOG_USER_NONE};
+    r.check_us = (uint16_t)(hal_time_us_32() - start);
+    if (known && user.role == CRED_ROLE_ADMIN) {
+        r.result = LOG_RESULT_OK;
+        access_log_append(&r);
+        hal_gpio_put(LED_RED, 0);
+        bloq_system = false;
+        display_message("SISTEMA", "", "DESTRAVADO");
+        printf("Sistema destravado.\n");
+        hal_gpio_put(LED_GREEN, 1);
+        flow_next(lock_step, LOCK_END, 1000);
+    } else {
+        access_log_append(&r);
+        lock_system();
+    }
+}
+
+static void lock_step(void *ctx) {
+    switch (flow_state) {
+        case LOCK_READ:
+            code_begin(lock_code_entered);
+            break;
+        case LOCK_END:
+            hal_gpio_put(LED_GREEN, 0);
+            flow_end();
+            break;
+    }
+}
+
+void lock_system(void) {
+    if (!bloq_system) {
+        // Travado, o sistema só espera a senha: grava antes de começar a espera
+        access_log_record_t r = {.type = LOG_EVENT_LOCK, .result = LOG_RESULT_OK};
+        access_log_append(&r);
+        access_log_flush();
+    }
+    bloq_system = true;
+    display_message("SISTEMA", "", "TRAVADO");
+    printf("Sistema travado pelo usuário.\n");
+    hal_gpio_put(LED_RED, 1);
+    flow_next(lock_step, LOCK_READ, 500);
+}
+
+/*===============================*/
+/* Console                       */
+/*===============================*/
+
+static const char *role_name(uint8_t role) {
+    return role == CRED_ROLE_ADMIN ? "admin" : "user";
+}
 
 /**
- * @brief Inicia modo de teste do sistema
+ * @brief Comando "cred": lista, cadastra e revoga senhas
+ * @note Inclusão e revogação exigem a senha de um administrador
  */
+static void cred_command(uint8_t source, int argc, char **argv) {
+    if (argc == 2 && strcmp(argv[1], "list") == 0) {
+        cred_user_t user;
+        console_printf(source, "%u senhas:\n", credentials_count());
+        for (uint16_t i = 0; credentials_get(i, &user); i++) {
+            console_printf(source, "  id %u %s\n", user.id, role_name(user.role));
+        }
+        return;
+    }
 
-void buzzer_test(void) {
-    gpio_put(LED_RED, 1);
-    printf("\nIniciando teste dos buzzers...\n");
-    display_message("TESTANDO", "BUZZERS", "");
+    bool add = argc == 5 && strcmp(argv[1], "add") == 0;
+    bool revoke = argc == 4 && strcmp(argv[1], "revoke") == 0;
+    if (!add && !revoke) {
+        console_printf(source, "Uso: cred list | cred add <senha admin> user|admin <senha> | cred revoke <senha admin> <id>\n");
+        return;
+    }
 
-    printf("\nTestando buzzer 1 para som de erro...\n");
-    play_error(BUZZER1_PIN);
-    busy_wait_ms(1000);
-    
-    printf("\nTestando buzzer 2 para som de sucesso...\n");
-    play_success(BUZZER2_PIN);
-    busy_wait_ms(1000);
+    cred_user_t admin;
+    if (!credentials_verify(argv[2], &admin) || admin.role != CRED_ROLE_ADMIN) {
+        console_printf(source, "Senha de administrador incorreta\n");
+        return;
+    }
 
-    // Simula erro se o botão do joystick for pressionado
-    if (gpio_get(JOYSTICK_BTN) == 0) {
-        display_message("ERRO", "NOS", "BUZZERS");
-        printf("\nErro: Falha no buzzer detectada!\n");
-        buzzer_fault = true;
-        busy_wait_ms(2000);
+    cred_status_t status;
+    if (add) {
+        uint16_t id = 0;
+        uint8_t role = strcmp(argv[3], "admin") == 0 ? CRED_ROLE_ADMIN : CRED_ROLE_USER;
+        if (strcmp(argv[3], role_name(role)) != 0 || strlen(argv[4]) != CODE_LENGTH) {
+            status = CRED_ERR_INVALID;
+        } else {
+            status = credentials_add(argv[4], role, &id);
+        }
+        if (status == CRED_OK) {
+            access_log_record_t r = {.type = LOG_EVENT_CRED_ADD, .result = LOG_RESULT_OK, .user = id, .flags = role};
+            access_log_append(&r);
+            console_printf(source, "Senha cadastrada: id %u %s\n", id, role_name(role));
+            return;
+        }
+    } else {
+        status = credentials_revoke((uint16_t)atoi(argv[3]));
+        if (status == CRED_OK) {
+            access_log_record_t r = {.type = LOG_EVENT_CRED_REVOKE, .result = LOG_RESULT_OK, .user = (uint16_t)atoi(argv[3])};
+            access_log_append(&r);
+            console_printf(source, "Senha %s revogada\n", argv[3]);
+            return;
+        }
     }
+    console_printf(source, "Erro: %s\n", credentials_status_text(status));
 }
 
-void process_keypad_test(void) {
-    // Exibe a mensagem de teste apenas uma vez
-    gpio_put(LED_BLUE, 1);
-    printf("\nIniciando teste do teclado...\n");
-    display_message("TESTANDO", "TECLADO", "");
-    busy_wait_ms(2000);
+// Envio do registro de eventos em andamento (comando "log dump")
+static bool log_dumping = false;
+static uint8_t log_dump_source;
+static uint32_t log_dump_next, log_dump_end;
 
-    // Se o botão B for pressionado, encerra o teste
-    if (gpio_get(BUTTON_B) == 0) {
-        printf("Teste encerrado pelo botão B.\n");
-        display_message("TESTE", "ENCERRADO", "");
+/**
+ * @brief Comando "log": estatísticas e envio do registro de eventos
+ * @note O envio é feito aos poucos por log_task, uma linha "L <base64>" por
+ *       registro, entre "LOG BEGIN <n>" e "LOG END"
+ */
+static void log_command(uint8_t source, int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "stats") == 0) {
+        access_log_stats_t st;
+        access_log_get_stats(&st);
+        console_printf(source, "Registros: %lu na flash, %lu pendentes; setor %u; %lu setores apagados; %lu gravacoes forcadas\n",
+                       (unsigned long)st.stored, (unsigned long)st.staged, st.head_sector,
+                       (unsigned long)st.erases, (unsigned long)st.forced);
         return;
     }
-    // Se o botão do joystick for pressionado, simula falha
-    if (gpio_get(JOYSTICK_BTN) == 0) {
-        keypad_fault = true;
+    if (argc >= 2 && strcmp(argv[1], "dump") == 0 && !log_dumping) {
+        // Pendentes vão para a flash antes: o envio lê só da flash
+        access_log_flush();
+        uint32_t count = access_log_count();
+        uint32_t last = argc >= 3 ? strtoul(argv[2], NULL, 10) : count;
+        log_dump_end = count;
+        log_dump_next = last < count ? count - last : 0;
+        log_dump_source = source;
+        log_dumping = true;
+        console_printf(source, "LOG BEGIN %lu\n", (unsigned long)(log_dump_end - log_dump_next));
+        return;
     }
-    busy_wait_ms(3000);
+    console_printf(source, "Uso: log stats | log dump [ultimos n]\n");
 }
 
-void test_microfone(void) {
-    gpio_put(LED_GREEN, 1); 
-    printf("\nIniciando teste do microfone...\n");
-    display_message("TESTANDO", "MICROFONE", "");
-    busy_wait_ms(3000);
-    
-    // Realiza 5 leituras com intervalo de 500ms entre elas
-    for (int i = 0; i < 5; i++) {
-        uint16_t mic_val = microphone_read();
-        printf("Valor ADC do microfone: %d\n", mic_val);
-        
-        if (mic_val > SOUND_THRESHOLD) {
-            // Se o valor lido exceder o limiar, assume que um som foi detectado
-            display_message("SOM", "DETECTADO", "");
+/**
+ * @brief Comando "iris": galeria de modelos e cadastro da próxima leitura
+ */
+static void iris_command(uint8_t source, int argc, char **argv) {
+    if (argc == 3 && strcmp(argv[1], "enroll") == 0) {
+        cred_user_t admin;
+        if (!credentials_verify(argv[2], &admin) || admin.role != CRED_ROLE_ADMIN) {
+            console_printf(source, "Senha de administrador incorreta\n");
+            return;
+        }
+        iris_enroll_next();
+        console_printf(source, "Proxima leitura de iris sera cadastrada\n");
+        return;
+    }
+    if (argc == 1) {
+        console_printf(source, "Galeria de iris: %u modelos\n", iris_gallery_size());
+        return;
+    }
+    console_printf(source, "Uso: iris | iris enroll <senha admin>\n");
+}
+
+/**
+ * @brief Comando "voice": modelos de voz, cadastro da próxima frase e remoção
+ * @note Os modelos são gravados na flash pelo log_task, com o menu ocioso
+ */
+static void voice_command(uint8_t source, int argc, char **argv) {
+    if (argc == 3 && (strcmp(argv[1], "enroll") == 0 || strcmp(argv[1], "clear") == 0)) {
+        cred_user_t admin;
+        if (!credentials_verify(argv[2], &admin) || admin.role != CRED_ROLE_ADMIN) {
+            console_printf(source, "Senha de administrador incorreta\n");
+            return;
+        }
+        if (argv[1][0] == 'c') {
+            voice_store.count = 0;
+            voice_enroll_armed = false;
+            voice_store_dirty = true;
+            console_printf(source, "Modelos de voz removidos\n");
+        } else if (voice_store.count == VOICEPRINT_MAX_TEMPLATES) {
+            console_printf(source, "Modelos de voz cheios (use voice clear)\n");
         } else {
-            // Caso contrário, indica que nenhum som foi detectado
-            display_message("SOM", "NAO", "DETECTADO");
+            voice_enroll_armed = true;
+            console_printf(source, "Proxima frase sera cadastrada\n");
         }
-        
-        busy_wait_ms(500);
+        return;
     }
-    
-    display_message("TESTE DO", "MICROFONE", "FINALIZADO");
-    busy_wait_ms(1000);
-    gpio_put(LED_BLUE, 0);
-    gpio_put(LED_RED, 0);
-    gpio_put(LED_GREEN, 0); 
+    if (argc == 1) {
+        console_printf(source, "Voz: %u de %u modelos\n", voice_store.count, VOICEPRINT_MAX_TEMPLATES);
+        return;
+    }
+    console_printf(source, "Uso: voice | voice enroll <senha admin> | voice clear <senha admin>\n");
+}
+
+/**
+ * @brief Envia parte do registro pedido pelo console e grava os registros
+ *        pendentes e os modelos de voz alterados quando nenhum fluxo está
+ *        em andamento
+ * @note Tarefa periódica; a gravação pausa a CPU e fica fora dos fluxos de acesso
+ */
+static void log_task(void *ctx) {
+    if (log_dumping) {
+        access_log_record_t r;
+        char line[ACCESS_LOG_LINE_SIZE];
+        for (int i = 0; i < LOG_DUMP_PER_TICK && log_dump_next < log_dump_end; i++) {
+            if (access_log_read(log_dump_next++, &r)) {
+                access_log_encode(&r, line);
+                console_printf(log_dump_source, "L %s\n", line);
+            }
+        }
+        if (log_dump_next >= log_dump_end) {
+            console_printf(log_dump_source, "LOG END\n");
+            log_dumping = false;
+        }
+        return;
+    }
+    if (!flow_active) {
+        if (voice_store_dirty) {
+            voice_store_save(&voice_store);
+            voice_store_dirty = false;
+        }
+        access_log_flush();
+    }
+}
+
+// Envio do histograma do perfilador em andamento (comando "prof dump")
+static uint8_t prof_dump_source;
+static uint32_t prof_dump_next;
+
+// Envia algumas posições do histograma por passo, no ritmo do envio do registro
+static void prof_dump_step(void *ctx) {
+    uint32_t sent = 0;
+    uintptr_t pc;
+    uint32_t count;
+    while (sent < PROF_DUMP_PER_TICK && prof_dump_next < PROFILER_SLOTS) {
+        if (profiler_entry(prof_dump_next++, &pc, &count)) {
+            console_printf(prof_dump_source, "P %lx %lu\n", (unsigned long)pc, (unsigned long)count);
+            sent++;
+        }
+    }
+    if (prof_dump_next < PROFILER_SLOTS) {
+        sched_post(prof_dump_step, NULL, LOG_TASK_MS);
+    } else {
+        console_printf(prof_dump_source, "PROF END\n");
+    }
+}
+
+/**
+ * @brief Comando "prof": liga, desliga e envia o perfilador por amostragem
+ * @note O envio desliga a amostragem e sai aos poucos, uma linha "P <pc> <amostras>"
+ *       por endereço, entre "PROF BEGIN <endereços> <amostras> <perdidas> <período us>
+ *       <âncora>" e "PROF END"; host/profile_report associa os endereços às funções
+ */
+static void prof_command(uint8_t source, int argc, char **argv) {
+    profiler_stats_t st;
+    if (argc >= 2 && strcmp(argv[1], "start") == 0) {
+        uint32_t period = argc >= 3 ? strtoul(argv[2], NULL, 10) : PROFILER_DEFAULT_US;
+        if (!profiler_start(period)) {
+            console_printf(source, "Perfilador ja ligado ou sem temporizador livre\n");
+            return;
+        }
+        profiler_get_stats(&st);
+        console_printf(source, "Perfilador ligado: uma amostra a cada %lu us\n", (unsigned long)st.period_us);
+        return;
+    }
+    if (argc == 2 && strcmp(argv[1], "stop") == 0) {
+        profiler_stop();
+    } else if (argc == 2 && strcmp(argv[1], "dump") == 0 && !sched_pending(prof_dump_step, NULL)) {
+        profiler_stop();
+        profiler_get_stats(&st);
+        console_printf(source, "PROF BEGIN %lu %lu %lu %lu %lx\n", (unsigned long)st.addresses,
+                       (unsigned long)st.samples, (unsigned long)st.lost, (unsigned long)st.period_us,
+                       (unsigned long)profiler_anchor());
+        prof_dump_source = source;
+        prof_dump_next = 0;
+        sched_post(prof_dump_step, NULL, 0);
+        return;
+    } else if (argc != 1) {
+        console_printf(source, "Uso: prof | prof start [periodo us] | prof stop | prof dump\n");
+        return;
+    }
+    profiler_get_stats(&st);
+    console_printf(source, "Perfilador %s: %lu amostras (%lu perdidas), %lu enderecos\n",
+                   st.running ? "ligado" : "desligado", (unsigned long)st.samples,
+                   (unsigned long)st.lost, (unsigned long)st.addresses);
+}
+
+// Medição em andamento (comando "bench"): um caso por passo do escalonador.
+// Enquanto ela durar, o display é só dos casos: a navegação do menu e o
+// botão A são descartados, como durante os fluxos
+static bool bench_running;
+static uint8_t bench_source;
+static uint32_t bench_next;
+
+static uint64_t bench_clock_ns(void) {
+    return hal_time_us_64() * 1000u;
+}
+
+static void bench_step(void *ctx) {
+    const bench_case_t *c = &bench_cases[bench_next++];
+    bench_result_t r;
+    bench_measure(c, bench_clock_ns, BENCH_MIN_US * 1000ull, BENCH_MAX_ITERATIONS, &r);
+    // Décimos de ns e de ciclo por operação, sem printf de ponto flutuante
+    uint64_t ns10 = r.elapsed_ns * 10 / r.iterations;
+    uint64_t cycles10 = r.elapsed_ns * (hal_clock_sys_hz() / 1000000u) / 100 / r.iterations;
+    console_printf(bench_source, "B %-22s %8lu.%lu ns/op %8lu.%lu ciclos/op %8lu\n", c->name,
+                   (unsigned long)(ns10 / 10), (unsigned long)(ns10 % 10),
+                   (unsigned long)(cycles10 / 10), (unsigned long)(cycles10 % 10), (unsigned long)r.iterations);
+    if (bench_next < bench_case_count) {
+        sched_post(bench_step, NULL, LOG_TASK_MS);
+    } else {
+        bench_running = false;
+        draw_menu();
+        console_printf(bench_source, "BENCH END\n");
+    }
+}
+
+/**
+ * @brief Comando "bench": micro-benchmarks de src/bench.c na placa
+ * @note Um caso por vez, cada um repetido por ao menos BENCH_MIN_US; os casos
+ *       desenham no display, que volta ao menu no fim. O primeiro caso espera
+ *       um período para o núcleo 1 terminar o último desenho do menu
+ */
+static void bench_command(uint8_t source, int argc, char **argv) {
+    if (argc != 1 || bench_running) {
+        console_printf(source, "Uso: bench (sem medicao em andamento)\n");
+        return;
+    }
+    console_printf(source, "BENCH BEGIN %lu casos, clk_sys %lu Hz\n", (unsigned long)bench_case_count,
+                   (unsigned long)hal_clock_sys_hz());
+    bench_running = true;
+    bench_source = source;
+    bench_next = 0;
+    sched_post(bench_step, NULL, MENU_TASK_MS);
+}
+
+/*================================*/
+/* Funções de Teste e Diagnóstico */
+/*================================*/
+
+enum {
+    TEST_KEYPAD_CHECK,
+    TEST_KEYPAD_RESULT,
+    TEST_BUZZER,
+    TEST_BUZZER2,
+    TEST_BUZZER_CHECK,
+    TEST_MIC,
+    TEST_MIC_READ,
+    TEST_MIC_DONE,
+    TEST_IRIS
+};
+
+static void test_step(void *ctx);
+
+// Teste do teclado: teclas vistas na janela de pressionamento
+static bool keypad_test_active = false;
+static char keypad_test_keys[KEYPAD_KEYS + 1];
+static uint32_t keypad_test_last_press;
+static bool keypad_test_ghost;
+static uint32_t keypad_test_ghosts;     // Leituras ambíguas antes da janela
+
+static void test_iris_done(bool ok) {
+    flow_end();
+}
+
+/**
+ * @brief Registra uma tecla pressionada durante o teste do teclado
+ * @note Duas teclas na mesma leitura, com uma por vez sendo pressionada,
+ *       indicam curto entre linhas ou colunas (tecla fantasma)
+ */
+static void keypad_test_record(const event_t *ev) {
+    size_t len = strlen(keypad_test_keys);
+    if (len > 0 && ev->timestamp_us == keypad_test_last_press) {
+        keypad_test_ghost = true;
+    }
+    keypad_test_last_press = ev->timestamp_us;
+    if (strchr(keypad_test_keys, (char)ev->source) == NULL && len < KEYPAD_KEYS) {
+        keypad_test_keys[len] = (char)ev->source;
+        keypad_test_keys[len + 1] = '\0';
+    }
+}
+
+/**
+ * @brief Inicia modo de teste do sistema: teclado, buzzers, microfone e íris
+ */
+void process_keypad_test(void) {
+    // Exibe a mensagem de teste apenas uma vez
+    hal_gpio_put(LED_BLUE, 1);
+    printf("\nIniciando teste do teclado...\n");
+    display_message("TESTANDO", "TECLADO", "NAO TOQUE");
+    flow_next(test_step, TEST_KEYPAD_CHECK, 2000);
+}
+
+static void test_step(void *ctx) {
+    switch (flow_state) {
+        case TEST_KEYPAD_CHECK:
+            // Se o botão B for pressionado, encerra o teste
+            if (hal_gpio_get(BUTTON_B) == 0) {
+                printf("Teste encerrado pelo botão B.\n");
+                display_message("TESTE", "ENCERRADO", "");
+                flow_next(test_step, TEST_BUZZER, 0);
+                break;
+            }
+            // Em repouso, qualquer contato fechado é tecla presa
+            if (keypad_state() != 0 || keypad_ambiguous()) {
+                char keys[KEYPAD_KEYS + 1];
+                keypad_format(keypad_state(), keys, sizeof(keys));
+                printf("Erro: tecla presa no teclado: %s\n", keys);
+                display_message("TECLA", "PRESA", keys);
+                keypad_fault = true;
+                flow_next(test_step, TEST_BUZZER, 3000);
+                break;
+            }
+            keypad_stats_t kp;
+            keypad_get_stats(&kp);
+            keypad_test_ghosts = kp.ghosts;
+            keypad_test_keys[0] = '\0';
+            keypad_test_ghost = false;
+            keypad_test_active = true;
+            printf("Pressione as teclas, uma de cada vez...\n");
+            display_message("PRESSIONE AS", "TECLAS, UMA", "DE CADA VEZ");
+            flow_next(test_step, TEST_KEYPAD_RESULT, KEYPAD_TEST_MS);
+            break;
+        case TEST_KEYPAD_RESULT: {
+            keypad_test_active = false;
+            keypad_stats_t kp;
+            keypad_get_stats(&kp);
+            printf("Teclas lidas: %s\n", keypad_test_keys[0] ? keypad_test_keys : "nenhuma");
+            if (keypad_test_ghost || kp.ghosts != keypad_test_ghosts) {
+                printf("Erro: tecla fantasma no teclado!\n");
+                display_message("TECLA", "FANTASMA", "");
+                keypad_fault = true;
+                flow_next(test_step, TEST_BUZZER, 3000);
+            } else {
+                display_message("TECLADO OK", keypad_test_keys, "");
+                flow_next(test_step, TEST_BUZZER, 1000);
+            }
+            break;
+        }
+        case TEST_BUZZER:
+            hal_gpio_put(LED_RED, 1);
+            printf("\nIniciando teste dos buzzers...\n");
+            display_message("TESTANDO", "BUZZERS", "");
+            printf("\nTestando buzzer 1 para som de erro...\n");
+            flow_next(test_step, TEST_BUZZER2, play_error(BUZZER1_PIN) + 1000);
+            break;
+        case TEST_BUZZER2:
+            printf("\nTestando buzzer 2 para som de sucesso...\n");
+            flow_next(test_step, TEST_BUZZER_CHECK, play_success(BUZZER2_PIN) + 1000);
+            break;
+        case TEST_BUZZER_CHECK:
+            // Simula erro se o botão do joystick for pressionado
+            if (hal_gpio_get(JOYSTICK_BTN) == 0) {
+                display_message("ERRO", "NOS", "BUZZERS");
+                printf("\nErro: Falha no buzzer detectada!\n");
+                buzzer_fault = true;
+                flow_next(test_step, TEST_MIC, 2000);
+            } else {
+                flow_next(test_step, TEST_MIC, 0);
+            }
+            break;
+        case TEST_MIC:
+            hal_gpio_put(LED_GREEN, 1);
+            printf("\nIniciando teste do microfone...\n");
+            display_message("TESTANDO", "MICROFONE", "");
+            microphone_listen_start();
+            flow_next(test_step, TEST_MIC_READ, MIC_TEST_MS);
+            break;
+        case TEST_MIC_READ: {
+            // Relata o piso calibrado e a relação sinal-ruído do som mais alto da janela
+            microphone_listen_stop();
+            int32_t snr = noise_floor_snr_db10(&mic_noise, mic_peak_rms);
+            int32_t snr_abs = snr < 0 ? -snr : snr;
+            printf("Piso de ruído: %u (sigma %u), limiar %u\n", noise_floor_level(&mic_noise),
+                   noise_floor_sigma(&mic_noise), noise_floor_threshold(&mic_noise));
+            printf("RMS máximo: %u, SNR %s%ld.%ld dB\n", mic_peak_rms, snr < 0 ? "-" : "",
+                   (long)(snr_abs / 10), (long)(snr_abs % 10));
+
+            char floor_line[UI_LINE_MAX + 1];
+            char snr_line[UI_LINE_MAX + 1];
+            snprintf(floor_line, sizeof(floor_line), "RUIDO %u", noise_floor_level(&mic_noise));
+            snprintf(snr_line, sizeof(snr_line), "SNR %d DB", (int16_t)(snr / 10));
+            display_message(mic_onset ? "SOM DETECTADO" : "SEM SOM", floor_line, snr_line);
+            flow_next(test_step, TEST_MIC_DONE, 3000);
+            break;
+        }
+        case TEST_MIC_DONE:
+            display_message("TESTE DO", "MICROFONE", "FINALIZADO");
+            flow_next(test_step, TEST_IRIS, 1000);
+            break;
+        case TEST_IRIS:
+            hal_gpio_put(LED_BLUE, 0);
+            hal_gpio_put(LED_RED, 0);
+            hal_gpio_put(LED_GREEN, 0);
+            iris_scan_test(JOYSTICK_BTN, test_iris_done);
+            break;
+    }
+}
+
+static void fault_step(void *ctx) {
+    hal_gpio_put(LED_GREEN, 0);
+    flow_end();
 }
 
 void system_fault(void) {  
+    access_log_record_t r = {.type = LOG_EVENT_FAULT, .result = LOG_RESULT_OK};
+    r.flags = (keypad_fault ? LOG_FAULT_KEYPAD : 0) | (buzzer_fault ? LOG_FAULT_BUZZER : 0) |
+              (get_scan_problem() ? LOG_FAULT_IRIS : 0);
+    if (r.flags != 0) {
+        r.result = LOG_RESULT_DENIED;
+    }
+    access_log_append(&r);
+
     if (keypad_fault) {
         printf("Erro: Problema no teclado detectado!\n");
         display_message("ERRO", "FALHA NO", "TECLADO");
@@ -329,101 +1052,134 @@ void system_fault(void) {
         display_message("ERRO", "NO LEITOR", "DE IRIS");
     }
     if (keypad_fault || buzzer_fault || get_scan_problem()) {
+        // O fluxo nunca termina: o menu fica bloqueado até reiniciar a placa
+        // e o registro de eventos precisa ir para a flash agora
+        access_log_flush();
         printf("Sistema travado devido a falha.\n");
         display_message("SISTEMA", "COM PROBLEMAS", "REINICIE");
-        while (1) {
-            gpio_put(LED_RED, 1);
-            busy_wait_ms(1000);
-            gpio_put(LED_RED, 0);
-        }
+        hal_gpio_put(LED_RED, 1);
+        return;
     }
     display_message("SISTEMA", "", "OK");
-    gpio_put(LED_GREEN, 1);
+    hal_gpio_put(LED_GREEN, 1);
     printf("Sistema OK.\n");
-    busy_wait_ms(1000);
-    gpio_put(LED_GREEN, 0);
+    sched_post(fault_step, NULL, 1000);
 }
 
-/*=========================*/
-/* Funções do ADC/Joystick */
-/*=========================*/
+/*===========================*/
+/* Callbacks e Ações do Menu */
+/*===========================*/
 
 /**
- * @brief Lê valor atual de um canal do ADC
- * @param adc_channel Canal ADC a ser lido (0-3)
- * @return Valor lido do ADC (12-bit)
+ * @brief Aplica os eventos de navegação do joystick e redesenha o menu se mudou
+ * @note Tarefa periódica; eventos gerados durante um fluxo são descartados
  */
-uint16_t read_adc(uint adc_channel) {
-    adc_select_input(adc_channel);
-    busy_wait_ms(5);
-    return adc_read();
+static void menu_task(void *ctx) {
+    event_t ev;
+    bool changed = false;
+    while (event_queue_pop(&nav_events, &ev)) {
+        if (flow_active || bench_running || (int32_t)(ev.timestamp_us - flow_end_time) < 0) {
+            continue;
+        }
+        changed |= update_menu_selection(&ev);
+    }
+    if (changed) {
+        draw_menu();
+    }
 }
 
-int joystick_get_direction() {
-    uint16_t adc_y = read_adc(0);
-    if (adc_y < (ADC_CENTER - ADC_THRESHOLD))
-        return 1;
-    else if (adc_y > (ADC_CENTER + ADC_THRESHOLD))
-        return -1;
-    else
-        return 0;
+#if LOOP_LATENCY_STATS
+/**
+ * @brief Relata a latência do laço do núcleo 0 nos últimos 5 s
+ * @note O maior trecho ocupado é o pior atraso para atender uma entrada
+ */
+static void latency_task(void *ctx) {
+    sched_stats_t st;
+    sched_get_stats(&st, true);
+    printf("[laco] max %lu us, medio %lu us em %lu passagens\n",
+           (unsigned long)st.max_busy_us,
+           (unsigned long)(st.passes ? st.total_busy_us / st.passes : 0),
+           (unsigned long)st.passes);
 }
+#endif
 
-/*===========================*/
-/* Callbacks e Ações do Menu */
-/*===========================*/
+/**
+ * @brief Registra os botões no debouncer, que enfileira seus eventos
+ */
+static void init_button_events(void) {
+    static const debounce_config_t button_config = {
+        .long_press_ms = BUTTON_LONG_PRESS_MS,
+    };
+    event_queue_init(&input_events);
+    debouncer_init(&input_events);
+    debouncer_add(BUTTON_A, true, &button_config);
+    debouncer_add(BUTTON_B, true, &button_config);
+    debouncer_add(JOYSTICK_BTN, true, &button_config);
+}
 
 /**
- * @brief Callback para eventos GPIO (botões e joystick)
- * @param gpio Pino que gerou o evento
- * @param events Tipo de evento detectado
- */
-void gpio_callback(uint gpio, uint32_t events) {
-    if (gpio == BUTTON_A) {
-        if (check_debounce(&last_interrupt_time_A, DEBOUNCE_TIME)) {
-            if (!action_executed) {
-                action_executed = true;
-                execute_menu_action(get_selected_menu());
-                draw_menu();
-                action_executed = false;
-            }
+ * @brief Consome os eventos de botões enfileirados pelo debouncer
+ * @note Pressionamentos do botão A feitos durante um fluxo são descartados e
+ *       vários pressionamentos pendentes resultam em uma única ação
+ */
+void process_input_events(void) {
+    event_t ev;
+    bool run_action = false;
+
+    while (event_queue_pop(&input_events, &ev)) {
+        if (ev.source == BUTTON_A && ev.type == EVENT_PRESS && !flow_active && !bench_running &&
+            (int32_t)(ev.timestamp_us - flow_end_time) >= 0) {
+            run_action = true;
         }
     }
-    if (gpio == BUTTON_B) {
-        if (check_debounce(&last_interrupt_time_B, DEBOUNCE_TIME)) {
-        }
+
+    if (run_action) {
+        flow_active = true;
+        execute_menu_action(get_selected_menu());
     }
-    if (gpio == JOYSTICK_BTN) {
-        if (check_debounce(&last_interrupt_time_JOYSTICK, DEBOUNCE_TIME)) {
+}
+
+/**
+ * @brief Consome as teclas do teclado matricial
+ * @note Durante uma digitação de senha as teclas seguem para o fluxo de
+ *       entrada e, no teste do teclado, são só registradas; fora disso são
+ *       descartadas
+ */
+void process_keypad_events(void) {
+    event_t ev;
+    while (event_queue_pop(&keypad_events, &ev)) {
+        if (ev.type != EVENT_PRESS) {
+            continue;
+        }
+        if (keypad_test_active) {
+            keypad_test_record(&ev);
+        } else if (code_done != NULL) {
+            input_stream_put(INPUT_SRC_KEYPAD, (char)ev.source);
         }
     }
 }
 
 /**
- * @brief Executa ação correspondente ao item do menu selecionado
+ * @brief Inicia o fluxo correspondente ao item do menu selecionado
  * @param menu_index Índice do item de menu selecionado
+ * @note Retorna imediatamente; o fluxo avança pelo escalonador
  */
 void execute_menu_action(uint8_t menu_index) {
     switch (menu_index) {
         case 0:
             process_keypad_test();
-            buzzer_test();
-            test_microfone();
-            iris_scan_test(pio, sm, JOYSTICK_BTN);
-            draw_menu();
             break;
         case 1:
             access_control();
-            draw_menu();
             break;
         case 2:
             lock_system();
-            draw_menu();
             break;
         case 3:
             system_fault();
             break;
         default:
+            flow_end();
             break;
     }
 }
@@ -437,84 +1193,60 @@ void execute_menu_action(uint8_t menu_index) {
  * @note Gerencia todos os subsistemas e fluxo principal da aplicação
  */
 int main(void) {
-    stdio_init_all();
+    hal_stdio_init();
     init_buttons();
     uart_init_function();
-    busy_wait_ms(2000);  // Aguarda conexão USB
-    microphone_init();
-    microphone_read();
+    input_stream_init(UART_ID);
+    init_credentials();
+    console_register("cred", "list | add <senha admin> user|admin <senha> | revoke <senha admin> <id>", cred_command);
+    access_log_init();
+    console_register("log", "stats | dump [ultimos n]", log_command);
+    console_register("iris", "[enroll <senha admin>]", iris_command);
+    printf("%u modelos de voz cadastrados\n", voice_store_load(&voice_store));
+    console_register("voice", "[enroll <senha admin> | clear <senha admin>]", voice_command);
+    console_register("prof", "[start [periodo us] | stop | dump]", prof_command);
+    console_register("bench", "", bench_command);
+    hal_busy_wait_ms(2000);  // Aguarda conexão USB
+    init_adc_system();
     init_matrix(pio, sm);
+    event_queue_init(&keypad_events);
+    keypad_init(KEYPAD_PIO, KEYPAD_SM, &keypad_events);
     init_display();
+    ui_init();              // A partir daqui o display e a matriz são do núcleo 1
     Led_init(LED_RED);
     Led_init(LED_GREEN);
     Led_init(LED_BLUE);
-    init_adc_system();
-    gpio_set_function(BUZZER1_PIN, GPIO_FUNC_PWM);
-    gpio_set_function(BUZZER2_PIN, GPIO_FUNC_PWM);
+    melody_init(BUZZER1_PIN);
+    melody_init(BUZZER2_PIN);
     
-    gpio_set_irq_enabled_with_callback(BUTTON_A, GPIO_IRQ_EDGE_FALL, true, gpio_callback);
-    gpio_set_irq_enabled_with_callback(BUTTON_B, GPIO_IRQ_EDGE_FALL, true, gpio_callback);
-    gpio_set_irq_enabled_with_callback(JOYSTICK_BTN, GPIO_IRQ_EDGE_FALL, true, gpio_callback);
+    init_button_events();
     
-    // Loop principal: se não estivermos no modo de entrada de senha, atualiza o menu;
-    // caso contrário, processa a entrada da senha (leitura via UART/USB)
-// Loop principal
+    // Loop principal: trata os eventos dos botões e deixa o escalonador
+    // executar a montagem da senha (5 ms), o registro de eventos (5 ms), o
+    // joystick (10 ms), o microfone (16 ms), o menu (20 ms) e os passos dos
+    // fluxos; sched_run() retorna a cada interrupção
+    sched_init();
+    microphone_init();
+    event_queue_init(&nav_events);
+    joystick_init(&nav_events);
+    sched_every(input_task, NULL, 5);
+    sched_every(menu_task, NULL, MENU_TASK_MS);
+    sched_every(log_task, NULL, LOG_TASK_MS);
+#if LOOP_LATENCY_STATS
+    sched_every(latency_task, NULL, 5000);
+#endif
+#if TRACE_ENABLED
+    // Registros dos pontos de rastreamento saem pela UART, intercalados com o texto
+    trace_init(UART_ID);
+    sched_every(trace_drain, NULL, TRACE_DRAIN_MS);
+#endif
     draw_menu();
 
     while (true) {
-        int dir = joystick_get_direction();
-        update_menu_selection(dir);
-        char unlock_code[5];  // Buffer para armazenar o código recebido (4 caracteres + null terminator)
-        int code_index = 0;   // Índice para controle da digitação do código
-        
-        if (bloq_system) {
-            display_message("SISTEMA", "", "TRAVADO");
-            printf("Sistema travado pelo usuário.\n");
-            gpio_put(LED_RED, 1);
-            busy_wait_ms(500);
-        
-            code_index = 0;
-            memset(unlock_code, 0, sizeof(unlock_code)); // Zera o buffer antes da leitura
-        
-            while (code_index < 4) {  // Continua lendo até completar 4 dígitos
-                // Tenta ler da USB
-                int c_usb = getchar_timeout_us(0);
-                if (c_usb != PICO_ERROR_TIMEOUT && c_usb >= '0' && c_usb <= '9') {
-                    unlock_code[code_index++] = (char)c_usb;
-                    printf("*"); // Exibe um '*' para cada dígito
-                }
-        
-                // Tenta ler da UART
-                if (uart_is_readable(UART_ID)) {
-                    char c = uart_getc(UART_ID);
-                    if (c >= '0' && c <= '9') {
-                        unlock_code[code_index++] = c;
-                        uart_putc(UART_ID, '*'); // Exibe '*' na UART
-                    }
-                }
-            }
-        
-            unlock_code[4] = '\0'; // Garante que a string termine corretamente
-        
-            // Verifica se o código digitado é "0000"
-            if (strcmp(unlock_code, "0000") == 0) {
-                gpio_put(LED_RED, 0);
-                bloq_system = false;
-                display_message("SISTEMA", "", "DESTRAVADO");
-                printf("Sistema destravado.\n");
-                gpio_put(LED_GREEN, 1);
-                busy_wait_ms(1000);
-                gpio_put(LED_GREEN, 0);
-            }
-            draw_menu();
-        }
-        if (access_control_mode) {
-            process_access_control();
-            draw_menu();
-        }
-        draw_menu();
-        busy_wait_ms(75);
+        process_input_events();
+        process_keypad_events();
+        sched_run();
     }
 
 return 0;
-}
\ No newline at end of file
+}
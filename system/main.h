@@ -2,23 +2,45 @@
 #define MAIN
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "src/hardwareFiles/buttons.h"
 #include "src/debouncer.h"
-#include "hardware/uart.h"
-#include "hardware/i2c.h"
-#include "hardware/clocks.h"
-#include "hardware/adc.h"
-#include "hardware/pwm.h"
-#include "hardware/gpio.h"
-#include "pico/stdlib.h"
+#include "src/hal/hal.h"
 #include "src/hardwareFiles/Led_Matrix.h"
 #include "src/display.h"
 #include "src/menu.h"
+#include "src/scheduler.h"
+#include "src/event_queue.h"
+#include "src/ui.h"
+#include "src/melody.h"
+#include "src/adc_sampler.h"
+#include "src/audio_features.h"
+#include "src/voiceprint.h"
+#include "src/noise_floor.h"
+#include "src/joystick.h"
+#include "src/input_stream.h"
+#include "src/keypad.h"
+#include "src/credentials.h"
+#include "src/console.h"
+#include "src/access_log.h"
+#include "src/verify_pipeline.h"
+#include "src/trace.h"
+#include "src/profiler.h"
+#include "src/bench.h"
+#include "src/voice_store.h"
 
 // --- Definições de acesso ---
-#define VALID_CODE "1234"
 #define CODE_LENGTH 4
+#define DEFAULT_USER_CODE  "1234"   // Cadastradas só se a flash não tiver senhas
+#define DEFAULT_ADMIN_CODE "0000"
+#define CODE_TIMEOUT_MS 15000   // Prazo sem dígitos durante a digitação da senha
+
+// Fatores que decidem o acesso: a falha de um deles nega na hora, sem esperar
+// os demais; fatores fora da lista são verificados e só registrados
+#ifndef ACCESS_REQUIRED_FACTORS
+#define ACCESS_REQUIRED_FACTORS (LOG_FACTOR_CODE | LOG_FACTOR_VOICE | LOG_FACTOR_IRIS)
+#endif
 
 // --- Definições dos LEDs RGB ---
 #define LED_GREEN  11    // componente verde
@@ -28,21 +50,40 @@
 // --- Definições dos pinos ---
 #define BUZZER1_PIN 10
 #define BUZZER2_PIN 21
-#define UART_ID uart0
+#define UART_ID 0
 #define BAUD_RATE 250000
+#define UART_TX_PIN 0
+#define UART_RX_PIN 1
 
 // --- Outras definições ---
-#define ADC_CENTER     2048
-#define ADC_THRESHOLD  512   // Limiar para detectar movimento do joystick
-#define SOUND_THRESHOLD 1925  // Limiar para detecção de som
+#define MENU_TASK_MS   20    // Período de consumo dos eventos de navegação
+#define LOG_TASK_MS    5     // Gravação do registro de eventos e envio pelo console
+#define LOG_DUMP_PER_TICK 2  // Registros enviados por período (~19 bytes/ms, abaixo da UART)
+#define PROF_DUMP_PER_TICK 4  // Endereços do perfilador enviados por período (~16 bytes/ms)
+#define BENCH_MIN_US   20000 // Duração mínima de cada caso do comando "bench"
 
-#define JOYSTICK_ADC_X 26    // ADC canal 0: eixo X
-#define JOYSTICK_ADC_Y 27    // ADC canal 1: eixo Y
+// Reconhecimento de voz: um quadro (32 ms) conta como fala se estiver acima do
+// piso de ruído adaptativo, com taxa de passagens por zero típica de voz e
+// energia concentrada abaixo de 1 kHz
+#define MIC_TASK_MS        16    // Período da extração de características
+#define MIC_VOICE_ZCR_MIN  3     // ~50 Hz
+#define MIC_VOICE_ZCR_MAX  80    // ~1250 Hz
+#define MIC_VOICE_FRAMES   6     // Quadros com fala para aceitar a voz (~200 ms)
+#define MIC_LISTEN_MS      1500  // Janela para falar a frase (cabe em VOICEPRINT_MAX_FRAMES)
+#define MIC_TEST_MS        5000  // Janela do teste do microfone
 
 #define MATRIX_WS2812_PIN 7  // Pino de controle da matriz 5x5
+#define KEYPAD_PIO HAL_PIO1  // Varredura do teclado (fora do bloco da matriz de LEDs)
+#define KEYPAD_SM 0
+#define KEYPAD_TEST_MS 5000  // Janela para pressionar as teclas no teste
 #define MIC_PIN 28           // Microfone (ADC canal 2)
-#define DEBOUNCE_TIME 300000 // Tempo de debounce (em microsegundos)
-#define DUTY_CYCLE 49152
+#define BUTTON_LONG_PRESS_MS 1000 // Pressão longa dos botões
+#define BUZZER_DUTY 50       // Ciclo de trabalho das notas dos buzzers (%)
+
+// 1: imprime a cada 5 s a latência máxima e média do laço principal
+#ifndef LOOP_LATENCY_STATS
+#define LOOP_LATENCY_STATS 0
+#endif
 
 
 
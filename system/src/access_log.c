@@ -0,0 +1,254 @@
+#include "src/access_log.h"
+#include "src/crc32.h"
+
+#include <string.h>
+
+/*
+ * Registro de eventos de acesso em flash, só de acréscimo.
+ *
+ * Os registros de 32 bytes ocupam um anel de setores após os modelos de
+ * voz. A gravação avança sempre para a frente; ao passar para o próximo
+ * setor ele é apagado, descartando os registros mais antigos. Cada setor é
+ * apagado uma vez por volta do anel, de modo que o desgaste se distribui
+ * igualmente por toda a região.
+ *
+ * access_log_append() só copia o registro para a RAM. A gravação, que pausa
+ * a CPU por ~1 ms por página e ~45 ms por setor apagado, acontece em
+ * access_log_flush(), chamada quando nenhum fluxo está em andamento; os
+ * registros pendentes de uma mesma página vão juntos em uma única gravação.
+ * Uma página parcialmente preenchida é regravada depois com os registros
+ * seguintes: as posições já gravadas recebem 0xFF, que não altera a flash.
+ *
+ * Na inicialização o setor mais recente é o de maior número de sequência no
+ * primeiro registro, e a próxima posição livre é a seguinte ao último
+ * registro não apagado dele.
+ */
+
+#define LOG_SLOTS      (ACCESS_LOG_SECTORS * ACCESS_LOG_PER_SECTOR)
+#define LOG_SEQ_ERASED 0xFFFFFFFFu
+
+_Static_assert(ACCESS_LOG_SECTORS >= 2, "O anel precisa de pelo menos dois setores");
+
+static access_log_record_t staged[ACCESS_LOG_STAGED];
+static uint8_t staged_count;
+static uint8_t head_sector;         // Setor em gravação
+static uint16_t head_slot;          // Próxima posição livre no setor
+static uint32_t stored;             // Posições ocupadas, da mais antiga até head
+static uint32_t next_seq;
+static uint8_t boot;
+static uint32_t erases;
+static uint32_t forced;
+
+static uint32_t slot_offset(uint32_t slot) {
+    return ACCESS_LOG_FLASH_OFFSET + slot * ACCESS_LOG_RECORD_SIZE;
+}
+
+static const access_log_record_t *slot_record(uint32_t slot) {
+    return (const access_log_record_t *)hal_flash_data(slot_offset(slot));
+}
+
+static uint16_t record_check(const access_log_record_t *r) {
+    return (uint16_t)crc32_update(0, r, offsetof(access_log_record_t, check));
+}
+
+/**
+ * @brief Indica se um registro está completo (gravação não interrompida)
+ */
+bool access_log_record_valid(const access_log_record_t *record) {
+    return record->seq != LOG_SEQ_ERASED && record->check == record_check(record);
+}
+
+static bool sector_erased(uint8_t sector) {
+    const uint32_t *words = (const uint32_t *)hal_flash_data(slot_offset(sector * ACCESS_LOG_PER_SECTOR));
+    for (uint32_t i = 0; i < HAL_FLASH_SECTOR_SIZE / sizeof(uint32_t); i++) {
+        if (words[i] != 0xFFFFFFFFu) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void sector_erase(uint8_t sector) {
+    hal_flash_erase(slot_offset(sector * ACCESS_LOG_PER_SECTOR), HAL_FLASH_SECTOR_SIZE);
+    erases++;
+}
+
+// Registros que cabem sem contar o setor que será apagado pela próxima volta
+static void clamp_stored(void) {
+    uint32_t max = (ACCESS_LOG_SECTORS - 1) * ACCESS_LOG_PER_SECTOR + head_slot;
+    if (stored > max) {
+        stored = max;
+    }
+}
+
+/**
+ * @brief Localiza o fim do registro na flash e grava o evento de inicialização
+ */
+void access_log_init(void) {
+    staged_count = 0;
+    erases = 0;
+    forced = 0;
+
+    // Setor mais recente: maior sequência no primeiro registro
+    bool found = false;
+    uint32_t newest = 0;
+    for (uint8_t s = 0; s < ACCESS_LOG_SECTORS; s++) {
+        const access_log_record_t *first = slot_record(s * ACCESS_LOG_PER_SECTOR);
+        if (access_log_record_valid(first) && (!found || (int32_t)(first->seq - newest) > 0)) {
+            found = true;
+            newest = first->seq;
+            head_sector = s;
+        }
+    }
+
+    if (!found) {
+        head_sector = 0;
+        head_slot = 0;
+        stored = 0;
+        next_seq = 0;
+        boot = 0;
+        if (!sector_erased(0)) {
+            sector_erase(0);
+        }
+    } else {
+        uint32_t base = head_sector * ACCESS_LOG_PER_SECTOR;
+        head_slot = ACCESS_LOG_PER_SECTOR;
+        while (head_slot > 0 && slot_record(base + head_slot - 1)->seq == LOG_SEQ_ERASED) {
+            head_slot--;
+        }
+        // Último registro válido define a sequência e a inicialização seguintes
+        next_seq = newest + 1;
+        boot = 0;
+        for (uint16_t i = 0; i < head_slot; i++) {
+            const access_log_record_t *r = slot_record(base + i);
+            if (access_log_record_valid(r)) {
+                next_seq = r->seq + 1;
+                boot = r->boot + 1;
+            }
+        }
+
+        // O mais antigo é o primeiro setor válido depois do atual
+        stored = head_slot;
+        for (uint8_t i = 1; i < ACCESS_LOG_SECTORS; i++) {
+            uint8_t s = (head_sector + i) % ACCESS_LOG_SECTORS;
+            if (access_log_record_valid(slot_record(s * ACCESS_LOG_PER_SECTOR))) {
+                stored += (uint32_t)(ACCESS_LOG_SECTORS - i) * ACCESS_LOG_PER_SECTOR;
+                break;
+            }
+        }
+        clamp_stored();
+    }
+
+    access_log_record_t r = {.type = LOG_EVENT_BOOT, .result = LOG_RESULT_OK};
+    access_log_append(&r);
+}
+
+/**
+ * @brief Grava na flash os registros pendentes, uma página por vez
+ * @note Pausa a CPU (e o núcleo 1) durante a gravação: chamar fora dos fluxos
+ */
+void access_log_flush(void) {
+    uint8_t done = 0;
+    while (done < staged_count) {
+        if (head_slot == ACCESS_LOG_PER_SECTOR) {
+            head_sector = (head_sector + 1) % ACCESS_LOG_SECTORS;
+            head_slot = 0;
+            sector_erase(head_sector);
+            clamp_stored();
+        }
+
+        // Página da posição atual com todos os registros pendentes que couberem
+        uint8_t page[HAL_FLASH_PAGE_SIZE];
+        memset(page, 0xFF, sizeof(page));
+        uint16_t first = head_slot - head_slot % ACCESS_LOG_PER_PAGE;
+        do {
+            memcpy(&page[(head_slot - first) * ACCESS_LOG_RECORD_SIZE], &staged[done++], ACCESS_LOG_RECORD_SIZE);
+            head_slot++;
+            stored++;
+        } while (done < staged_count && head_slot % ACCESS_LOG_PER_PAGE != 0);
+
+        hal_flash_program(slot_offset(head_sector * ACCESS_LOG_PER_SECTOR + first), page, sizeof(page));
+        clamp_stored();
+    }
+    staged_count = 0;
+}
+
+/**
+ * @brief Acrescenta um registro; sequência, instante, inicialização e
+ *        verificação são preenchidos aqui
+ * @note Só copia para a RAM. Com ACCESS_LOG_STAGED registros pendentes a
+ *       gravação é feita na hora, mesmo durante um fluxo.
+ */
+void access_log_append(const access_log_record_t *record) {
+    if (staged_count == ACCESS_LOG_STAGED) {
+        forced++;
+        access_log_flush();
+    }
+
+    access_log_record_t *r = &staged[staged_count++];
+    *r = *record;
+    r->seq = next_seq++;
+    if (r->seq == LOG_SEQ_ERASED) {
+        r->seq = next_seq++;
+    }
+    r->time_ms = hal_time_ms();
+    r->boot = boot;
+    r->check = record_check(r);
+}
+
+/**
+ * @brief Posições do registro na flash, da mais antiga à mais recente
+ * @note Inclui registros interrompidos, que access_log_read não entrega
+ */
+uint32_t access_log_count(void) {
+    return stored;
+}
+
+/**
+ * @brief Lê o registro index (0 = mais antigo) da flash
+ * @return false se a posição não existir ou não tiver registro válido
+ */
+bool access_log_read(uint32_t index, access_log_record_t *record) {
+    if (index >= stored) {
+        return false;
+    }
+    uint32_t head = head_sector * ACCESS_LOG_PER_SECTOR + head_slot;
+    uint32_t slot = (head + LOG_SLOTS - stored + index) % LOG_SLOTS;
+    memcpy(record, slot_record(slot), sizeof(*record));
+    return access_log_record_valid(record);
+}
+
+void access_log_get_stats(access_log_stats_t *stats) {
+    stats->stored = stored;
+    stats->staged = staged_count;
+    stats->forced = forced;
+    stats->erases = erases;
+    stats->next_seq = next_seq;
+    stats->head_sector = head_sector;
+}
+
+/**
+ * @brief Codifica um registro em base64 para envio pelo console
+ * @return Tamanho do texto (sem o terminador)
+ * @note Decodificado no computador por host/access_log_decode
+ */
+size_t access_log_encode(const access_log_record_t *record, char dst[ACCESS_LOG_LINE_SIZE]) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const uint8_t *p = (const uint8_t *)record;
+    size_t n = 0;
+    for (size_t i = 0; i < ACCESS_LOG_RECORD_SIZE; i += 3) {
+        uint32_t v = (uint32_t)p[i] << 16;
+        if (i + 1 < ACCESS_LOG_RECORD_SIZE) {
+            v |= (uint32_t)p[i + 1] << 8;
+        }
+        if (i + 2 < ACCESS_LOG_RECORD_SIZE) {
+            v |= p[i + 2];
+        }
+        dst[n++] = alphabet[(v >> 18) & 63];
+        dst[n++] = alphabet[(v >> 12) & 63];
+        dst[n++] = i + 1 < ACCESS_LOG_RECORD_SIZE ? alphabet[(v >> 6) & 63] : '=';
+        dst[n++] = i + 2 < ACCESS_LOG_RECORD_SIZE ? alphabet[v & 63] : '=';
+    }
+    dst[n] = '\0';
+    return n;
+}
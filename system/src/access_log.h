@@ -0,0 +1,84 @@
+#ifndef ACCESS_LOG_H
+#define ACCESS_LOG_H
+
+#include "src/hal/hal.h"
+#include "src/voice_store.h"
+
+// Região da flash de dados logo após os modelos de voz, até o fim
+#define ACCESS_LOG_FLASH_OFFSET (VOICE_FLASH_OFFSET + VOICE_FLASH_SIZE)
+#define ACCESS_LOG_SECTORS      ((HAL_FLASH_DATA_SIZE - ACCESS_LOG_FLASH_OFFSET) / HAL_FLASH_SECTOR_SIZE)
+
+#define ACCESS_LOG_RECORD_SIZE 32
+#define ACCESS_LOG_PER_PAGE    (HAL_FLASH_PAGE_SIZE / ACCESS_LOG_RECORD_SIZE)
+#define ACCESS_LOG_PER_SECTOR  (HAL_FLASH_SECTOR_SIZE / ACCESS_LOG_RECORD_SIZE)
+#define ACCESS_LOG_STAGED      (2 * ACCESS_LOG_PER_PAGE)   // Registros aguardando gravação na RAM
+#define ACCESS_LOG_LINE_SIZE   (4 * ((ACCESS_LOG_RECORD_SIZE + 2) / 3) + 1)   // Registro em base64
+
+// Tipos de registro
+#define LOG_EVENT_BOOT        1
+#define LOG_EVENT_ACCESS      2     // Tentativa de acesso (senha, voz e íris)
+#define LOG_EVENT_LOCK        3
+#define LOG_EVENT_UNLOCK      4     // Tentativa de destravar
+#define LOG_EVENT_FAULT       5     // Diagnóstico do menu; flags = LOG_FAULT_*
+#define LOG_EVENT_CRED_ADD    6     // user = senha cadastrada
+#define LOG_EVENT_CRED_REVOKE 7     // user = senha revogada
+
+// Resultados
+#define LOG_RESULT_OK      0
+#define LOG_RESULT_DENIED  1
+#define LOG_RESULT_TIMEOUT 2
+
+// flags de LOG_EVENT_ACCESS: fatores aprovados
+#define LOG_FACTOR_CODE  0x01
+#define LOG_FACTOR_VOICE 0x02
+#define LOG_FACTOR_IRIS  0x04
+
+// flags de LOG_EVENT_FAULT
+#define LOG_FAULT_KEYPAD 0x01
+#define LOG_FAULT_BUZZER 0x02
+#define LOG_FAULT_IRIS   0x04
+
+// Etapas medidas em stage_us (voz e íris podem se sobrepor)
+#define LOG_STAGE_ENTRY 0           // Digitação da senha
+#define LOG_STAGE_VOICE 1           // Captura e comparação da voz
+#define LOG_STAGE_IRIS  2
+#define LOG_STAGES      3
+
+#define LOG_USER_NONE 0             // Nenhuma senha reconhecida
+
+typedef struct {
+    uint32_t seq;                   // Número de sequência global; 0xFFFFFFFF = posição apagada
+    uint32_t time_ms;               // Instante desde a inicialização
+    uint8_t type;                   // LOG_EVENT_*
+    uint8_t result;                 // LOG_RESULT_*
+    uint16_t user;                  // Identificador da senha (cred_user_t.id)
+    uint32_t stage_us[LOG_STAGES];  // Duração das etapas; 0 = etapa não executada
+    uint16_t check_us;              // Verificação da senha
+    uint16_t decision_ms;           // Da senha digitada à decisão (LOG_EVENT_ACCESS)
+    uint8_t flags;
+    uint8_t boot;                   // Contador de inicializações (módulo 256)
+    uint16_t check;                 // 16 bits baixos do CRC-32 dos campos anteriores
+} access_log_record_t;
+
+_Static_assert(sizeof(access_log_record_t) == ACCESS_LOG_RECORD_SIZE, "Registro com tamanho inesperado");
+
+typedef struct {
+    uint32_t stored;                // Posições ocupadas na flash
+    uint32_t staged;                // Registros na RAM aguardando gravação
+    uint32_t forced;                // Gravações feitas na hora por RAM cheia
+    uint32_t erases;                // Setores apagados desde a inicialização
+    uint32_t next_seq;
+    uint8_t head_sector;            // Setor em gravação
+} access_log_stats_t;
+
+// Prototipação das funções do registro de eventos
+void access_log_init(void);
+void access_log_append(const access_log_record_t *record);
+void access_log_flush(void);
+uint32_t access_log_count(void);
+bool access_log_read(uint32_t index, access_log_record_t *record);
+void access_log_get_stats(access_log_stats_t *stats);
+bool access_log_record_valid(const access_log_record_t *record);
+size_t access_log_encode(const access_log_record_t *record, char dst[ACCESS_LOG_LINE_SIZE]);
+
+#endif // ACCESS_LOG_H
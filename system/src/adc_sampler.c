@@ -0,0 +1,122 @@
+#include "src/adc_sampler.h"
+
+/*
+ * Amostrador contínuo do ADC.
+ *
+ * O ADC converte em modo livre, em rodízio pelos canais 0, 1, 2 e 4, e o DMA
+ * grava cada resultado num anel entrelaçado (canal 0, 1, 2, 4, 0, 1, ...).
+ * A amostra k do canal na posição s do rodízio fica no índice
+ * k * ADC_SAMPLER_CHANNELS + s. As leituras nunca esperam pelo hardware:
+ * apenas consultam a posição de escrita do DMA e copiam do anel.
+ */
+
+#define ADC_RING_LEN  (ADC_SAMPLER_CHANNELS * ADC_SAMPLER_DEPTH)
+#define ADC_RING_MASK (ADC_RING_LEN - 1)
+
+static uint16_t adc_ring[ADC_RING_LEN] __attribute__((aligned(ADC_RING_LEN * sizeof(uint16_t))));
+static int adc_stream = -1;
+
+// Posição do canal no rodízio
+static uint adc_slot(uint channel) {
+    return channel == ADC_CH_TEMP ? 3 : channel;
+}
+
+// Índice no anel da amostra mais recente do canal, recuando back amostras
+static size_t adc_index(uint channel, size_t back) {
+    size_t last = hal_adc_stream_position(adc_stream) - 1;
+    size_t newest = last - ((last - adc_slot(channel)) & (ADC_SAMPLER_CHANNELS - 1));
+    return (newest - back * ADC_SAMPLER_CHANNELS) & ADC_RING_MASK;
+}
+
+/**
+ * @brief Configura os pinos analógicos e inicia a conversão contínua
+ * @note Aguarda um anel completo para que as leituras já tenham histórico
+ */
+void adc_sampler_init(void) {
+    hal_adc_init();
+    hal_adc_gpio_init(26);
+    hal_adc_gpio_init(27);
+    hal_adc_gpio_init(28);
+    adc_stream = hal_adc_stream_start((1u << ADC_CH_JOY_X) | (1u << ADC_CH_JOY_Y) |
+                                      (1u << ADC_CH_MIC) | (1u << ADC_CH_TEMP),
+                                      ADC_SAMPLER_RATE_HZ, adc_ring, ADC_RING_LEN);
+    hal_busy_wait_us(ADC_SAMPLER_DEPTH * 1000000ull / ADC_SAMPLER_RATE_HZ);
+}
+
+/**
+ * @brief Última conversão do canal
+ */
+uint16_t adc_sampler_latest(uint channel) {
+    return adc_ring[adc_index(channel, 0)];
+}
+
+/**
+ * @brief Média das últimas count amostras do canal (filtro de decimação)
+ * @param count Limitado a ADC_SAMPLER_DEPTH
+ */
+uint16_t adc_sampler_average(uint channel, size_t count) {
+    if (count == 0) {
+        return adc_sampler_latest(channel);
+    }
+    if (count > ADC_SAMPLER_DEPTH) {
+        count = ADC_SAMPLER_DEPTH;
+    }
+    size_t index = adc_index(channel, count - 1);
+    uint32_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        sum += adc_ring[index];
+        index = (index + ADC_SAMPLER_CHANNELS) & ADC_RING_MASK;
+    }
+    return (uint16_t)((sum + count / 2) / count);
+}
+
+/**
+ * @brief Copia as últimas count amostras do canal, da mais antiga à mais recente
+ * @return Número de amostras copiadas (limitado a ADC_SAMPLER_DEPTH)
+ * @note As amostras mais antigas do anel podem ser sobrescritas durante a
+ *       cópia; pedir menos que a profundidade total deixa margem para isso
+ */
+size_t adc_sampler_block(uint channel, uint16_t *dst, size_t count) {
+    if (count > ADC_SAMPLER_DEPTH) {
+        count = ADC_SAMPLER_DEPTH;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    size_t index = adc_index(channel, count - 1);
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = adc_ring[index];
+        index = (index + ADC_SAMPLER_CHANNELS) & ADC_RING_MASK;
+    }
+    return count;
+}
+
+/**
+ * @brief Posição da próxima amostra do canal, para leituras incrementais
+ */
+uint32_t adc_sampler_cursor(uint channel) {
+    return (uint32_t)(adc_index(channel, 0) / ADC_SAMPLER_CHANNELS + 1) & (ADC_SAMPLER_DEPTH - 1);
+}
+
+/**
+ * @brief Copia as amostras do canal chegadas desde cursor e avança o cursor
+ * @param cursor Obtido de adc_sampler_cursor() e mantido pelo consumidor
+ * @return Número de amostras copiadas (no máximo max)
+ * @note O consumidor deve ler antes que ADC_SAMPLER_DEPTH amostras novas
+ *       se acumulem; caso contrário as mais antigas já foram sobrescritas
+ */
+size_t adc_sampler_read(uint channel, uint32_t *cursor, uint16_t *dst, size_t max) {
+    uint32_t next = adc_sampler_cursor(channel);
+    size_t count = (next - *cursor) & (ADC_SAMPLER_DEPTH - 1);
+    if (count > max) {
+        count = max;
+    }
+    uint32_t k = *cursor;
+    uint slot = adc_slot(channel);
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = adc_ring[k * ADC_SAMPLER_CHANNELS + slot];
+        k = (k + 1) & (ADC_SAMPLER_DEPTH - 1);
+    }
+    *cursor = k;
+    return count;
+}
@@ -0,0 +1,25 @@
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include "src/hal/hal.h"
+
+// Canais amostrados em rodízio (o sensor de temperatura completa 4 canais,
+// o que mantém o entrelaçamento alinhado ao anel de tamanho potência de 2)
+#define ADC_CH_JOY_Y   0     // GPIO 26 (eixo vertical, usado na navegação do menu)
+#define ADC_CH_JOY_X   1     // GPIO 27
+#define ADC_CH_MIC     2     // GPIO 28
+#define ADC_CH_TEMP    4     // Sensor interno
+#define ADC_SAMPLER_CHANNELS 4
+
+#define ADC_SAMPLER_RATE_HZ 8000   // Amostras por segundo em cada canal
+#define ADC_SAMPLER_DEPTH   1024   // Amostras guardadas por canal (128 ms)
+
+// Prototipação das funções do amostrador
+void adc_sampler_init(void);
+uint16_t adc_sampler_latest(uint channel);
+uint16_t adc_sampler_average(uint channel, size_t count);
+size_t adc_sampler_block(uint channel, uint16_t *dst, size_t count);
+uint32_t adc_sampler_cursor(uint channel);
+size_t adc_sampler_read(uint channel, uint32_t *cursor, uint16_t *dst, size_t max);
+
+#endif // ADC_SAMPLER_H
@@ -0,0 +1,130 @@
+#include "src/audio_features.h"
+
+/*
+ * Extração de características de áudio em fluxo, só com aritmética inteira.
+ *
+ * Cada amostra passa por um removedor de DC (média móvel exponencial em Q8)
+ * e alimenta, na mesma passada, a soma dos quadrados (RMS), o contador de
+ * passagens por zero com histerese e AUDIO_BANDS filtros de Goertzel. Ao
+ * completar AUDIO_FRAME_SAMPLES amostras o quadro é fechado e os acumuladores
+ * reiniciam; o custo por amostra é constante e nada é armazenado além do
+ * estado, de modo que o extrator pode ser alimentado aos pedaços por uma
+ * tarefa periódica.
+ */
+
+// 2·cos(2πk/N) em Q14 para os bins k = 8, 16, 32 e 64 com N = 256
+static const int32_t goertzel_coef_q14[AUDIO_BANDS] = {32138, 30274, 23170, 0};
+static const uint16_t goertzel_bin[AUDIO_BANDS] = {8, 16, 32, 64};
+
+/**
+ * @brief Raiz quadrada inteira, arredondada para baixo
+ * @note Usada também pelo piso de ruído (noise_floor.c) sobre a variância
+ */
+uint32_t audio_isqrt(uint64_t x) {
+    uint64_t root = 0;
+    uint64_t bit = 1ull << 62;
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+static uint16_t clamp_u16(uint32_t v) {
+    return v > UINT16_MAX ? UINT16_MAX : (uint16_t)v;
+}
+
+static void audio_frame_reset(audio_features_t *af) {
+    af->count = 0;
+    af->zcr = 0;
+    af->sum = 0;
+    af->energy = 0;
+    for (int b = 0; b < AUDIO_BANDS; b++) {
+        af->s1[b] = 0;
+        af->s2[b] = 0;
+    }
+}
+
+/**
+ * @brief Prepara o extrator para um novo fluxo de amostras
+ */
+void audio_features_init(audio_features_t *af) {
+    af->dc_q8 = 0;
+    af->primed = false;
+    af->sign = 0;
+    audio_frame_reset(af);
+}
+
+/**
+ * @brief Frequência central da banda, em Hz
+ */
+uint16_t audio_band_hz(uint band) {
+    if (band >= AUDIO_BANDS) {
+        return 0;
+    }
+    return (uint16_t)((uint32_t)goertzel_bin[band] * AUDIO_SAMPLE_RATE_HZ / AUDIO_FRAME_SAMPLES);
+}
+
+/**
+ * @brief Processa uma amostra do ADC (12-bit)
+ * @param out Recebe o vetor de características quando o quadro se completa
+ * @return true se um quadro foi fechado nesta amostra
+ */
+bool audio_features_push(audio_features_t *af, uint16_t sample, audio_frame_t *out) {
+    int32_t x_q8 = (int32_t)sample << 8;
+    if (!af->primed) {
+        // Parte do primeiro valor para não gerar um degrau no início do fluxo
+        af->dc_q8 = x_q8;
+        af->primed = true;
+    }
+    af->dc_q8 += (x_q8 - af->dc_q8) >> AUDIO_DC_SHIFT;
+    int32_t x = (x_q8 - af->dc_q8) >> 8;
+
+    af->sum += sample;
+    af->energy += (uint64_t)((int64_t)x * x);
+
+    // Passagem por zero só conta depois de cruzar a faixa de histerese
+    if (x > AUDIO_ZCR_HYST) {
+        if (af->sign < 0) {
+            af->zcr++;
+        }
+        af->sign = 1;
+    } else if (x < -AUDIO_ZCR_HYST) {
+        if (af->sign > 0) {
+            af->zcr++;
+        }
+        af->sign = -1;
+    }
+
+    for (int b = 0; b < AUDIO_BANDS; b++) {
+        int32_t s = x + (int32_t)(((int64_t)goertzel_coef_q14[b] * af->s1[b]) >> 14) - af->s2[b];
+        af->s2[b] = af->s1[b];
+        af->s1[b] = s;
+    }
+
+    if (++af->count < AUDIO_FRAME_SAMPLES) {
+        return false;
+    }
+
+    out->rms = clamp_u16(audio_isqrt(af->energy / AUDIO_FRAME_SAMPLES));
+    out->zcr = af->zcr;
+    for (int b = 0; b < AUDIO_BANDS; b++) {
+        int64_t s1 = af->s1[b];
+        int64_t s2 = af->s2[b];
+        int64_t power = s1 * s1 + s2 * s2 - ((goertzel_coef_q14[b] * s1) >> 14) * s2;
+        // |X(k)| = A·N/2 para uma senoide de amplitude A no bin
+        out->band[b] = clamp_u16(audio_isqrt(power > 0 ? (uint64_t)power : 0) / (AUDIO_FRAME_SAMPLES / 2));
+    }
+    out->dc = (uint16_t)(af->sum / AUDIO_FRAME_SAMPLES);
+
+    audio_frame_reset(af);
+    return true;
+}
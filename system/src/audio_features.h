@@ -0,0 +1,43 @@
+#ifndef AUDIO_FEATURES_H
+#define AUDIO_FEATURES_H
+
+#include "src/hal/hal.h"
+
+// Quadro de análise: 256 amostras a 8 kHz (32 ms)
+#define AUDIO_SAMPLE_RATE_HZ 8000
+#define AUDIO_FRAME_SAMPLES  256
+
+// Bandas de Goertzel: 250, 500, 1000 e 2000 Hz (bins 8, 16, 32 e 64 do quadro)
+#define AUDIO_BANDS 4
+
+#define AUDIO_DC_SHIFT  6       // Constante de tempo do removedor de DC (2^6 amostras)
+#define AUDIO_ZCR_HYST  8       // Histerese das passagens por zero (contagens do ADC)
+
+// Vetor de características de um quadro
+typedef struct {
+    uint16_t rms;                   // RMS sem DC, em contagens do ADC
+    uint16_t zcr;                   // Passagens por zero no quadro
+    uint16_t band[AUDIO_BANDS];     // Amplitude estimada em cada banda (contagens do ADC)
+    uint16_t dc;                    // Nível médio do sinal no quadro
+} audio_frame_t;
+
+// Estado incremental do extrator (inteiro, sem alocação)
+typedef struct {
+    int32_t dc_q8;                  // Média móvel do sinal em Q8
+    bool primed;                    // dc_q8 já foi inicializado
+    int8_t sign;                    // Último lado do zero (+1/-1, 0 = indefinido)
+    uint16_t count;                 // Amostras acumuladas no quadro atual
+    uint16_t zcr;
+    uint32_t sum;                   // Soma das amostras brutas
+    uint64_t energy;                // Soma dos quadrados do sinal sem DC
+    int32_t s1[AUDIO_BANDS];        // Estados dos filtros de Goertzel
+    int32_t s2[AUDIO_BANDS];
+} audio_features_t;
+
+// Prototipação das funções do extrator
+void audio_features_init(audio_features_t *af);
+bool audio_features_push(audio_features_t *af, uint16_t sample, audio_frame_t *out);
+uint16_t audio_band_hz(uint band);
+uint32_t audio_isqrt(uint64_t x);
+
+#endif // AUDIO_FEATURES_H
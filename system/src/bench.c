@@ -0,0 +1,139 @@
+#include "src/bench.h"
+#include "src/display.h"
+#include "src/menu.h"
+#include "src/debouncer.h"
+#include "src/input_stream.h"
+#include "src/hardwareFiles/Led_Matrix.h"
+
+/*
+ * Micro-benchmarks dos caminhos de desenho, de cor e de entrada.
+ *
+ * A mesma tabela de casos roda no host (host/micro_bench.c, em ns/op e
+ * alocações por operação) e na placa (comando "bench", em ns e ciclos por
+ * operação). Cada caso repete a operação n vezes; bench_measure dobra n até
+ * a repetição durar ao menos min_ns, o que dilui a resolução do relógio.
+ *
+ * Os casos usam o estado real dos módulos (display global, filas, anéis):
+ * - os desenhos repetem o mesmo conteúdo, então ssd1306_flush_async só
+ *   compara o quadro e não gera tráfego I2C depois da primeira vez;
+ * - display_message e draw_menu medem a entrega ao núcleo 1, que desenha em
+ *   paralelo (no host, quando a fila enche) e por isso vêm por último;
+ * - debouncer_poll e a digitação de senha bloqueiam as interrupções pelo
+ *   tempo de uma operação, já que disputam o estado com elas.
+ */
+
+static volatile uint32_t bench_sink;   // Impede que o compilador descarte resultados
+
+static void bench_ssd1306_fill(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        ssd1306_fill(&ssd, i & 1);
+    }
+}
+
+static void bench_ssd1306_draw_string(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        ssd1306_draw_string(&ssd, "ALPHA SEGURANCA", 5, 10);
+    }
+}
+
+static void bench_ssd1306_rect(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        ssd1306_rect(&ssd, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, 1, 0);
+    }
+}
+
+static void bench_display_draw_message(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        display_draw_message("Digite a senha", "no teclado", NULL);
+    }
+}
+
+static void bench_menu_draw(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        menu_draw(0);
+    }
+}
+
+static void bench_matrix_rgb(uint32_t n) {
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        acc ^= matrix_rgb((uint8_t)i, (uint8_t)(i >> 3), (uint8_t)(i >> 5));
+    }
+    bench_sink = acc;
+}
+
+static void bench_debouncer_poll(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t state = hal_irq_save();
+        debouncer_poll();
+        hal_irq_restore(state);
+    }
+}
+
+// Uma senha de 4 dígitos pelo teclado: início da leitura, dígitos e montagem da linha
+static void bench_input_line_poll(uint32_t n) {
+    char line[INPUT_LINE_MAX + 1];
+    uint8_t source;
+    uint32_t ready = 0;
+    input_line_echo(false);
+    for (uint32_t i = 0; i < n; i++) {
+        input_line_begin(4, 0);
+        uint32_t state = hal_irq_save();
+        input_stream_put(INPUT_SRC_KEYPAD, '1');
+        input_stream_put(INPUT_SRC_KEYPAD, '2');
+        input_stream_put(INPUT_SRC_KEYPAD, '3');
+        input_stream_put(INPUT_SRC_KEYPAD, '4');
+        hal_irq_restore(state);
+        ready += input_line_poll(line, &source) == INPUT_LINE_READY;
+    }
+    input_line_echo(true);
+    bench_sink = ready;
+}
+
+static void bench_display_message(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        display_message("Digite a senha", "no teclado", NULL);
+    }
+}
+
+static void bench_draw_menu(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        draw_menu();
+    }
+}
+
+const bench_case_t bench_cases[] = {
+    {"ssd1306_fill",         bench_ssd1306_fill},
+    {"ssd1306_draw_string",  bench_ssd1306_draw_string},
+    {"ssd1306_rect",         bench_ssd1306_rect},
+    {"display_draw_message", bench_display_draw_message},
+    {"menu_draw",            bench_menu_draw},
+    {"matrix_rgb",           bench_matrix_rgb},
+    {"debouncer_poll",       bench_debouncer_poll},
+    {"input_line_poll",      bench_input_line_poll},
+    {"display_message",      bench_display_message},
+    {"draw_menu",            bench_draw_menu},
+};
+
+const uint32_t bench_case_count = sizeof(bench_cases) / sizeof(bench_cases[0]);
+
+/**
+ * @brief Mede um caso, dobrando as repetições até durar ao menos min_ns
+ * @param max_iterations Encerra a calibração mesmo sem atingir min_ns
+ * @param result Repetições e duração da última rodada
+ */
+void bench_measure(const bench_case_t *c, bench_clock_t clock, uint64_t min_ns, uint32_t max_iterations,
+                   bench_result_t *result) {
+    uint32_t n = 1;
+    for (;;) {
+        uint64_t start = clock();
+        c->run(n);
+        uint64_t elapsed = clock() - start;
+        if (elapsed >= min_ns || n >= max_iterations) {
+            result->iterations = n;
+            result->elapsed_ns = elapsed;
+            return;
+        }
+        n = n > max_iterations / 2 ? max_iterations : n * 2;
+    }
+}
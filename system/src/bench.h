@@ -0,0 +1,31 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "src/hal/hal.h"
+
+// Limite de repetições do comando "bench": na placa nunca é atingido antes de
+// BENCH_MIN_US (cada operação leva vários ciclos); no simulador, onde o relógio
+// virtual quase não anda sem chamadas à HAL, é ele que encerra a calibração
+#define BENCH_MAX_ITERATIONS (1u << 20)
+
+// Relógio da medição, em ns: hal_time_us_64 na placa, relógio real no host
+typedef uint64_t (*bench_clock_t)(void);
+
+typedef struct {
+    const char *name;               // Nome da função medida (sem espaços)
+    void (*run)(uint32_t iterations);
+} bench_case_t;
+
+typedef struct {
+    uint32_t iterations;
+    uint64_t elapsed_ns;
+} bench_result_t;
+
+extern const bench_case_t bench_cases[];
+extern const uint32_t bench_case_count;
+
+// Prototipação das funções de medição
+void bench_measure(const bench_case_t *c, bench_clock_t clock, uint64_t min_ns, uint32_t max_iterations,
+                   bench_result_t *result);
+
+#endif // BENCH_H
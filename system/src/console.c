@@ -0,0 +1,122 @@
+#include "src/console.h"
+#include "src/input_stream.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Console de comandos pela USB e pela UART.
+ *
+ * Enquanto nenhum fluxo aguarda senha, console_poll() consome os anéis de
+ * entrada e monta uma linha por origem; ao fim de linha ela é quebrada em
+ * palavras e entregue ao comando registrado com o nome da primeira. As
+ * respostas voltam para a origem da linha. Nada é ecoado: os comandos podem
+ * levar senhas. Teclas do teclado matricial não formam comandos.
+ */
+
+typedef struct {
+    const char *name;
+    const char *usage;
+    console_handler_t handler;
+} console_command_t;
+
+typedef struct {
+    char text[CONSOLE_LINE_MAX + 1];
+    uint8_t len;
+    bool overflow;                  // Linha longa demais: descartada até o fim
+} console_line_t;
+
+static console_command_t commands[CONSOLE_MAX_COMMANDS];
+static uint8_t command_count;
+static console_line_t lines[INPUT_SOURCES];
+
+/**
+ * @brief Registra um comando
+ * @param usage Argumentos, mostrados pelo comando "help"
+ * @return false se a tabela de comandos estiver cheia
+ */
+bool console_register(const char *name, const char *usage, console_handler_t handler) {
+    if (command_count >= CONSOLE_MAX_COMMANDS) {
+        return false;
+    }
+    commands[command_count++] = (console_command_t){name, usage, handler};
+    return true;
+}
+
+/**
+ * @brief Escreve na origem de uma linha de comando
+ */
+void console_printf(uint8_t source, const char *fmt, ...) {
+    char buf[96];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    for (const char *c = buf; *c; c++) {
+        input_stream_echo(source, *c);
+    }
+}
+
+static void console_help(uint8_t source) {
+    console_printf(source, "Comandos:\n");
+    for (uint8_t i = 0; i < command_count; i++) {
+        console_printf(source, "  %s %s\n", commands[i].name, commands[i].usage);
+    }
+}
+
+static void console_execute(uint8_t source, char *text) {
+    char *argv[CONSOLE_MAX_ARGS];
+    int argc = 0;
+    for (char *word = strtok(text, " \t"); word != NULL && argc < CONSOLE_MAX_ARGS; word = strtok(NULL, " \t")) {
+        argv[argc++] = word;
+    }
+    if (argc == 0) {
+        return;
+    }
+    if (strcmp(argv[0], "help") == 0) {
+        console_help(source);
+        return;
+    }
+    for (uint8_t i = 0; i < command_count; i++) {
+        if (strcmp(argv[0], commands[i].name) == 0) {
+            commands[i].handler(source, argc, argv);
+            return;
+        }
+    }
+    console_printf(source, "Comando desconhecido: %s (help lista os comandos)\n", argv[0]);
+}
+
+/**
+ * @brief Consome os caracteres recebidos e executa as linhas completas
+ * @note Chamada pelo laço principal apenas com o menu ocioso;
+ *       durante a digitação de senha os caracteres vão para input_line_poll
+ */
+void console_poll(void) {
+    input_char_t in;
+    while (input_stream_read(&in)) {
+        if (in.source == INPUT_SRC_KEYPAD) {
+            continue;
+        }
+
+        console_line_t *l = &lines[in.source];
+        if (in.c == '\r' || in.c == '\n') {
+            if (l->overflow) {
+                console_printf(in.source, "Linha longa demais (max. %d)\n", CONSOLE_LINE_MAX);
+            } else {
+                l->text[l->len] = '\0';
+                console_execute(in.source, l->text);
+            }
+            l->len = 0;
+            l->overflow = false;
+        } else if (in.c == '\b' || in.c == 0x7F) {
+            if (l->len > 0) {
+                l->len--;
+            }
+        } else if (l->len < CONSOLE_LINE_MAX) {
+            l->text[l->len++] = in.c;
+        } else {
+            l->overflow = true;
+        }
+    }
+}
@@ -0,0 +1,19 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include "src/hal/hal.h"
+
+#define CONSOLE_LINE_MAX     64     // Maior linha de comando (sem o fim de linha)
+#define CONSOLE_MAX_ARGS     8
+#define CONSOLE_MAX_COMMANDS 8
+
+// Recebe a origem da linha (INPUT_SRC_USB ou INPUT_SRC_UART) e as palavras;
+// argv[0] é o nome do comando
+typedef void (*console_handler_t)(uint8_t source, int argc, char **argv);
+
+// Prototipação das funções do console serial
+bool console_register(const char *name, const char *usage, console_handler_t handler);
+void console_poll(void);
+void console_printf(uint8_t source, const char *fmt, ...);
+
+#endif // CONSOLE_H
@@ -0,0 +1,17 @@
+#include "src/crc32.h"
+
+/**
+ * @brief Acumula len bytes no CRC-32 (bit a bit, sem tabela)
+ * @note Encadeável: crc32_update(crc32_update(0, a, n), b, m) == CRC de a || b
+ */
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len) {
+    const uint8_t *p = data;
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1u));
+        }
+    }
+    return ~crc;
+}
@@ -0,0 +1,9 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include "src/hal/hal.h"
+
+// CRC-32 (IEEE 802.3); crc32_update(0, ...) inicia o cálculo
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len);
+
+#endif // CRC32_H
@@ -0,0 +1,307 @@
+#include "src/credentials.h"
+#include "src/crc32.h"
+
+#include <string.h>
+
+/*
+ * Cadastro de senhas com resumo salgado em flash.
+ *
+ * Cada senha é guardada como SHA-256(sal || senha), com um sal aleatório
+ * único do cadastro: verificar uma senha custa um único resumo, qualquer que
+ * seja o número de usuários. Na RAM os registros ficam ordenados pelo resumo,
+ * com os 32 primeiros bits copiados em uma tabela à parte; a verificação faz
+ * uma busca binária de passos fixos nessa tabela e compara o resumo completo
+ * em tempo constante. O tempo, portanto, não depende de quantos dígitos da
+ * senha digitada estão certos.
+ *
+ * A flash tem dois bancos; cada alteração grava o cadastro inteiro no banco
+ * que não está em uso, com número de sequência maior e CRC. Uma gravação
+ * interrompida deixa o banco anterior válido.
+ */
+
+#define CRED_MAGIC   0x44455243u   // "CRED"
+#define CRED_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t sequence;
+    uint16_t next_id;
+    uint16_t reserved;
+    uint8_t salt[CRED_SALT_SIZE];
+    uint32_t crc;                   // CRC-32 do cabeçalho (até aqui) e dos registros
+} cred_header_t;
+
+typedef struct {
+    uint16_t id;
+    uint8_t role;
+    uint8_t reserved;
+    uint8_t hash[SHA256_DIGEST_SIZE];
+} cred_record_t;
+
+_Static_assert(sizeof(cred_header_t) + CRED_MAX_USERS * sizeof(cred_record_t) <= CRED_BANK_SIZE,
+               "O cadastro não cabe em um banco");
+
+static cred_header_t header;
+static cred_record_t records[CRED_MAX_USERS];   // Ordenados pelo resumo
+static uint32_t prefixes[CRED_MAX_USERS];       // Primeiros 32 bits de cada resumo
+static uint8_t bank;                            // Banco com o cadastro atual
+
+static uint32_t cred_crc(const cred_header_t *h, const cred_record_t *r) {
+    uint32_t crc = crc32_update(0, h, offsetof(cred_header_t, crc));
+    return crc32_update(crc, r, h->count * sizeof(cred_record_t));
+}
+
+static uint32_t hash_prefix(const uint8_t *hash) {
+    return (uint32_t)hash[0] << 24 | (uint32_t)hash[1] << 16 | (uint32_t)hash[2] << 8 | hash[3];
+}
+
+static bool code_valid(const char *code) {
+    size_t len = strlen(code);
+    if (len == 0 || len > CRED_CODE_MAX) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (code[i] < '0' || code[i] > '9') {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void code_hash(const char *code, uint8_t hash[SHA256_DIGEST_SIZE]) {
+    sha256_t ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, header.salt, sizeof(header.salt));
+    sha256_update(&ctx, code, strlen(code));
+    sha256_final(&ctx, hash);
+}
+
+// Compara todos os bytes, sem sair no primeiro diferente
+static bool hash_equal(const uint8_t *a, const uint8_t *b) {
+    uint8_t diff = 0;
+    for (int i = 0; i < SHA256_DIGEST_SIZE; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+// Primeira posição com prefixo >= key; o número de passos só depende de quantos
+// registros existem
+static uint16_t lower_bound(uint32_t key) {
+    uint16_t base = 0;
+    uint16_t n = header.count;
+    while (n > 1) {
+        uint16_t half = n / 2;
+        base = prefixes[base + half - 1] < key ? base + half : base;
+        n -= half;
+    }
+    return base + (n == 1 && prefixes[base] < key);
+}
+
+static void rebuild_prefixes(void) {
+    for (uint16_t i = 0; i < header.count; i++) {
+        prefixes[i] = hash_prefix(records[i].hash);
+    }
+}
+
+static const cred_header_t *bank_header(uint8_t b) {
+    return (const cred_header_t *)hal_flash_data(CRED_FLASH_OFFSET + b * CRED_BANK_SIZE);
+}
+
+static bool bank_valid(uint8_t b) {
+    const cred_header_t *h = bank_header(b);
+    if (h->magic != CRED_MAGIC || h->version != CRED_VERSION || h->count > CRED_MAX_USERS) {
+        return false;
+    }
+    return cred_crc(h, (const cred_record_t *)(h + 1)) == h->crc;
+}
+
+// Copia a janela [offset, offset + len) da imagem cabeçalho + registros
+static void image_read(uint32_t offset, uint8_t *dst, uint32_t len) {
+    const uint8_t *parts[2] = {(const uint8_t *)&header, (const uint8_t *)records};
+    uint32_t sizes[2] = {sizeof(header), header.count * sizeof(cred_record_t)};
+    memset(dst, 0xFF, len);
+    uint32_t start = 0;
+    for (int p = 0; p < 2; p++) {
+        uint32_t end = start + sizes[p];
+        if (offset < end && offset + len > start) {
+            uint32_t from = offset > start ? offset - start : 0;
+            uint32_t to = offset + len < end ? offset + len - start : sizes[p];
+            memcpy(dst + (start + from - offset), parts[p] + from, to - from);
+        }
+        start = end;
+    }
+}
+
+// Grava o cadastro no banco livre; só passa a usá-lo depois de gravado
+static void persist(void) {
+    header.sequence++;
+    header.crc = cred_crc(&header, records);
+
+    uint8_t target = bank ^ 1u;
+    uint32_t base = CRED_FLASH_OFFSET + target * CRED_BANK_SIZE;
+    uint32_t size = sizeof(header) + header.count * sizeof(cred_record_t);
+    uint32_t sectors = (size + HAL_FLASH_SECTOR_SIZE - 1) / HAL_FLASH_SECTOR_SIZE;
+    hal_flash_erase(base, sectors * HAL_FLASH_SECTOR_SIZE);
+
+    uint8_t page[HAL_FLASH_PAGE_SIZE];
+    for (uint32_t offset = 0; offset < size; offset += HAL_FLASH_PAGE_SIZE) {
+        image_read(offset, page, sizeof(page));
+        hal_flash_program(base + offset, page, sizeof(page));
+    }
+    bank = target;
+}
+
+/**
+ * @brief Carrega o banco válido mais recente da flash para a RAM
+ * @return Quantidade de senhas cadastradas; 0 se a flash não tiver cadastro
+ * (um novo sal é sorteado e nada é gravado até a primeira inclusão)
+ */
+uint16_t credentials_init(void) {
+    bool valid0 = bank_valid(0);
+    bool valid1 = bank_valid(1);
+    if (!valid0 && !valid1) {
+        memset(&header, 0, sizeof(header));
+        header.magic = CRED_MAGIC;
+        header.version = CRED_VERSION;
+        header.next_id = 1;
+        hal_random_bytes(header.salt, sizeof(header.salt));
+        bank = 1;                   // A primeira gravação vai para o banco 0
+        return 0;
+    }
+
+    // Sequência comparada por diferença para tolerar a volta do contador
+    bank = valid1 && (!valid0 || (int32_t)(bank_header(1)->sequence - bank_header(0)->sequence) > 0);
+    const cred_header_t *h = bank_header(bank);
+    header = *h;
+    memcpy(records, h + 1, header.count * sizeof(cred_record_t));
+    rebuild_prefixes();
+    return header.count;
+}
+
+/**
+ * @brief Verifica uma senha contra todas as cadastradas
+ * @param user Recebe identificador e papel se a senha for aceita (pode ser NULL)
+ * @note Custo de um SHA-256 mais uma busca de passos fixos, em tempo que não
+ *       depende do quanto a senha se aproxima de uma cadastrada
+ */
+bool credentials_verify(const char *code, cred_user_t *user) {
+    if (header.count == 0 || !code_valid(code)) {
+        return false;
+    }
+
+    uint8_t hash[SHA256_DIGEST_SIZE];
+    code_hash(code, hash);
+    uint32_t key = hash_prefix(hash);
+    uint16_t i = lower_bound(key);
+    if (i == header.count) {
+        i--;                        // Compara mesmo assim, com um resumo qualquer
+    }
+
+    // Prefixos iguais com resumos diferentes são raríssimos, mas possíveis
+    bool ok = false;
+    do {
+        if (hash_equal(records[i].hash, hash)) {
+            ok = true;
+            if (user != NULL) {
+                user->id = records[i].id;
+                user->role = records[i].role;
+            }
+        }
+        i++;
+    } while (i < header.count && prefixes[i] == key);
+    return ok;
+}
+
+/**
+ * @brief Cadastra uma senha e grava o cadastro na flash
+ * @param id Recebe o identificador atribuído (pode ser NULL)
+ */
+cred_status_t credentials_add(const char *code, uint8_t role, uint16_t *id) {
+    if (!code_valid(code) || role > CRED_ROLE_ADMIN) {
+        return CRED_ERR_INVALID;
+    }
+    if (credentials_verify(code, NULL)) {
+        return CRED_ERR_DUPLICATE;
+    }
+    if (header.count >= CRED_MAX_USERS) {
+        return CRED_ERR_FULL;
+    }
+
+    cred_record_t r = {.id = header.next_id, .role = role};
+    code_hash(code, r.hash);
+
+    // Inserção ordenada pelo resumo completo
+    uint16_t pos = 0;
+    while (pos < header.count && memcmp(records[pos].hash, r.hash, SHA256_DIGEST_SIZE) < 0) {
+        pos++;
+    }
+    memmove(&records[pos + 1], &records[pos], (header.count - pos) * sizeof(cred_record_t));
+    records[pos] = r;
+    header.count++;
+    header.next_id = header.next_id == UINT16_MAX ? 1 : header.next_id + 1;
+    rebuild_prefixes();
+    persist();
+
+    if (id != NULL) {
+        *id = r.id;
+    }
+    return CRED_OK;
+}
+
+/**
+ * @brief Remove uma senha e grava o cadastro na flash
+ * @note O último administrador não pode ser removido
+ */
+cred_status_t credentials_revoke(uint16_t id) {
+    uint16_t pos = header.count;
+    uint16_t admins = 0;
+    for (uint16_t i = 0; i < header.count; i++) {
+        if (records[i].id == id) {
+            pos = i;
+        }
+        admins += records[i].role == CRED_ROLE_ADMIN;
+    }
+    if (pos == header.count) {
+        return CRED_ERR_NOT_FOUND;
+    }
+    if (records[pos].role == CRED_ROLE_ADMIN && admins == 1) {
+        return CRED_ERR_LAST_ADMIN;
+    }
+
+    memmove(&records[pos], &records[pos + 1], (header.count - pos - 1) * sizeof(cred_record_t));
+    header.count--;
+    rebuild_prefixes();
+    persist();
+    return CRED_OK;
+}
+
+uint16_t credentials_count(void) {
+    return header.count;
+}
+
+/**
+ * @brief Identificador e papel da senha na posição index (ordem interna)
+ */
+bool credentials_get(uint16_t index, cred_user_t *user) {
+    if (index >= header.count) {
+        return false;
+    }
+    user->id = records[index].id;
+    user->role = records[index].role;
+    return true;
+}
+
+const char *credentials_status_text(cred_status_t status) {
+    switch (status) {
+        case CRED_OK:             return "ok";
+        case CRED_ERR_INVALID:    return "senha ou papel invalido";
+        case CRED_ERR_DUPLICATE:  return "senha ja cadastrada";
+        case CRED_ERR_FULL:       return "cadastro cheio";
+        case CRED_ERR_NOT_FOUND:  return "usuario nao encontrado";
+        case CRED_ERR_LAST_ADMIN: return "ultimo administrador";
+    }
+    return "?";
+}
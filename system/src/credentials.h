@@ -0,0 +1,43 @@
+#ifndef CREDENTIALS_H
+#define CREDENTIALS_H
+
+#include "src/hal/hal.h"
+#include "src/sha256.h"
+
+// Região da flash de dados: dois bancos de 2 setores, gravados alternadamente
+#define CRED_FLASH_OFFSET 0
+#define CRED_BANK_SIZE    (2 * HAL_FLASH_SECTOR_SIZE)
+#define CRED_FLASH_SIZE   (2 * CRED_BANK_SIZE)
+
+#define CRED_MAX_USERS 200      // Cabe em um banco com o cabeçalho
+#define CRED_CODE_MAX  16       // Maior senha aceita (dígitos)
+#define CRED_SALT_SIZE 16
+
+// Papéis
+#define CRED_ROLE_USER  0       // Libera o acesso
+#define CRED_ROLE_ADMIN 1       // Libera o acesso, destrava o sistema e gerencia senhas
+
+typedef enum {
+    CRED_OK,
+    CRED_ERR_INVALID,           // Senha fora do formato ou papel desconhecido
+    CRED_ERR_DUPLICATE,         // Senha já cadastrada
+    CRED_ERR_FULL,
+    CRED_ERR_NOT_FOUND,
+    CRED_ERR_LAST_ADMIN         // Revogação deixaria o sistema sem administrador
+} cred_status_t;
+
+typedef struct {
+    uint16_t id;
+    uint8_t role;
+} cred_user_t;
+
+// Prototipação das funções do cadastro de senhas
+uint16_t credentials_init(void);
+bool credentials_verify(const char *code, cred_user_t *user);
+cred_status_t credentials_add(const char *code, uint8_t role, uint16_t *id);
+cred_status_t credentials_revoke(uint16_t id);
+uint16_t credentials_count(void);
+bool credentials_get(uint16_t index, cred_user_t *user);
+const char *credentials_status_text(cred_status_t status);
+
+#endif // CREDENTIALS_H
@@ -1,23 +1,164 @@
-#include "debouncer.h"
-#include "pico/stdlib.h"
-
-/**
- * @brief Verifica se o tempo de debounce foi ultrapassado.
- *
- * Compara o tempo atual com o último tempo de interrupção e atualiza este
- * se o intervalo especificado em microssegundos tiver sido excedido.
- *
- * @param last_interrupt_time Ponteiro para a variável que armazena o tempo da última interrupção.
- * @param debounce_time_us Tempo de debounce em microssegundos.
- * @return true Se o intervalo de debounce foi ultrapassado.
- * @return false Se o intervalo de debounce ainda não foi atingido.
- */
-
-bool check_debounce(uint32_t *last_interrupt_time, uint32_t debounce_time_us) {
-    uint32_t current_time = time_us_32();
-    if (current_time - *last_interrupt_time > debounce_time_us) {
-        *last_interrupt_time = current_time;
-        return true;
-    }
-    return false;
-}
+#include "debouncer.h"
+#include "src/trace.h"
+
+/*
+ * Debouncer por amostragem periódica.
+ *
+ * Um único temporizador lê o nível de todos os pinos de uma vez a cada
+ * DEBOUNCE_TICK_US e alimenta um integrador por entrada: ele sobe com a
+ * entrada ativa e desce com ela inativa, saturando em 0 e em
+ * DEBOUNCE_INTEGRATOR. A entrada só muda de estado ao atingir o extremo
+ * oposto, então repiques mais curtos que ~DEBOUNCE_INTEGRATOR amostras nunca
+ * geram eventos. O custo por amostragem é fixo e proporcional ao número de
+ * entradas, independente de quantos repiques os contatos produzam.
+ *
+ * Os eventos EVENT_PRESS e EVENT_RELEASE levam o instante da primeira amostra
+ * que iniciou a mudança; EVENT_LONG_PRESS e EVENT_REPEAT, o instante em que
+ * ocorreram. A fonte de todos é o pino.
+ */
+
+typedef struct {
+    uint8_t pin;
+    bool active_low;
+    bool pressed;                   // Estado confirmado
+    bool moving;                    // Integrador fora do repouso do estado confirmado
+    uint8_t integrator;
+    bool long_sent;
+    uint32_t edge_us;               // Primeira amostra da mudança em andamento
+    uint32_t held_ticks;            // Amostras desde a confirmação do pressionamento
+    uint32_t long_ticks;
+    uint32_t repeat_ticks;          // Próximo EVENT_REPEAT (em held_ticks)
+    uint32_t repeat_delay_ticks;
+    uint32_t repeat_interval_ticks;
+} debounce_input_t;
+
+static debounce_input_t inputs[DEBOUNCE_MAX_INPUTS];
+static volatile uint8_t input_count;
+static event_queue_t *debounce_events;
+
+static uint32_t ms_to_ticks(uint16_t ms) {
+    uint32_t ticks = ((uint32_t)ms * 1000u + DEBOUNCE_TICK_US - 1) / DEBOUNCE_TICK_US;
+    return ms != 0 && ticks == 0 ? 1 : ticks;
+}
+
+static void debounce_sample(debounce_input_t *in, bool active, uint32_t now) {
+    uint8_t rest = in->pressed ? DEBOUNCE_INTEGRATOR : 0;
+    if (active && in->integrator < DEBOUNCE_INTEGRATOR) {
+        in->integrator++;
+    } else if (!active && in->integrator > 0) {
+        in->integrator--;
+    }
+
+    if (in->integrator == rest) {
+        in->moving = false;
+    } else if (!in->moving) {
+        in->moving = true;
+        in->edge_us = now;
+    }
+
+    if (!in->pressed && in->integrator == DEBOUNCE_INTEGRATOR) {
+        in->pressed = true;
+        in->moving = false;
+        in->long_sent = false;
+        in->held_ticks = 0;
+        in->repeat_ticks = in->repeat_delay_ticks;
+        event_queue_push(debounce_events, EVENT_PRESS, in->pin, in->edge_us);
+    } else if (in->pressed && in->integrator == 0) {
+        in->pressed = false;
+        in->moving = false;
+        event_queue_push(debounce_events, EVENT_RELEASE, in->pin, in->edge_us);
+    } else if (in->pressed) {
+        in->held_ticks++;
+        if (in->long_ticks != 0 && !in->long_sent && in->held_ticks >= in->long_ticks) {
+            in->long_sent = true;
+            event_queue_push(debounce_events, EVENT_LONG_PRESS, in->pin, now);
+        }
+        if (in->repeat_ticks != 0 && in->held_ticks >= in->repeat_ticks) {
+            in->repeat_ticks += in->repeat_interval_ticks;
+            event_queue_push(debounce_events, EVENT_REPEAT, in->pin, now);
+        }
+    }
+}
+
+/**
+ * @brief Amostra todas as entradas registradas
+ * @note Chamada pelo temporizador; fora dele (medições em src/bench.c), só
+ *       com as interrupções bloqueadas
+ */
+void debouncer_poll(void) {
+    uint32_t now = hal_time_us_32();
+#if TRACE_ENABLED
+    // Argumento: atraso desta amostragem em relação ao período (latência da interrupção)
+    static uint32_t last_tick_us;
+    TRACE_BEGIN(DEBOUNCE_IRQ, last_tick_us ? now - last_tick_us - DEBOUNCE_TICK_US : 0);
+    last_tick_us = now;
+#endif
+    uint32_t levels = hal_gpio_get_all();
+    uint8_t count = input_count;
+    for (uint8_t i = 0; i < count; i++) {
+        debounce_input_t *in = &inputs[i];
+        bool level = (levels >> in->pin) & 1u;
+        debounce_sample(in, level != in->active_low, now);
+    }
+    TRACE_END(DEBOUNCE_IRQ, count);
+}
+
+static void debouncer_tick(void *ctx) {
+    debouncer_poll();
+}
+
+/**
+ * @brief Inicia a amostragem periódica das entradas
+ * @param events Fila que recebe os eventos (o debouncer é o único produtor)
+ * @return false se não houver temporizador periódico livre
+ */
+bool debouncer_init(event_queue_t *events) {
+    debounce_events = events;
+    input_count = 0;
+    return hal_timer_every_us(DEBOUNCE_TICK_US, debouncer_tick, NULL);
+}
+
+/**
+ * @brief Registra um pino já configurado como entrada
+ * @param active_low true se a entrada fica ativa em nível baixo (botão com pull-up)
+ * @param config Pressão longa e repetição; NULL desliga ambas
+ * @return false se todas as posições estiverem ocupadas
+ * @note O estado inicial é o nível atual do pino, sem gerar evento
+ */
+bool debouncer_add(uint pin, bool active_low, const debounce_config_t *config) {
+    if (input_count >= DEBOUNCE_MAX_INPUTS) {
+        return false;
+    }
+
+    debounce_input_t *in = &inputs[input_count];
+    in->pin = (uint8_t)pin;
+    in->active_low = active_low;
+    in->pressed = hal_gpio_get(pin) != active_low;
+    in->integrator = in->pressed ? DEBOUNCE_INTEGRATOR : 0;
+    in->moving = false;
+    in->long_sent = true;
+    in->held_ticks = 0;
+    in->long_ticks = config ? ms_to_ticks(config->long_press_ms) : 0;
+    in->repeat_delay_ticks = config ? ms_to_ticks(config->repeat_delay_ms) : 0;
+    in->repeat_interval_ticks = config ? ms_to_ticks(config->repeat_interval_ms) : 0;
+    if (in->repeat_interval_ticks == 0) {
+        in->repeat_interval_ticks = in->repeat_delay_ticks;
+    }
+    in->repeat_ticks = 0;
+
+    // Publica a entrada só depois de preenchida: a amostragem já pode estar rodando
+    __atomic_store_n(&input_count, input_count + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * @brief Estado confirmado (sem repiques) de um pino registrado
+ */
+bool debouncer_pressed(uint pin) {
+    for (uint8_t i = 0; i < input_count; i++) {
+        if (inputs[i].pin == pin) {
+            return inputs[i].pressed;
+        }
+    }
+    return false;
+}
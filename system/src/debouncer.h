@@ -1,13 +1,25 @@
-#ifndef DEBOUNCE_H
-#define DEBOUNCE_H
-
-#include <stdbool.h>
-#include <stdint.h>
-
-// Função que verifica se o tempo decorrido desde a última interrupção
-// é maior que o tempo definido para debouncing. Em caso afirmativo,
-// atualiza o tempo e retorna true; caso contrário, retorna false.
-
-bool check_debounce(uint32_t *last_interrupt_time, uint32_t debounce_time_us);
-
-#endif // DEBOUNCE_H
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include "src/hal/hal.h"
+#include "src/event_queue.h"
+
+// Todas as entradas são amostradas juntas por um temporizador periódico
+#define DEBOUNCE_TICK_US     2000
+#define DEBOUNCE_INTEGRATOR  5      // Amostras para confirmar uma mudança (10 ms)
+#define DEBOUNCE_MAX_INPUTS  32
+
+// Comportamento de uma entrada enquanto pressionada (0 desliga o evento)
+typedef struct {
+    uint16_t long_press_ms;         // EVENT_LONG_PRESS após este tempo pressionada
+    uint16_t repeat_delay_ms;       // Primeiro EVENT_REPEAT após este tempo pressionada
+    uint16_t repeat_interval_ms;    // Intervalo entre os EVENT_REPEAT seguintes
+} debounce_config_t;
+
+// Prototipação das funções do debouncer
+bool debouncer_init(event_queue_t *events);
+bool debouncer_add(uint pin, bool active_low, const debounce_config_t *config);
+bool debouncer_pressed(uint pin);
+void debouncer_poll(void);
+
+#endif // DEBOUNCE_H
@@ -1,6 +1,5 @@
 #include "display.h"
-#include "hardware/i2c.h"
-#include "hardware/gpio.h"
+#include "src/ui.h"
 
 // Define a estrutura do display (instância global)
 ssd1306_t ssd;
@@ -11,11 +10,7 @@ ssd1306_t ssd;
  */
 void init_display(void) {
     // Inicializa o I2C com frequência de 400kHz
-    i2c_init(I2C_PORT, 400 * 1000);
-    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA);
-    gpio_pull_up(I2C_SCL);
+    hal_i2c_init(I2C_PORT, 400 * 1000, I2C_SDA, I2C_SCL);
     
     // Inicializa e configura o display SSD1306
     ssd1306_init(&ssd, DISPLAY_WIDTH, DISPLAY_HEIGHT, false, ENDERECO, I2C_PORT);
@@ -32,9 +27,17 @@ void init_display(void) {
  * @param msg1 Texto da primeira linha (superior)
  * @param msg2 Texto da segunda linha (central)
  * @param msg3 Texto da terceira linha (inferior)
- * @note As mensagens são exibidas em posições fixas (10px, 20/30/40px Y)
+ * @note Apenas enfileira a mensagem; o desenho é feito pelo núcleo 1
  */
 void display_message(const char *msg1, const char *msg2, const char *msg3) {
+    ui_message(msg1, msg2, msg3);
+}
+
+/**
+ * @brief Desenha a mensagem de 3 linhas e inicia a transferência ao OLED
+ * @note As mensagens são exibidas em posições fixas (10px, 20/30/40px Y)
+ */
+void display_draw_message(const char *msg1, const char *msg2, const char *msg3) {
     // Limpa o display
     ssd1306_fill(&ssd, false);
     ssd1306_rect(&ssd, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, 1, 0);
@@ -50,14 +53,18 @@ void display_message(const char *msg1, const char *msg2, const char *msg3) {
         ssd1306_draw_string(&ssd, msg3, 10, 40);
     }
     
-    // Atualiza o display com os dados desenhados
-    ssd1306_send_data(&ssd);
+    // Atualiza o display enviando apenas o que mudou, sem esperar o fim da transferência
+    ssd1306_flush_async(&ssd);
 }
 
 /**
  * @brief Desliga o display limpando seu conteúdo
  */
 void display_off(void){
+    ui_display_off();
+}
+
+void display_draw_off(void){
     // Limpa o display
     ssd1306_fill(&ssd, false);
 }
\ No newline at end of file
@@ -2,11 +2,10 @@
 #define DISPLAY_H
 
 #include "inc/ssd1306.h"
-#include "hardware/i2c.h"
-#include "pico/stdlib.h"
+#include "src/hal/hal.h"
 
 // Configurações do display e I2C
-#define I2C_PORT       i2c1
+#define I2C_PORT       1
 #define I2C_SDA        14
 #define I2C_SCL        15
 #define DISPLAY_WIDTH  128
@@ -23,4 +22,9 @@ void display_message(const char *msg1, const char *msg2, const char *msg3);
 
 void display_off(void);
 
+// Desenho efetivo, executado pelo núcleo 1 (ver ui.c)
+void display_draw_message(const char *msg1, const char *msg2, const char *msg3);
+
+void display_draw_off(void);
+
 #endif // DISPLAY_H
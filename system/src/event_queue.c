@@ -0,0 +1,60 @@
+#include "src/event_queue.h"
+
+/*
+ * Fila SPSC sem travas: head e tail crescem livremente e são mascarados no
+ * acesso. O produtor publica o item antes de avançar head (release) e o
+ * consumidor lê head com acquire, então nenhum dos lados precisa desabilitar
+ * interrupções.
+ */
+
+#define EVENT_QUEUE_MASK (EVENT_QUEUE_SIZE - 1)
+
+void event_queue_init(event_queue_t *q) {
+    q->head = 0;
+    q->tail = 0;
+    q->dropped = 0;
+}
+
+/**
+ * @brief Insere um evento na fila
+ * @return false se a fila estiver cheia (o evento é contado como perdido)
+ * @note Chamada apenas pelo produtor, tipicamente uma rotina de interrupção
+ */
+bool event_queue_push(event_queue_t *q, uint8_t type, uint8_t source, uint32_t timestamp_us) {
+    uint32_t head = q->head;
+    uint32_t tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+
+    if (head - tail >= EVENT_QUEUE_SIZE) {
+        q->dropped++;
+        return false;
+    }
+
+    event_t *ev = &q->items[head & EVENT_QUEUE_MASK];
+    ev->type = type;
+    ev->source = source;
+    ev->timestamp_us = timestamp_us;
+    __atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * @brief Retira o evento mais antigo da fila
+ * @return false se a fila estiver vazia
+ * @note Chamada apenas pelo consumidor
+ */
+bool event_queue_pop(event_queue_t *q, event_t *ev) {
+    uint32_t tail = q->tail;
+    uint32_t head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+
+    if (head == tail) {
+        return false;
+    }
+
+    *ev = q->items[tail & EVENT_QUEUE_MASK];
+    __atomic_store_n(&q->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+uint32_t event_queue_dropped(const event_queue_t *q) {
+    return __atomic_load_n(&q->dropped, __ATOMIC_RELAXED);
+}
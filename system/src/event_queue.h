@@ -0,0 +1,36 @@
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include "src/hal/hal.h"
+
+// Capacidade da fila (potência de 2)
+#define EVENT_QUEUE_SIZE 16
+
+// Tipos de evento de entrada
+#define EVENT_PRESS   0
+#define EVENT_RELEASE 1
+#define EVENT_NAV     2     // Navegação do joystick; source é a direção (JOYSTICK_UP, ...)
+#define EVENT_LONG_PRESS 3  // Entrada mantida pressionada além do tempo configurado
+#define EVENT_REPEAT  4     // Repetição automática enquanto a entrada segue pressionada
+
+typedef struct {
+    uint8_t type;           // EVENT_PRESS, EVENT_RELEASE, ...
+    uint8_t source;         // Pino GPIO (ou identificador) que gerou o evento
+    uint32_t timestamp_us;  // Instante do evento (hal_time_us_32)
+} event_t;
+
+// Fila circular de um produtor (interrupção) e um consumidor (laço principal)
+typedef struct {
+    event_t items[EVENT_QUEUE_SIZE];
+    uint32_t head;          // Escrito apenas pelo produtor
+    uint32_t tail;          // Escrito apenas pelo consumidor
+    uint32_t dropped;       // Eventos perdidos por fila cheia
+} event_queue_t;
+
+// Prototipação das funções da fila de eventos
+void event_queue_init(event_queue_t *q);
+bool event_queue_push(event_queue_t *q, uint8_t type, uint8_t source, uint32_t timestamp_us);
+bool event_queue_pop(event_queue_t *q, event_t *ev);
+uint32_t event_queue_dropped(const event_queue_t *q);
+
+#endif // EVENT_QUEUE_H
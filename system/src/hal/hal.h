@@ -0,0 +1,183 @@
+#ifndef HAL_H
+#define HAL_H
+
+/*
+ * Camada de abstração de hardware (HAL)
+ *
+ * Os módulos da aplicação acessam GPIO, ADC, PWM, I2C, UART, PIO e tempo somente
+ * por estas funções. Na placa elas são implementadas em hal_pico.c sobre o Pico
+ * SDK; no alvo de simulação (host/, compilado com HAL_HOST) são implementadas por
+ * hal_host.c sobre periféricos simulados e um relógio virtual.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef HAL_HOST
+typedef unsigned int uint;
+#else
+#include "pico/stdlib.h"
+#endif
+
+#define HAL_NO_CHAR        (-1)     // Nenhum caractere disponível dentro do timeout
+#define HAL_GPIO_EDGE_FALL 0x4u
+#define HAL_GPIO_EDGE_RISE 0x8u
+#define HAL_I2C_STOP       0x200u   // Marca, no fluxo de palavras I2C, o último byte de uma transação
+
+typedef uint hal_pio_t;             // Índice do bloco PIO (0 ou 1)
+#define HAL_PIO0 0
+#define HAL_PIO1 1
+
+typedef void (*hal_gpio_irq_t)(uint gpio, uint32_t events);
+typedef void (*hal_callback_t)(void *ctx);
+
+// --- Tempo ---
+uint32_t hal_time_us_32(void);
+uint64_t hal_time_us_64(void);
+uint32_t hal_time_ms(void);
+void hal_busy_wait_us(uint32_t us);
+void hal_busy_wait_ms(uint32_t ms);
+void hal_wait_until(uint64_t deadline_us);   // Dorme até o prazo ou até a próxima interrupção
+uint32_t hal_clock_sys_hz(void);             // Clock do sistema (base dos contadores PWM)
+
+// --- Alarmes do timer ---
+// callback roda em contexto de interrupção após delay_us; retorna um id (> 0),
+// ou 0 se não houver alarme livre ou se o prazo já passou (callback já executada)
+#define HAL_MAX_ALARMS 8
+int hal_alarm_in_us(uint32_t delay_us, hal_callback_t callback, void *ctx);
+void hal_alarm_cancel(int id);
+
+// --- Temporizadores periódicos ---
+// callback roda em contexto de interrupção a cada period_us, sem acumular atraso
+#define HAL_MAX_TIMERS 2
+bool hal_timer_every_us(uint32_t period_us, hal_callback_t callback, void *ctx);
+
+// --- Seções críticas ---
+uint32_t hal_irq_save(void);
+void hal_irq_restore(uint32_t state);
+
+// --- Pontos de rastreamento (src/trace.h) ---
+// Versões em linha, de poucas instruções: relógio de 1 MHz comum aos dois
+// núcleos, número do núcleo atual e bloqueio das interrupções do núcleo
+#ifdef HAL_HOST
+uint32_t hal_trace_time_us(void);   // Não avança o relógio simulado
+uint hal_core_num(void);
+#define HAL_TRACE_TIME_US()   hal_trace_time_us()
+#define HAL_CORE_NUM()        hal_core_num()
+#define HAL_IRQ_SAVE_INLINE() hal_irq_save()
+#define HAL_IRQ_RESTORE_INLINE(state) hal_irq_restore(state)
+#else
+#include "hardware/structs/timer.h"
+#include "hardware/sync.h"
+#define HAL_TRACE_TIME_US()   (timer_hw->timerawl)
+#define HAL_CORE_NUM()        get_core_num()
+#define HAL_IRQ_SAVE_INLINE() save_and_disable_interrupts()
+#define HAL_IRQ_RESTORE_INLINE(state) restore_interrupts(state)
+#endif
+
+// --- Amostragem do PC (perfilador) ---
+// sample roda a cada period_us numa interrupção de prioridade máxima do núcleo
+// que chamou hal_pc_sampler_start, com o endereço da instrução interrompida.
+// No simulador o endereço é o de retorno da chamada à HAL em que o tempo passou
+typedef void (*hal_pc_sample_t)(uintptr_t pc);
+bool hal_pc_sampler_start(uint32_t period_us, hal_pc_sample_t sample);
+void hal_pc_sampler_stop(void);
+
+// --- Flash: região de dados no fim da memória, fora do programa ---
+// Leitura direta pelo ponteiro de hal_flash_data; apagar (setores inteiros) e
+// gravar (páginas inteiras) pausam o núcleo 1 e as interrupções
+#define HAL_FLASH_SECTOR_SIZE 4096
+#define HAL_FLASH_PAGE_SIZE   256
+#define HAL_FLASH_DATA_SIZE   (64 * 1024)
+const uint8_t *hal_flash_data(uint32_t offset);
+void hal_flash_erase(uint32_t offset, uint32_t len);
+void hal_flash_program(uint32_t offset, const void *data, uint32_t len);
+
+// --- Aleatoriedade (sais, nonces) ---
+void hal_random_bytes(void *dst, size_t len);
+
+// --- Núcleo 1 ---
+// work executa no núcleo 1 uma vez para cada hal_core1_signal() (sinais pendentes podem se fundir)
+void hal_core1_start(hal_callback_t work, void *ctx);
+void hal_core1_signal(void);
+
+// --- GPIO ---
+void hal_gpio_init_output(uint pin);
+void hal_gpio_init_input_pullup(uint pin);
+void hal_gpio_put(uint pin, bool value);
+bool hal_gpio_get(uint pin);
+uint32_t hal_gpio_get_all(void);    // Nível de todos os pinos (bit n = GPIO n) numa única leitura
+void hal_gpio_set_irq(uint pin, uint32_t events, hal_gpio_irq_t callback);
+
+// --- ADC ---
+void hal_adc_init(void);
+void hal_adc_gpio_init(uint pin);
+void hal_adc_select_input(uint channel);
+uint16_t hal_adc_read(void);
+
+// Conversão contínua em rodízio pelos canais de channel_mask (sample_rate_hz por canal),
+// com as amostras gravadas por DMA em ring (ring_len potência de 2, alinhado a ring_len * 2 bytes)
+int hal_adc_stream_start(uint32_t channel_mask, uint32_t sample_rate_hz, uint16_t *ring, size_t ring_len);
+size_t hal_adc_stream_position(int stream);   // Índice em ring da próxima amostra a ser gravada
+
+// --- PWM ---
+void hal_pwm_init_pin(uint pin);
+void hal_pwm_configure(uint pin, float clkdiv, uint16_t wrap, uint16_t level);
+void hal_pwm_enable(uint pin, bool enabled);
+
+// --- I2C ---
+void hal_i2c_init(uint bus, uint baudrate, uint sda, uint scl);
+int hal_i2c_write(uint bus, uint8_t address, const uint8_t *src, size_t len, bool nostop);
+
+// Fluxo assíncrono: palavras de 16 bits (byte nos bits 0..7, HAL_I2C_STOP encerra a transação)
+// entregues à FIFO de TX por DMA; done é chamada em contexto de interrupção ao final
+int hal_i2c_stream_claim(uint bus, hal_callback_t done, void *ctx);
+void hal_i2c_stream_start(int stream, uint8_t address, const uint16_t *words, size_t count);
+bool hal_i2c_stream_busy(int stream);
+
+// --- UART e stdio (USB) ---
+void hal_stdio_init(void);
+int hal_stdio_getchar(uint32_t timeout_us);
+void hal_uart_init(uint uart, uint baudrate, uint tx_pin, uint rx_pin);
+bool hal_uart_readable(uint uart);
+char hal_uart_getc(uint uart);
+void hal_uart_putc(uint uart, char c);
+// Recepção por interrupção: handler roda na interrupção de RX enquanto habilitada
+void hal_uart_set_rx_irq(uint uart, hal_callback_t handler, void *ctx);
+void hal_uart_rx_irq_enable(uint uart, bool enable);
+// handler é chamado (em interrupção) quando chegam caracteres pela USB
+void hal_stdio_set_rx_callback(hal_callback_t handler, void *ctx);
+
+// Fluxo de TX por DMA: bytes entregues à FIFO da UART sem ocupar a CPU. Pode
+// se intercalar, byte a byte, com o texto do stdio na mesma UART
+int hal_uart_stream_claim(uint uart);
+void hal_uart_stream_start(int stream, const uint8_t *data, size_t len);
+bool hal_uart_stream_busy(int stream);
+
+// --- Matriz WS2812 (programa PIO pio_matrix) ---
+void hal_matrix_init(hal_pio_t pio, uint sm, uint pin);
+
+// Fluxo por DMA: palavras GRB (24 bits mais significativos) entregues à FIFO de TX da state machine
+int hal_matrix_stream_claim(hal_pio_t pio, uint sm);
+void hal_matrix_stream_start(int stream, const uint32_t *words, size_t count);
+bool hal_matrix_stream_busy(int stream);
+
+// --- Teclado matricial 4x4 (programa PIO keypad_scan) ---
+// Linhas nos GPIO 2, 3, 4 e 8 e colunas nos GPIO 16 a 19, fixos no programa.
+// A PIO varre sozinha e on_change roda em interrupção a cada leitura diferente
+// da anterior; hal_keypad_read entrega as leituras pendentes, com o bit
+// (linha * 4 + coluna) em 1 para contato fechado
+#define HAL_KEYPAD_ROWS 4
+#define HAL_KEYPAD_COLS 4
+void hal_keypad_init(hal_pio_t pio, uint sm, hal_callback_t on_change, void *ctx);
+bool hal_keypad_read(uint16_t *closed);
+
+// --- Leitor de íris ---
+// Código de íris já extraído pelo sensor: HAL_IRIS_CODE_WORDS palavras de bits
+// de fase e outras tantas de máscara (1 = bit válido). false sem sensor ou sem
+// olho diante dele
+#define HAL_IRIS_CODE_WORDS 64
+bool hal_iris_capture(uint32_t *code, uint32_t *mask);
+
+#endif // HAL_H
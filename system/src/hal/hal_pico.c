@@ -0,0 +1,681 @@
+#include "src/hal/hal.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/pwm.h"
+#include "hardware/uart.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "hardware/flash.h"
+#include "pico/multicore.h"
+#include "pico/stdio_usb.h"
+#include "pico/rand.h"
+#include "led_matrix.pio.h"
+#include "keypad.pio.h"
+
+#include <string.h>
+
+/*
+ * Implementação da HAL sobre o Pico SDK. As funções são repasses diretos
+ * para o SDK; apenas os fluxos por DMA guardam estado (canal, barramento ou
+ * anel de destino e callback de conclusão).
+ */
+
+typedef struct {
+  i2c_inst_t *i2c;
+  const void *ring;     // Base do anel (fluxo do ADC)
+  hal_callback_t done;
+  void *ctx;
+} hal_dma_slot_t;
+
+static hal_dma_slot_t dma_slots[NUM_DMA_CHANNELS];
+
+typedef struct {
+  alarm_id_t id;
+  hal_callback_t callback;
+  void *ctx;
+} hal_alarm_slot_t;
+
+static hal_alarm_slot_t alarm_slots[HAL_MAX_ALARMS];
+
+typedef struct {
+  repeating_timer_t timer;
+  hal_callback_t callback;
+  void *ctx;
+} hal_timer_slot_t;
+
+static hal_timer_slot_t timer_slots[HAL_MAX_TIMERS];
+
+static PIO keypad_pio;
+static uint keypad_sm;
+static hal_callback_t keypad_handler;
+static void *keypad_ctx;
+
+static hal_callback_t core1_work;
+static void *core1_ctx;
+
+/*=======*/
+/* Tempo */
+/*=======*/
+
+uint32_t hal_time_us_32(void) {
+  return time_us_32();
+}
+
+uint64_t hal_time_us_64(void) {
+  return time_us_64();
+}
+
+uint32_t hal_time_ms(void) {
+  return to_ms_since_boot(get_absolute_time());
+}
+
+void hal_busy_wait_us(uint32_t us) {
+  busy_wait_us(us);
+}
+
+void hal_busy_wait_ms(uint32_t ms) {
+  busy_wait_ms(ms);
+}
+
+// WFE com alarme de hardware no prazo: qualquer interrupção também acorda o núcleo
+void hal_wait_until(uint64_t deadline_us) {
+  if (deadline_us > time_us_64())
+    best_effort_wfe_or_timeout(from_us_since_boot(deadline_us));
+}
+
+uint32_t hal_clock_sys_hz(void) {
+  return clock_get_hz(clk_sys);
+}
+
+static int64_t hal_alarm_handler(alarm_id_t id, void *user_data) {
+  hal_alarm_slot_t *slot = user_data;
+  hal_callback_t callback = slot->callback;
+  slot->callback = NULL;
+  callback(slot->ctx);
+  return 0;   // Não repete
+}
+
+int hal_alarm_in_us(uint32_t delay_us, hal_callback_t callback, void *ctx) {
+  uint32_t state = save_and_disable_interrupts();
+  hal_alarm_slot_t *slot = NULL;
+  for (int i = 0; i < HAL_MAX_ALARMS && slot == NULL; ++i)
+    if (alarm_slots[i].callback == NULL)
+      slot = &alarm_slots[i];
+  if (slot != NULL) {
+    slot->callback = callback;
+    slot->ctx = ctx;
+    slot->id = add_alarm_in_us(delay_us, hal_alarm_handler, slot, true);
+    if (slot->id <= 0) {
+      slot->callback = NULL;
+      slot = NULL;
+    }
+  }
+  restore_interrupts(state);
+  return slot != NULL ? slot->id : 0;
+}
+
+static bool hal_timer_handler(repeating_timer_t *rt) {
+  hal_timer_slot_t *slot = rt->user_data;
+  slot->callback(slot->ctx);
+  return true;
+}
+
+bool hal_timer_every_us(uint32_t period_us, hal_callback_t callback, void *ctx) {
+  for (int i = 0; i < HAL_MAX_TIMERS; ++i) {
+    hal_timer_slot_t *slot = &timer_slots[i];
+    if (slot->callback == NULL) {
+      slot->callback = callback;
+      slot->ctx = ctx;
+      // Período negativo: intervalo medido entre inícios de execução
+      if (add_repeating_timer_us(-(int64_t)period_us, hal_timer_handler, slot, &slot->timer))
+        return true;
+      slot->callback = NULL;
+      return false;
+    }
+  }
+  return false;
+}
+
+void hal_alarm_cancel(int id) {
+  uint32_t state = save_and_disable_interrupts();
+  for (int i = 0; i < HAL_MAX_ALARMS; ++i) {
+    if (alarm_slots[i].callback != NULL && alarm_slots[i].id == id) {
+      cancel_alarm(id);
+      alarm_slots[i].callback = NULL;
+    }
+  }
+  restore_interrupts(state);
+}
+
+uint32_t hal_irq_save(void) {
+  return save_and_disable_interrupts();
+}
+
+void hal_irq_restore(uint32_t state) {
+  restore_interrupts(state);
+}
+
+/*==================*/
+/* Amostragem do PC */
+/*==================*/
+
+// Alarme de hardware próprio (o pool de alarmes do SDK usa o alarme 3), com
+// vetor direto: o quadro da exceção fica exatamente no topo da pilha
+static int pc_alarm = -1;
+static hal_pc_sample_t pc_sample;
+static uint32_t pc_period_us, pc_next_us;
+
+// Recebe o quadro empilhado pelo hardware: r0-r3, r12, lr, pc, xpsr
+void __attribute__((used)) hal_pc_sampler_frame(const uint32_t *frame) {
+  timer_hw->intr = 1u << pc_alarm;
+  pc_next_us += pc_period_us;
+  if ((int32_t)(pc_next_us - timer_hw->timerawl) < 2)
+    pc_next_us = timer_hw->timerawl + pc_period_us;   // Atrasou: sem rajada para recuperar
+  timer_hw->alarm[pc_alarm] = pc_next_us;
+  pc_sample(frame[6]);
+}
+
+// O bit 2 do EXC_RETURN (lr) indica a pilha em uso antes da exceção. O desvio
+// sem retorno mantém o EXC_RETURN em lr para a volta de hal_pc_sampler_frame
+static void __attribute__((naked)) pc_sampler_irq(void) {
+  __asm volatile(
+    "movs r0, #4\n"
+    "mov r1, lr\n"
+    "tst r0, r1\n"
+    "bne 1f\n"
+    "mrs r0, msp\n"
+    "b 2f\n"
+    "1:\n"
+    "mrs r0, psp\n"
+    "2:\n"
+    "ldr r1, =hal_pc_sampler_frame\n"
+    "bx r1\n"
+    ".ltorg\n");
+}
+
+bool hal_pc_sampler_start(uint32_t period_us, hal_pc_sample_t sample) {
+  if (pc_alarm < 0) {
+    pc_alarm = hardware_alarm_claim_unused(false);
+    if (pc_alarm < 0)
+      return false;
+    irq_set_exclusive_handler(TIMER_IRQ_0 + pc_alarm, pc_sampler_irq);
+    irq_set_priority(TIMER_IRQ_0 + pc_alarm, PICO_HIGHEST_IRQ_PRIORITY);
+  }
+  pc_sample = sample;
+  pc_period_us = period_us;
+  pc_next_us = timer_hw->timerawl + period_us;
+  hw_set_bits(&timer_hw->inte, 1u << pc_alarm);
+  irq_set_enabled(TIMER_IRQ_0 + pc_alarm, true);
+  timer_hw->alarm[pc_alarm] = pc_next_us;
+  return true;
+}
+
+void hal_pc_sampler_stop(void) {
+  if (pc_alarm < 0)
+    return;
+  irq_set_enabled(TIMER_IRQ_0 + pc_alarm, false);
+  hw_clear_bits(&timer_hw->inte, 1u << pc_alarm);
+  timer_hw->armed = 1u << pc_alarm;   // Escrever 1 desarma
+  timer_hw->intr = 1u << pc_alarm;
+}
+
+/*==========*/
+/* Núcleo 1 */
+/*==========*/
+
+/*
+ * A FIFO entre núcleos fica só para o protocolo de lockout das gravações na
+ * flash: o handler instalado por multicore_lockout_victim_init consome tudo o
+ * que chega nela. O núcleo 0 acorda o núcleo 1 com uma flag e SEV; um SEV que
+ * chegue entre o teste da flag e o WFE fica registrado e o WFE retorna na hora.
+ */
+static volatile bool core1_pending;
+
+static void core1_entry(void) {
+  // Permite que o núcleo 0 pause este núcleo durante gravações na flash
+  multicore_lockout_victim_init();
+  while (true) {
+    while (!core1_pending)
+      __wfe();
+    // Limpa antes de trabalhar: um sinal dado durante work gera outra rodada
+    core1_pending = false;
+    __dmb();
+    core1_work(core1_ctx);
+  }
+}
+
+static bool core1_running;
+
+void hal_core1_start(hal_callback_t work, void *ctx) {
+  core1_work = work;
+  core1_ctx = ctx;
+  multicore_launch_core1(core1_entry);
+  core1_running = true;
+}
+
+// Sinais repetidos antes de o núcleo 1 acordar resultam em uma única execução de work
+void hal_core1_signal(void) {
+  __dmb();                          // Publica a fila antes da flag
+  core1_pending = true;
+  __sev();
+}
+
+/*=======*/
+/* Flash */
+/*=======*/
+
+#define HAL_FLASH_DATA_OFFSET (PICO_FLASH_SIZE_BYTES - HAL_FLASH_DATA_SIZE)
+
+const uint8_t *hal_flash_data(uint32_t offset) {
+  return (const uint8_t *)(uintptr_t)(XIP_BASE + HAL_FLASH_DATA_OFFSET + offset);
+}
+
+// Durante a operação nenhum código pode ser executado da flash (XIP desligado)
+static uint32_t flash_begin(void) {
+  if (core1_running)
+    multicore_lockout_start_blocking();
+  return save_and_disable_interrupts();
+}
+
+static void flash_end(uint32_t state) {
+  restore_interrupts(state);
+  if (core1_running)
+    multicore_lockout_end_blocking();
+}
+
+void hal_flash_erase(uint32_t offset, uint32_t len) {
+  uint32_t state = flash_begin();
+  flash_range_erase(HAL_FLASH_DATA_OFFSET + offset, len);
+  flash_end(state);
+}
+
+void hal_flash_program(uint32_t offset, const void *data, uint32_t len) {
+  uint32_t state = flash_begin();
+  flash_range_program(HAL_FLASH_DATA_OFFSET + offset, data, len);
+  flash_end(state);
+}
+
+/*=================*/
+/* Aleatoriedade   */
+/*=================*/
+
+void hal_random_bytes(void *dst, size_t len) {
+  uint8_t *out = dst;
+  while (len > 0) {
+    uint64_t r = get_rand_64();
+    size_t n = len < sizeof(r) ? len : sizeof(r);
+    memcpy(out, &r, n);
+    out += n;
+    len -= n;
+  }
+}
+
+/*======*/
+/* GPIO */
+/*======*/
+
+void hal_gpio_init_output(uint pin) {
+  gpio_init(pin);
+  gpio_set_dir(pin, GPIO_OUT);
+  gpio_put(pin, 0);
+}
+
+void hal_gpio_init_input_pullup(uint pin) {
+  gpio_init(pin);
+  gpio_set_dir(pin, GPIO_IN);
+  gpio_pull_up(pin);
+}
+
+void hal_gpio_put(uint pin, bool value) {
+  gpio_put(pin, value);
+}
+
+bool hal_gpio_get(uint pin) {
+  return gpio_get(pin);
+}
+
+uint32_t hal_gpio_get_all(void) {
+  return gpio_get_all();
+}
+
+void hal_gpio_set_irq(uint pin, uint32_t events, hal_gpio_irq_t callback) {
+  gpio_set_irq_enabled_with_callback(pin, events, true, callback);
+}
+
+/*=====*/
+/* DMA */
+/*=====*/
+
+static void hal_dma_irq_handler(void) {
+  for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) {
+    if (dma_slots[ch].done != NULL && dma_channel_get_irq0_status(ch)) {
+      dma_channel_acknowledge_irq0(ch);
+      dma_slots[ch].done(dma_slots[ch].ctx);
+    }
+  }
+}
+
+// Registra done para o canal; a DMA_IRQ_0 é um handler compartilhado entre os fluxos
+static void hal_dma_set_done(int ch, hal_callback_t done, void *ctx) {
+  static bool handler_installed = false;
+  dma_slots[ch].done = done;
+  dma_slots[ch].ctx = ctx;
+  if (!handler_installed) {
+    irq_add_shared_handler(DMA_IRQ_0, hal_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+    handler_installed = true;
+  }
+  dma_channel_set_irq0_enabled(ch, done != NULL);
+}
+
+/*=====*/
+/* ADC */
+/*=====*/
+
+void hal_adc_init(void) {
+  adc_init();
+}
+
+void hal_adc_gpio_init(uint pin) {
+  adc_gpio_init(pin);
+}
+
+void hal_adc_select_input(uint channel) {
+  adc_select_input(channel);
+}
+
+uint16_t hal_adc_read(void) {
+  return adc_read();
+}
+
+// A contagem de transferências é a máxima (~37 h a 32 kS/s); ao esgotar, a IRQ a recarrega
+static void hal_adc_stream_restart(void *ctx) {
+  dma_channel_set_trans_count((uint)(uintptr_t)ctx, 0xFFFFFFFFu, true);
+}
+
+/**
+ * @brief Inicia o ADC em modo livre, em rodízio, com DMA circular para ring
+ * @return Identificador do fluxo (número do canal DMA)
+ * @note O canal 4 (sensor de temperatura) é habilitado se estiver na máscara
+ */
+int hal_adc_stream_start(uint32_t channel_mask, uint32_t sample_rate_hz, uint16_t *ring, size_t ring_len) {
+  uint channels = __builtin_popcount(channel_mask);
+  if (channel_mask & (1u << 4))
+    adc_set_temp_sensor_enabled(true);
+  adc_select_input(__builtin_ctz(channel_mask));
+  adc_set_round_robin(channel_mask);
+  adc_fifo_setup(true, true, 1, false, false);
+  // Cada conversão leva 96 ciclos de 48 MHz; clkdiv define o intervalo entre conversões
+  adc_set_clkdiv((float)clock_get_hz(clk_adc) / (sample_rate_hz * channels) - 1.0f);
+
+  int ch = dma_claim_unused_channel(true);
+  dma_slots[ch].ring = ring;
+  dma_channel_config c = dma_channel_get_default_config(ch);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+  channel_config_set_read_increment(&c, false);
+  channel_config_set_write_increment(&c, true);
+  channel_config_set_ring(&c, true, __builtin_ctz(ring_len * sizeof(uint16_t)));
+  channel_config_set_dreq(&c, DREQ_ADC);
+  dma_channel_configure(ch, &c, ring, &adc_hw->fifo, 0xFFFFFFFFu, true);
+  hal_dma_set_done(ch, hal_adc_stream_restart, (void *)(uintptr_t)ch);
+
+  adc_run(true);
+  return ch;
+}
+
+size_t hal_adc_stream_position(int stream) {
+  uintptr_t write = dma_channel_hw_addr(stream)->write_addr;
+  return (write - (uintptr_t)dma_slots[stream].ring) / sizeof(uint16_t);
+}
+
+/*=====*/
+/* PWM */
+/*=====*/
+
+void hal_pwm_init_pin(uint pin) {
+  gpio_set_function(pin, GPIO_FUNC_PWM);
+}
+
+void hal_pwm_configure(uint pin, float clkdiv, uint16_t wrap, uint16_t level) {
+  uint slice = pwm_gpio_to_slice_num(pin);
+  pwm_set_clkdiv(slice, clkdiv);
+  pwm_set_wrap(slice, wrap);
+  pwm_set_chan_level(slice, pwm_gpio_to_channel(pin), level);
+}
+
+void hal_pwm_enable(uint pin, bool enabled) {
+  pwm_set_enabled(pwm_gpio_to_slice_num(pin), enabled);
+}
+
+/*=====*/
+/* I2C */
+/*=====*/
+
+void hal_i2c_init(uint bus, uint baudrate, uint sda, uint scl) {
+  i2c_init(i2c_get_instance(bus), baudrate);
+  gpio_set_function(sda, GPIO_FUNC_I2C);
+  gpio_set_function(scl, GPIO_FUNC_I2C);
+  gpio_pull_up(sda);
+  gpio_pull_up(scl);
+}
+
+int hal_i2c_write(uint bus, uint8_t address, const uint8_t *src, size_t len, bool nostop) {
+  return i2c_write_blocking(i2c_get_instance(bus), address, src, len, nostop);
+}
+
+
+/**
+ * @brief Reserva um canal DMA que alimenta a FIFO de TX do I2C
+ * @return Identificador do fluxo (número do canal DMA)
+ * @note A DMA_IRQ_0 é registrada como handler compartilhado
+ */
+int hal_i2c_stream_claim(uint bus, hal_callback_t done, void *ctx) {
+  i2c_inst_t *i2c = i2c_get_instance(bus);
+
+  int ch = dma_claim_unused_channel(true);
+  dma_slots[ch].i2c = i2c;
+
+  dma_channel_config c = dma_channel_get_default_config(ch);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, i2c_get_dreq(i2c, true));
+  dma_channel_configure(ch, &c, &i2c_get_hw(i2c)->data_cmd, NULL, 0, false);
+  hal_dma_set_done(ch, done, ctx);
+  return ch;
+}
+
+void hal_i2c_stream_start(int stream, uint8_t address, const uint16_t *words, size_t count) {
+  i2c_hw_t *hw = i2c_get_hw(dma_slots[stream].i2c);
+  hw->enable = 0;
+  hw->tar = address;
+  hw->enable = 1;
+  dma_channel_transfer_from_buffer_now(stream, words, count);
+}
+
+// Ocupado enquanto o DMA corre ou ainda há bytes na FIFO/barramento; não depende da IRQ
+bool hal_i2c_stream_busy(int stream) {
+  i2c_hw_t *hw = i2c_get_hw(dma_slots[stream].i2c);
+  return dma_channel_is_busy(stream) ||
+         !(hw->status & I2C_IC_STATUS_TFE_BITS) ||
+         (hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS);
+}
+
+/*================*/
+/* UART e stdio   */
+/*================*/
+
+void hal_stdio_init(void) {
+  stdio_init_all();
+}
+
+// Lê só o driver USB: a UART fica fora do stdio (ver CMakeLists.txt) e é
+// recebida pela interrupção de hal_uart_set_rx_irq, com origem própria
+int hal_stdio_getchar(uint32_t timeout_us) {
+  uint64_t until = time_us_64() + timeout_us;
+  char c;
+  do {
+    if (stdio_usb.in_chars(&c, 1) == 1)
+      return (uint8_t)c;
+  } while (time_us_64() < until);
+  return HAL_NO_CHAR;
+}
+
+void hal_uart_init(uint uart, uint baudrate, uint tx_pin, uint rx_pin) {
+  uart_inst_t *inst = uart_get_instance(uart);
+  uart_init(inst, baudrate);
+  gpio_set_function(tx_pin, GPIO_FUNC_UART);
+  gpio_set_function(rx_pin, GPIO_FUNC_UART);
+  uart_set_format(inst, 8, 1, UART_PARITY_NONE);
+  uart_set_fifo_enabled(inst, true);
+}
+
+bool hal_uart_readable(uint uart) {
+  return uart_is_readable(uart_get_instance(uart));
+}
+
+char hal_uart_getc(uint uart) {
+  return uart_getc(uart_get_instance(uart));
+}
+
+void hal_uart_putc(uint uart, char c) {
+  uart_putc(uart_get_instance(uart), c);
+}
+
+static hal_callback_t uart_rx_handler[NUM_UARTS];
+static void *uart_rx_ctx[NUM_UARTS];
+
+static void hal_uart0_irq(void) {
+  uart_rx_handler[0](uart_rx_ctx[0]);
+}
+
+static void hal_uart1_irq(void) {
+  uart_rx_handler[1](uart_rx_ctx[1]);
+}
+
+void hal_uart_set_rx_irq(uint uart, hal_callback_t handler, void *ctx) {
+  uint irq = uart == 0 ? UART0_IRQ : UART1_IRQ;
+  uart_rx_handler[uart] = handler;
+  uart_rx_ctx[uart] = ctx;
+  irq_set_exclusive_handler(irq, uart == 0 ? hal_uart0_irq : hal_uart1_irq);
+  irq_set_enabled(irq, true);
+  // Interrupção por nível da FIFO ou por tempo ocioso com dados na FIFO
+  uart_set_irq_enables(uart_get_instance(uart), true, false);
+}
+
+void hal_uart_rx_irq_enable(uint uart, bool enable) {
+  uart_set_irq_enables(uart_get_instance(uart), enable, false);
+}
+
+// Com só a USB no stdio, o aviso de caracteres disponíveis vem apenas dela
+void hal_stdio_set_rx_callback(hal_callback_t handler, void *ctx) {
+  stdio_set_chars_available_callback(handler, ctx);
+}
+
+int hal_uart_stream_claim(uint uart) {
+  uart_inst_t *inst = uart_get_instance(uart);
+  int ch = dma_claim_unused_channel(true);
+
+  dma_channel_config c = dma_channel_get_default_config(ch);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, uart_get_dreq(inst, true));
+  dma_channel_configure(ch, &c, &uart_get_hw(inst)->dr, NULL, 0, false);
+  return ch;
+}
+
+void hal_uart_stream_start(int stream, const uint8_t *data, size_t len) {
+  dma_channel_transfer_from_buffer_now(stream, data, len);
+}
+
+bool hal_uart_stream_busy(int stream) {
+  return dma_channel_is_busy(stream);
+}
+
+/*=================*/
+/* Matriz WS2812   */
+/*=================*/
+
+void hal_matrix_init(hal_pio_t pio, uint sm, uint pin) {
+  PIO inst = pio_get_instance(pio);
+  uint offset = pio_add_program(inst, &pio_matrix_program);
+  pio_matrix_program_init(inst, sm, offset, pin);
+}
+
+/**
+ * @brief Reserva um canal DMA que alimenta a FIFO de TX da state machine da matriz
+ * @return Identificador do fluxo (número do canal DMA)
+ */
+int hal_matrix_stream_claim(hal_pio_t pio, uint sm) {
+  PIO inst = pio_get_instance(pio);
+  int ch = dma_claim_unused_channel(true);
+
+  dma_channel_config c = dma_channel_get_default_config(ch);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, pio_get_dreq(inst, sm, true));
+  dma_channel_configure(ch, &c, &inst->txf[sm], NULL, 0, false);
+  return ch;
+}
+
+void hal_matrix_stream_start(int stream, const uint32_t *words, size_t count) {
+  dma_channel_transfer_from_buffer_now(stream, words, count);
+}
+
+// Só indica o fim do DMA; as últimas palavras ainda podem estar na FIFO da PIO
+bool hal_matrix_stream_busy(int stream) {
+  return dma_channel_is_busy(stream);
+}
+
+/*=================*/
+/* Teclado 4x4     */
+/*=================*/
+
+static void hal_keypad_irq(void) {
+  keypad_handler(keypad_ctx);
+}
+
+void hal_keypad_init(hal_pio_t pio, uint sm, hal_callback_t on_change, void *ctx) {
+  keypad_pio = pio_get_instance(pio);
+  keypad_sm = sm;
+  keypad_handler = on_change;
+  keypad_ctx = ctx;
+  uint offset = pio_add_program(keypad_pio, &keypad_scan_program);
+  keypad_scan_program_init(keypad_pio, sm, offset);
+
+  // FIFO RX não vazia dispara a IRQ 0 do bloco
+  uint irq = pio == HAL_PIO0 ? PIO0_IRQ_0 : PIO1_IRQ_0;
+  pio_set_irq0_source_enabled(keypad_pio, (enum pio_interrupt_source)(pis_sm0_rx_fifo_not_empty + sm), true);
+  irq_set_exclusive_handler(irq, hal_keypad_irq);
+  irq_set_enabled(irq, true);
+}
+
+bool hal_keypad_read(uint16_t *closed) {
+  if (pio_sm_is_rx_fifo_empty(keypad_pio, keypad_sm))
+    return false;
+  // A PIO entrega a linha 0 nos bits 15..12 e 1 para contato aberto
+  uint32_t raw = ~pio_sm_get(keypad_pio, keypad_sm);
+  uint16_t keys = 0;
+  for (uint row = 0; row < HAL_KEYPAD_ROWS; ++row)
+    keys |= (uint16_t)(((raw >> ((HAL_KEYPAD_ROWS - 1 - row) * HAL_KEYPAD_COLS)) & 0xF) << (row * HAL_KEYPAD_COLS));
+  *closed = keys;
+  return true;
+}
+
+/*=================*/
+/* Leitor de íris  */
+/*=================*/
+
+// A placa não tem sensor de íris: a leitura segue simulada pelo botão
+bool hal_iris_capture(uint32_t *code, uint32_t *mask) {
+  (void)code;
+  (void)mask;
+  return false;
+}
@@ -1,177 +1,354 @@
 #include "Led_Matrix.h"
-#include "hardware/pio.h"
-#include "pico/stdlib.h"
-#include "led_matrix.pio.h"
-#include "hardware/clocks.h"
 #include "src/display.h"
 #include "buttons.h"
+#include "src/scheduler.h"
+#include "src/ui.h"
+#include "src/iris_match.h"
 #include <stdio.h>
+#include <string.h>
 
 // Definições de pinos
 #define MATRIX_WS2812_PIN     7     // Pino de controle da matriz 5x5
 
+// Tempo de envio de um quadro (24 bits a 800 kHz por LED) e pausa de reset
+#define MATRIX_FRAME_US (MATRIX_LEDS * 30)
+#define MATRIX_RESET_US 300     // WS2812B exige ao menos 280 us em nível baixo
+
+// Nível enviado ao LED para uma intensidade 0-255: gama 2,0 e brilho máximo
+#define MATRIX_LEVEL(v) (((v) * (v) * MATRIX_BRIGHTNESS + 255 * 255 / 2) / (255 * 255))
+#define MATRIX_LEVEL4(n)  MATRIX_LEVEL(n), MATRIX_LEVEL(n + 1), MATRIX_LEVEL(n + 2), MATRIX_LEVEL(n + 3)
+#define MATRIX_LEVEL16(n) MATRIX_LEVEL4(n), MATRIX_LEVEL4(n + 4), MATRIX_LEVEL4(n + 8), MATRIX_LEVEL4(n + 12)
+#define MATRIX_LEVEL64(n) MATRIX_LEVEL16(n), MATRIX_LEVEL16(n + 16), MATRIX_LEVEL16(n + 32), MATRIX_LEVEL16(n + 48)
+
+// Tabela de gama e brilho calculada em tempo de compilação
+static const uint8_t matrix_level[256] = {
+    MATRIX_LEVEL64(0), MATRIX_LEVEL64(64), MATRIX_LEVEL64(128), MATRIX_LEVEL64(192)
+};
+
 bool scan_problem;
 
+// Envio por DMA: um buffer em transmissão e outro para o próximo quadro
+static int matrix_stream;
+static uint32_t matrix_dma_frames[2][MATRIX_LEDS];
+static uint8_t matrix_dma_next;
+static uint64_t matrix_ready_us;    // Fim do quadro em envio mais a pausa de reset
+
 /**
- * @brief Inicializa a matriz LED usando PIO
+ * @brief Inicializa a matriz LED usando PIO e reserva o canal DMA de envio
  * @param pio Instância PIO a ser utilizada
  * @param sm State machine a ser configurada
  */
-void init_matrix(PIO pio, uint sm) {
-    // Carrega o programa PIO na memória do PIO
-    uint offset = pio_add_program(pio, &pio_matrix_program);
-    // Inicializa o programa PIO para controle da matriz LED
-    pio_matrix_program_init(pio, sm, offset, MATRIX_WS2812_PIN);
+void init_matrix(hal_pio_t pio, uint sm) {
+    // Carrega e inicializa o programa PIO de controle da matriz LED
+    hal_matrix_init(pio, sm, MATRIX_WS2812_PIN);
+    matrix_stream = hal_matrix_stream_claim(pio, sm);
+    matrix_ready_us = 0;
 }
 
 /**
- * @brief Rotina para definição da intensidade de cores do LED
- * @param b Intensidade do azul (0.0 a 1.0)
- * @param r Intensidade do vermelho (0.0 a 1.0)
- * @param g Intensidade do verde (0.0 a 1.0)
- * @return Valor de cor formatado em uint32_t
+ * @brief Converte uma cor RGB (0 a 255 por canal) na palavra GRB da matriz
+ * @return Valor de cor com gama e brilho aplicados pela tabela matrix_level
  */
+uint32_t matrix_rgb(uint8_t r, uint8_t g, uint8_t b) {
+    return ((uint32_t)matrix_level[g] << 24) |
+           ((uint32_t)matrix_level[r] << 16) |
+           ((uint32_t)matrix_level[b] << 8);
+}
 
-uint32_t matrix_rgb(double r, double g, double b) {
-    unsigned char R = r * 255;
-    unsigned char G = g * 255;
-    unsigned char B = b * 255;
-    return (G << 24) | (R << 16) | (B << 8);
+/**
+ * @brief Envia um quadro para a matriz sem esperar a transmissão
+ * @param frame 25 cores GRB (ver matrix_rgb); o conteúdo é copiado
+ * @note O quadro é entregue ao núcleo 1, que o transmite por DMA
+ */
+void matrix_submit(const uint32_t *frame) {
+    ui_matrix(frame);
 }
 
 /**
  * @brief Apaga todos os LEDs da matriz.
- * @param pio Instância do PIO utilizada.
- * @param sm Número da state machine.
- * @details Envia o valor 0 para cada um dos 25 LEDs da matriz, desligando-os.
+ * @details Envia um quadro com o valor 0 para cada um dos 25 LEDs, desligando-os.
  */
-void clear_led_matrix(PIO pio, uint sm) {
-    for (int i = 0; i < 25; i++) {
-        pio_sm_put_blocking(pio, sm, 0); // Envia 0 para desligar o LED
-    }
+void clear_led_matrix(void) {
+    static const uint32_t off[MATRIX_LEDS] = {0}; // 0 desliga o LED
+    matrix_submit(off);
+}
+
+bool matrix_busy(void) {
+    return hal_matrix_stream_busy(matrix_stream) || hal_time_us_64() < matrix_ready_us;
 }
 
 /**
- * @brief Simula processo de leitura de íris com feedback visual
- * @param pio Instância PIO para controle da matriz
- * @param sm State machine da matriz
- * @param button_b Pino do botão para simulação de erro
- * @note Exibe padrão colorido por 3s e verifica interrupção
+ * @brief Inicia a transmissão por DMA de um quadro para a FIFO da state machine
+ * @note Executa no núcleo 1. Só espera se o quadro anterior ainda estiver em
+ *       envio ou na pausa de reset (no máximo ~1 ms); quadros de animação
+ *       chegam com dezenas de milissegundos de intervalo
  */
-void iris_scan(PIO pio, uint sm, uint button_b) {
-    display_message("FAZENDO A", "LEITURA", "DA IRIS");
-    // Frame do olho (padrão 5x5)
-    const uint8_t eye_frame[25] = {
-        0, 1, 1, 1, 0,
-        1, 0, 0, 0, 1,
-        1, 0, 1, 0, 1,
-        1, 0, 0, 0, 1,
-        0, 1, 1, 1, 0
-    };
-
-    // Converte cores para valores RGB
-    uint32_t red   = matrix_rgb(1.0, 0.0, 0.0);
-    uint32_t green = matrix_rgb(0.0, 1.0, 0.0);
-    uint32_t blue  = matrix_rgb(0.0, 0.0, 1.0);
-    uint32_t black = matrix_rgb(0.0, 0.0, 0.0);
+void matrix_draw(const uint32_t *frame) {
+    uint32_t *buffer = matrix_dma_frames[matrix_dma_next];
+    memcpy(buffer, frame, sizeof(matrix_dma_frames[0]));
 
-    // Exibe o frame azul (padrão) de uma só vez
-    for (int i = 0; i < 25; i++) {
-        uint32_t color = eye_frame[i] ? blue : black;
-        pio_sm_put_blocking(pio, sm, color);
+    while (matrix_busy()) {
+        hal_busy_wait_us(10);
     }
-    busy_wait_ms(3000);  // Permite visualizar o frame completo
-
-    // Aguarda por 3 segundos verificando se o botão B é pressionado
-    bool error = false;
-    uint32_t start = to_ms_since_boot(get_absolute_time());
-    while (to_ms_since_boot(get_absolute_time()) - start < 3000) {
-        if (gpio_get(button_b) == 0) { // Se B for pressionado, erro na leitura
-            error = true;
-            break;
+    hal_matrix_stream_start(matrix_stream, buffer, MATRIX_LEDS);
+    matrix_ready_us = hal_time_us_64() + MATRIX_FRAME_US + MATRIX_RESET_US;
+    matrix_dma_next ^= 1;
+}
+
+// Frame do olho (padrão 5x5)
+static const uint8_t eye_frame[25] = {
+    0, 1, 1, 1, 0,
+    1, 0, 0, 0, 1,
+    1, 0, 1, 0, 1,
+    1, 0, 0, 0, 1,
+    0, 1, 1, 1, 0
+};
+
+// Estados das varreduras de íris, executadas como passos do escalonador
+typedef enum {
+    IRIS_IDLE,
+    IRIS_SHOW,      // Frame azul exibido, aguardando antes de amostrar o botão
+    IRIS_SAMPLE,    // Verifica o botão a cada 50 ms por até 3 s
+    IRIS_RESULT,    // Resultado exibido, aguardando para apagar a matriz
+    IRIS_TEST_COLOR,
+    IRIS_TEST_DONE
+} iris_state_t;
+
+static struct {
+    iris_state_t state;
+    uint button;
+    uint64_t start_us;
+    bool error;
+    uint8_t color_index;
+    uint8_t generation;     // Passos agendados antes de iris_cancel() são descartados
+    iris_done_t done;
+} iris;
+
+// Galeria de modelos cadastrados, em RAM (512 bytes por modelo)
+#ifndef IRIS_GALLERY_MAX
+#define IRIS_GALLERY_MAX 32
+#endif
+
+static iris_code_t iris_gallery[IRIS_GALLERY_MAX];
+static uint8_t iris_gallery_count;
+static bool iris_enroll_armed;
+static iris_code_t iris_capture;
+static iris_probe_t iris_probe;     // Rotações da captura (8,7 KB)
+
+static void iris_step(void *ctx);
+
+/**
+ * @brief Compara a captura do sensor com a galeria, ou a cadastra
+ * @return true se reconhecida ou cadastrada
+ * @note Só cadastra depois de "iris enroll <senha admin>"; com a galeria
+ *       vazia a captura é sempre recusada
+ */
+static bool iris_match_capture(void) {
+    if (iris_enroll_armed) {
+        iris_enroll_armed = false;
+        if (iris_gallery_count == IRIS_GALLERY_MAX) {
+            printf("Galeria de íris cheia (%u modelos)\n", IRIS_GALLERY_MAX);
+            return false;
         }
-        busy_wait_ms(50);
+        iris_gallery[iris_gallery_count++] = iris_capture;
+        printf("Íris cadastrada: modelo %u\n", iris_gallery_count - 1);
+        return true;
+    }
+    if (iris_gallery_count == 0) {
+        printf("Nenhuma íris cadastrada (use iris enroll)\n");
+        return false;
     }
 
-    if (error) {
-        // Exibe o frame em vermelho indicando erro na leitura do iris
-        for (int i = 0; i < 25; i++) {
-            uint32_t color = eye_frame[i] ? red : black;
-            pio_sm_put_blocking(pio, sm, color);
-        }
-        printf("Acesso negado!\n");
-        display_message("IRIS", "NAO", "RECONHECIDA");
-        busy_wait_ms(2000);
-    } else {
-        // Exibe o frame em verde indicando acesso concedido
-        for (int i = 0; i < 25; i++) {
-            uint32_t color = eye_frame[i] ? green : black;
-            pio_sm_put_blocking(pio, sm, color);
-        }
-        printf("Acesso concedido!\n");
-        display_message("IRIS", "", "RECONHECIDA");
-        busy_wait_ms(2000);
+    uint32_t start_us = hal_time_us_32();
+    iris_probe_prepare(&iris_capture, &iris_probe);
+    iris_match_t best;
+    bool found = iris_search(&iris_probe, iris_gallery, iris_gallery_count, IRIS_ACCEPT_HD, &best);
+    uint32_t elapsed_us = hal_time_us_32() - start_us;
+    if (found) {
+        printf("Íris: modelo %ld, distância %lu/1000, rotação %d\n", (long)best.index,
+               (unsigned long)((best.hd * 1000u) >> 16), best.shift);
+    }
+    printf("Busca de íris: %u modelos, %lu palavras, %lu us\n", iris_gallery_count,
+           (unsigned long)best.words, (unsigned long)elapsed_us);
+    return found;
+}
+
+static void iris_put_frame(uint32_t on_color) {
+    uint32_t frame[MATRIX_LEDS];
+    for (int i = 0; i < MATRIX_LEDS; i++) {
+        frame[i] = eye_frame[i] ? on_color : 0;
+    }
+    matrix_submit(frame);
+}
+
+static void iris_put_test_color(void) {
+    uint8_t r = (iris.color_index / 9) * 127;
+    uint8_t g = ((iris.color_index / 3) % 3) * 127;
+    uint8_t b = (iris.color_index % 3) * 127;
+    uint32_t color = matrix_rgb(r, g, b);
+    uint32_t frame[MATRIX_LEDS];
+    for (int i = 0; i < MATRIX_LEDS; i++) {
+        frame[i] = color;
+    }
+    matrix_submit(frame);
+}
+
+static void iris_next(iris_state_t state, uint32_t delay_ms) {
+    iris.state = state;
+    sched_post(iris_step, (void *)(uintptr_t)iris.generation, delay_ms);
+}
+
+// Entrega o resultado uma única vez
+static void iris_report(bool ok) {
+    iris_done_t done = iris.done;
+    iris.done = NULL;
+    if (done != NULL) {
+        done(ok);
+    }
+}
+
+static void iris_finish(bool ok) {
+    clear_led_matrix();
+    iris.state = IRIS_IDLE;
+    iris_report(ok);
+}
+
+static void iris_step(void *ctx) {
+    if ((uintptr_t)ctx != iris.generation) {
+        return;
+    }
+    switch (iris.state) {
+        case IRIS_SHOW:
+            iris.start_us = hal_time_us_64();
+            iris.error = false;
+            iris.state = IRIS_SAMPLE;
+            // fall through
+        case IRIS_SAMPLE:
+            if (hal_gpio_get(iris.button) == 0) { // Se B for pressionado, erro na leitura
+                iris.error = true;
+            } else if (hal_time_us_64() - iris.start_us < 3000000) {
+                iris_next(IRIS_SAMPLE, 50);
+                break;
+            }
+            // Sem sensor (placa) a leitura segue decidida pelo botão
+            if (!iris.error && hal_iris_capture(iris_capture.code, iris_capture.mask)) {
+                iris.error = !iris_match_capture();
+            }
+            if (iris.error) {
+                // Exibe o frame em vermelho indicando erro na leitura do iris
+                iris_put_frame(matrix_rgb(255, 0, 0));
+                printf("Íris não reconhecida.\n");
+                display_message("IRIS", "NAO", "RECONHECIDA");
+            } else {
+                // Exibe o frame em verde indicando acesso concedido
+                iris_put_frame(matrix_rgb(0, 255, 0));
+                printf("Íris reconhecida.\n");
+                display_message("IRIS", "", "RECONHECIDA");
+            }
+            // O resultado sai já na decisão; a matriz segue com ele por 2 s
+            iris_next(IRIS_RESULT, 2000);
+            iris_report(!iris.error);
+            break;
+        case IRIS_RESULT:
+            iris_finish(!iris.error);
+            break;
+        case IRIS_TEST_COLOR:
+            // Verifica se já passou o tempo de 3 segundos
+            if (hal_time_us_64() - iris.start_us > 3000000) {
+                printf("Teste concluído em 3 segundos.\n");
+                display_message("LEITOR","", "FUNCIONANDO");
+                iris_next(IRIS_TEST_DONE, 500);
+                break;
+            }
+            // Verifica se o botão do joystick foi pressionado
+            if (hal_gpio_get(iris.button) == 0) {
+                printf("Problema detectado no scan! Botão pressionado.\n");
+                scan_problem = true;
+                iris_finish(false);
+                break;
+            }
+            if (++iris.color_index >= 27) {
+                display_off();
+                iris_finish(true);
+                break;
+            }
+            iris_put_test_color();
+            iris_next(IRIS_TEST_COLOR, 250);
+            break;
+        case IRIS_TEST_DONE:
+            iris_finish(!scan_problem);
+            break;
+        default:
+            break;
     }
-    clear_led_matrix(pio, sm);
+}
+
+/**
+ * @brief Simula processo de leitura de íris com feedback visual
+ * @param button_b Pino do botão para simulação de erro
+ * @param done Chamada com o resultado assim que a leitura termina (pode ser NULL)
+ * @note Não bloqueia: exibe o olho por 3s, verifica o botão por até 3s e
+ *       mantém o resultado por 2s, tudo em passos do escalonador; done é
+ *       chamada no início desses 2s
+ */
+void iris_scan(uint button_b, iris_done_t done) {
+    display_message("FAZENDO A", "LEITURA", "DA IRIS");
+    iris.button = button_b;
+    iris.done = done;
+
+    // Exibe o frame azul (padrão) de uma só vez
+    iris_put_frame(matrix_rgb(0, 0, 255));
+    iris_next(IRIS_SHOW, 3000);  // Permite visualizar o frame completo
 }
 
 /**
  * @brief Teste completo do sistema de leitura de íris
- * @param pio Instância PIO para controle
- * @param sm State machine da matriz
  * @param joystick_button_pin Pino para detecção de falhas
- * @note Cicla cores por 3s ou até detecção de pressionamento
+ * @param done Chamada ao final do teste (pode ser NULL)
+ * @note Cicla cores a cada 250ms por 3s ou até detecção de pressionamento
  */
-void iris_scan_test(PIO pio, uint sm, uint joystick_button_pin) {
+void iris_scan_test(uint joystick_button_pin, iris_done_t done) {
     printf("Iniciando teste de varredura...\n");
     display_message("TESTANDO", "LEITOR DE", "IRIS");
-
-    absolute_time_t start_time = get_absolute_time(); // Marca o tempo inicial
+    iris.button = joystick_button_pin;
+    iris.done = done;
+    iris.start_us = hal_time_us_64(); // Marca o tempo inicial
+    iris.color_index = 0;
 
     // Resetando a flag de problema do scan no início do teste
     scan_problem = false;
 
-    for (int r = 0; r <= 255; r += 127) {  // Reduzindo o brilho pela metade
-        for (int g = 0; g <= 255; g += 127) {  
-            for (int b = 0; b <= 255; b += 127) {  
-                uint32_t color = matrix_rgb(r / 255.0, g / 255.0, b / 255.0);
-
-                for (int row = 0; row < 5; row++) {
-                    for (int col = 0; col < 5; col++) {
-                        pio_sm_put_blocking(pio, sm, color);
-                    }
-                }
-
-                busy_wait_ms(250);
-
-                // Verifica se já passou o tempo de 3 segundos
-                if (absolute_time_diff_us(start_time, get_absolute_time()) > 3000000) {
-                    printf("Teste concluído em 3 segundos.\n");
-                    display_message("LEITOR","", "FUNCIONANDO");
-                    busy_wait_ms(500);
-                    clear_led_matrix(pio, sm); // Desliga todos os LEDs ao final do teste
-                    return; // Quebra o loop de cores e vai para o final
-                }
-
-                // Verifica se o botão do joystick foi pressionado
-                if (gpio_get(joystick_button_pin) == 0) {
-                    printf("Problema detectado no scan! Botão pressionado.\n");
-                    scan_problem = true;  // Define a flag de problema
-                    clear_led_matrix(pio, sm); // Desliga todos os LEDs ao final do teste
-                    return;  // Sai do loop de teste imediatamente
-                }
-            }
-        }
-    }
+    iris_put_test_color();
+    iris_next(IRIS_TEST_COLOR, 250);
+}
 
-    if (scan_problem) {
-        // Mensagem indicando o problema no scan
-        display_message("PROBLEMA", "NO LEITOR", "DETECTADO");
+/**
+ * @brief Interrompe a leitura ou o teste em andamento sem chamar done
+ */
+void iris_cancel(void) {
+    if (iris.state == IRIS_IDLE) {
+        return;
     }
-    display_off();
-    clear_led_matrix(pio, sm); // Desliga todos os LEDs ao final do teste
+    iris.generation++;
+    iris.state = IRIS_IDLE;
+    iris.done = NULL;
+    clear_led_matrix();
 }
 
+bool iris_busy(void) {
+    return iris.state != IRIS_IDLE;
+}
+
+/**
+ * @brief Cadastra na galeria a próxima captura de íris, em vez de compará-la
+ */
+void iris_enroll_next(void) {
+    iris_enroll_armed = true;
+}
+
+uint8_t iris_gallery_size(void) {
+    return iris_gallery_count;
+}
 
 /**
  * @brief Obtém status de problemas no scanner de íris
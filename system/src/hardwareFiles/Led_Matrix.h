@@ -1,23 +1,49 @@
 #ifndef LED_MATRIX_H
 #define LED_MATRIX_H
 
-#include "pico/stdlib.h"
-#include "hardware/pio.h"
-#include "hardware/clocks.h"
+#include "src/hal/hal.h"
+
+#define MATRIX_LEDS 25          // Matriz 5x5
+
+// Brilho máximo (0 a 255), aplicado na tabela de gama em tempo de compilação
+#ifndef MATRIX_BRIGHTNESS
+#define MATRIX_BRIGHTNESS 255
+#endif
+
+// Chamada ao final de uma varredura de íris com o resultado
+typedef void (*iris_done_t)(bool ok);
 
 // Atualiza a matriz com um número específico
-void update_led_matrix(uint8_t number, PIO pio, uint sm);
+void update_led_matrix(uint8_t number, hal_pio_t pio, uint sm);
 
 // Apaga todos os LEDs da matriz
-void clear_led_matrix(PIO pio, uint sm);
+void clear_led_matrix(void);
+
+// Enfileira um quadro de 25 cores GRB para a matriz, sem bloquear
+void matrix_submit(const uint32_t *frame);
+
+// Transmite o quadro por DMA (executa no núcleo 1)
+void matrix_draw(const uint32_t *frame);
+
+bool matrix_busy(void);
+
+uint32_t matrix_rgb(uint8_t r, uint8_t g, uint8_t b);
+
+void init_matrix(hal_pio_t pio, uint sm);
+
+void iris_scan_test(uint joystick_button_pin, iris_done_t done);
+
+void iris_scan(uint button_b, iris_done_t done);
 
-uint32_t matrix_rgb(double r, double g, double b);
+// Interrompe a leitura em andamento (done não é chamada)
+void iris_cancel(void);
 
-void init_matrix(PIO pio, uint sm);
+bool iris_busy(void);
 
-void iris_scan_test(PIO pio, uint sm, uint joystick_button_pin);
+// Próxima captura entra na galeria em vez de ser comparada
+void iris_enroll_next(void);
 
-void iris_scan(PIO pio, uint sm, uint button_b);
+uint8_t iris_gallery_size(void);
 
 bool get_scan_problem(void);
 
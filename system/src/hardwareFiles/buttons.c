@@ -2,18 +2,12 @@
 
 void init_buttons(void) {
     // Configura o botão A como entrada com resistor de pull-up
-    gpio_init(BUTTON_A);
-    gpio_set_dir(BUTTON_A, GPIO_IN);
-    gpio_pull_up(BUTTON_A);
+    hal_gpio_init_input_pullup(BUTTON_A);
 
     // Configura o botão do joystick como entrada com resistor de pull-up
-    gpio_init(JOYSTICK_BTN);
-    gpio_set_dir(JOYSTICK_BTN, GPIO_IN);
-    gpio_pull_up(JOYSTICK_BTN);
+    hal_gpio_init_input_pullup(JOYSTICK_BTN);
 
     // Configura o botão B como entrada com resistor de pull-up
-    gpio_init(BUTTON_B);
-    gpio_set_dir(BUTTON_B, GPIO_IN);
-    gpio_pull_up(BUTTON_B);
+    hal_gpio_init_input_pullup(BUTTON_B);
 
 }
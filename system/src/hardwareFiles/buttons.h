@@ -1,7 +1,7 @@
 #ifndef BUTTONS_H
 #define BUTTONS_H
 
-#include "pico/stdlib.h"
+#include "src/hal/hal.h"
 
 // Define os pinos dos botões
 #define BUTTON_A      5
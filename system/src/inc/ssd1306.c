@@ -1,51 +1,100 @@
 
 #include "ssd1306.h"
 #include "font.h"
+#include "src/trace.h"
+#include <string.h>
 
-void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
+// Comandos de janela (byte de controle + 6 comandos) que precedem os dados no quadro DMA
+#define SSD1306_WINDOW_WORDS 7
+
+// Marca o retângulo sujo como vazio
+static inline void ssd1306_clear_dirty(ssd1306_t *ssd) {
+  ssd->dirty_x0 = 0xFF;
+  ssd->dirty_x1 = 0;
+  ssd->dirty_p0 = 0xFF;
+  ssd->dirty_p1 = 0;
+}
+
+// Expande o retângulo sujo para incluir a coluna x da página indicada
+static inline void ssd1306_mark_dirty(ssd1306_t *ssd, uint8_t x, uint8_t page) {
+  if (x < ssd->dirty_x0) ssd->dirty_x0 = x;
+  if (x > ssd->dirty_x1) ssd->dirty_x1 = x;
+  if (page < ssd->dirty_p0) ssd->dirty_p0 = page;
+  if (page > ssd->dirty_p1) ssd->dirty_p1 = page;
+}
+
+// Acrescenta ao lote a janela de endereçamento (colunas x0..x1, páginas p0..p1) da próxima escrita de dados
+static void ssd1306_cmd_window(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  ssd1306_cmd_add(ssd, SET_COL_ADDR);
+  ssd1306_cmd_add(ssd, x0);
+  ssd1306_cmd_add(ssd, x1);
+  ssd1306_cmd_add(ssd, SET_PAGE_ADDR);
+  ssd1306_cmd_add(ssd, p0);
+  ssd1306_cmd_add(ssd, p1);
+}
+
+// Conclusão do fluxo I2C assíncrono (contexto de IRQ)
+static void ssd1306_stream_done(void *ctx) {
+  ssd1306_t *ssd = ctx;
+  TRACE_ASYNC_END(OLED_FLUSH, 0);
+  if (ssd->flush_done != NULL)
+    ssd->flush_done();
+}
+
+void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, uint i2c_bus) {
   ssd->width = width;
   ssd->height = height;
   ssd->pages = height / 8U;
   ssd->address = address;
-  ssd->i2c_port = i2c;
+  ssd->i2c_bus = i2c_bus;
   ssd->bufsize = ssd->pages * ssd->width + 1;
   ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->cmd_buffer[0] = 0x00;
+  ssd->cmd_len = 1;
+  ssd->sent_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->dma_buffer = calloc(ssd->bufsize + SSD1306_WINDOW_WORDS, sizeof(uint16_t));
+  ssd->flush_done = NULL;
+  ssd1306_clear_dirty(ssd);
+  ssd->stream = hal_i2c_stream_claim(i2c_bus, ssd1306_stream_done, ssd);
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_DISP | 0x00);
-  ssd1306_command(ssd, SET_MEM_ADDR);
-  ssd1306_command(ssd, 0x01);
-  ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
-  ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
-  ssd1306_command(ssd, SET_MUX_RATIO);
-  ssd1306_command(ssd, HEIGHT - 1);
-  ssd1306_command(ssd, SET_COM_OUT_DIR | 0x08);
-  ssd1306_command(ssd, SET_DISP_OFFSET);
-  ssd1306_command(ssd, 0x00);
-  ssd1306_command(ssd, SET_COM_PIN_CFG);
-  ssd1306_command(ssd, 0x12);
-  ssd1306_command(ssd, SET_DISP_CLK_DIV);
-  ssd1306_command(ssd, 0x80);
-  ssd1306_command(ssd, SET_PRECHARGE);
-  ssd1306_command(ssd, 0xF1);
-  ssd1306_command(ssd, SET_VCOM_DESEL);
-  ssd1306_command(ssd, 0x30);
-  ssd1306_command(ssd, SET_CONTRAST);
-  ssd1306_command(ssd, 0xFF);
-  ssd1306_command(ssd, SET_ENTIRE_ON);
-  ssd1306_command(ssd, SET_NORM_INV);
-  ssd1306_command(ssd, SET_CHARGE_PUMP);
-  ssd1306_command(ssd, 0x14);
-  ssd1306_command(ssd, SET_DISP | 0x01);
+  ssd1306_cmd_begin(ssd);
+  ssd1306_cmd_add(ssd, SET_DISP | 0x00);
+  ssd1306_cmd_add(ssd, SET_MEM_ADDR);
+  ssd1306_cmd_add(ssd, 0x01);
+  ssd1306_cmd_add(ssd, SET_DISP_START_LINE | 0x00);
+  ssd1306_cmd_add(ssd, SET_SEG_REMAP | 0x01);
+  ssd1306_cmd_add(ssd, SET_MUX_RATIO);
+  ssd1306_cmd_add(ssd, HEIGHT - 1);
+  ssd1306_cmd_add(ssd, SET_COM_OUT_DIR | 0x08);
+  ssd1306_cmd_add(ssd, SET_DISP_OFFSET);
+  ssd1306_cmd_add(ssd, 0x00);
+  ssd1306_cmd_add(ssd, SET_COM_PIN_CFG);
+  ssd1306_cmd_add(ssd, 0x12);
+  ssd1306_cmd_add(ssd, SET_DISP_CLK_DIV);
+  ssd1306_cmd_add(ssd, 0x80);
+  ssd1306_cmd_add(ssd, SET_PRECHARGE);
+  ssd1306_cmd_add(ssd, 0xF1);
+  ssd1306_cmd_add(ssd, SET_VCOM_DESEL);
+  ssd1306_cmd_add(ssd, 0x30);
+  ssd1306_cmd_add(ssd, SET_CONTRAST);
+  ssd1306_cmd_add(ssd, 0xFF);
+  ssd1306_cmd_add(ssd, SET_ENTIRE_ON);
+  ssd1306_cmd_add(ssd, SET_NORM_INV);
+  ssd1306_cmd_add(ssd, SET_CHARGE_PUMP);
+  ssd1306_cmd_add(ssd, 0x14);
+  ssd1306_cmd_add(ssd, SET_DISP | 0x01);
+  ssd1306_cmd_send(ssd);
 }
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+  ssd1306_wait(ssd);
   ssd->port_buffer[1] = command;
-  i2c_write_blocking(
-    ssd->i2c_port,
+  hal_i2c_write(
+    ssd->i2c_bus,
     ssd->address,
     ssd->port_buffer,
     2,
@@ -53,66 +102,223 @@ void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   );
 }
 
+// Descarta comandos pendentes e inicia um novo lote
+void ssd1306_cmd_begin(ssd1306_t *ssd) {
+  ssd->cmd_len = 1;
+}
+
+// Acumula um comando no lote; se o lote encher, ele é enviado e um novo é iniciado
+void ssd1306_cmd_add(ssd1306_t *ssd, uint8_t command) {
+  if (ssd->cmd_len > SSD1306_CMD_BATCH_MAX)
+    ssd1306_cmd_send(ssd);
+  ssd->cmd_buffer[ssd->cmd_len++] = command;
+}
+
+/**
+ * @brief Envia todos os comandos acumulados em uma única transação I2C
+ * @note Um único byte de controle 0x00 (Co = 0) precede a sequência, evitando
+ *       start/endereço/stop por comando
+ */
+void ssd1306_cmd_send(ssd1306_t *ssd) {
+  if (ssd->cmd_len <= 1)
+    return;
+  ssd1306_wait(ssd);
+  hal_i2c_write(
+    ssd->i2c_bus,
+    ssd->address,
+    ssd->cmd_buffer,
+    ssd->cmd_len,
+    false
+  );
+  ssd->cmd_len = 1;
+}
+
+void ssd1306_contrast(ssd1306_t *ssd, uint8_t value) {
+  ssd1306_cmd_begin(ssd);
+  ssd1306_cmd_add(ssd, SET_CONTRAST);
+  ssd1306_cmd_add(ssd, value);
+  ssd1306_cmd_send(ssd);
+}
+
+// Envia o quadro completo, independente do que estiver marcado como sujo
 void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
-    ssd->i2c_port,
+  TRACE_BEGIN(OLED_SEND, ssd->bufsize);
+  ssd1306_cmd_begin(ssd);
+  ssd1306_cmd_window(ssd, 0, ssd->width - 1, 0, ssd->pages - 1);
+  ssd1306_cmd_send(ssd);
+  hal_i2c_write(
+    ssd->i2c_bus,
     ssd->address,
     ssd->ram_buffer,
     ssd->bufsize,
     false
   );
+  memcpy(ssd->sent_buffer, ssd->ram_buffer, ssd->bufsize);
+  ssd1306_clear_dirty(ssd);
+  TRACE_END(OLED_SEND, ssd->bufsize);
+}
+
+// Transferência assíncrona ou bytes ainda na FIFO do I2C
+bool ssd1306_busy(ssd1306_t *ssd) {
+  return hal_i2c_stream_busy(ssd->stream);
+}
+
+// Aguarda o fim da transferência em andamento (não depende da IRQ, pode ser chamada em handlers)
+void ssd1306_wait(ssd1306_t *ssd) {
+  while (ssd1306_busy(ssd))
+    ;
+}
+
+/**
+ * @brief Inicia via DMA o envio da região alterada desde o último envio
+ * @return true se uma transferência foi iniciada, false se o quadro já estava atualizado
+ * @note O retângulo sujo é reduzido comparando com o último quadro enviado, de modo
+ *       que redesenhar o mesmo conteúdo não gera tráfego no I2C. A janela é copiada
+ *       para dma_buffer (buffer frontal), então ram_buffer pode ser redesenhado logo
+ *       em seguida; se o quadro anterior ainda estiver em trânsito, aguarda o seu fim.
+ */
+bool ssd1306_flush_async(ssd1306_t *ssd) {
+  if (ssd->dirty_x0 > ssd->dirty_x1)
+    return false;
+
+  uint8_t x0 = 0xFF, x1 = 0, p0 = 0xFF, p1 = 0;
+  for (uint8_t x = ssd->dirty_x0; x <= ssd->dirty_x1; ++x) {
+    uint16_t column = (x << 3) + 1;
+    for (uint8_t p = ssd->dirty_p0; p <= ssd->dirty_p1; ++p) {
+      if (ssd->ram_buffer[column + p] != ssd->sent_buffer[column + p]) {
+        if (x < x0) x0 = x;
+        x1 = x;
+        if (p < p0) p0 = p;
+        if (p > p1) p1 = p;
+      }
+    }
+  }
+  ssd1306_clear_dirty(ssd);
+  if (x0 > x1)
+    return false;
+
+  ssd1306_wait(ssd);
+
+  // Cada palavra é escrita direto em IC_DATA_CMD; o bit STOP encerra cada transação.
+  // O lote da janela vai na mesma transferência DMA, antes dos dados.
+  ssd1306_cmd_begin(ssd);
+  ssd1306_cmd_window(ssd, x0, x1, p0, p1);
+  uint16_t *out = ssd->dma_buffer;
+  size_t len = 0;
+  for (uint8_t i = 0; i < ssd->cmd_len; ++i)
+    out[len++] = ssd->cmd_buffer[i];
+  out[len - 1] |= HAL_I2C_STOP;
+  ssd1306_cmd_begin(ssd);
+
+  // No modo de endereçamento vertical a janela é percorrida coluna a coluna
+  out[len++] = 0x40;
+  for (uint8_t x = x0; x <= x1; ++x) {
+    uint16_t column = (x << 3) + 1;
+    for (uint8_t p = p0; p <= p1; ++p) {
+      out[len++] = ssd->ram_buffer[column + p];
+      ssd->sent_buffer[column + p] = ssd->ram_buffer[column + p];
+    }
+  }
+  out[len - 1] |= HAL_I2C_STOP;
+
+  TRACE_ASYNC_BEGIN(OLED_FLUSH, len);
+  hal_i2c_stream_start(ssd->stream, ssd->address, ssd->dma_buffer, len);
+  return true;
+}
+
+/**
+ * @brief Versão bloqueante de ssd1306_flush_async()
+ * @return true se houve transferência, false se o quadro já estava atualizado
+ */
+bool ssd1306_flush(ssd1306_t *ssd) {
+  bool sent = ssd1306_flush_async(ssd);
+  ssd1306_wait(ssd);
+  return sent;
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
   uint16_t index = (y >> 3) + (x << 3) + 1;
   uint8_t pixel = (y & 0b111);
-  if (value)
-    ssd->ram_buffer[index] |= (1 << pixel);
-  else
-    ssd->ram_buffer[index] &= ~(1 << pixel);
+  uint8_t old = ssd->ram_buffer[index];
+  uint8_t byte = value ? (old | (1 << pixel)) : (old & ~(1 << pixel));
+  if (byte != old) {
+    ssd->ram_buffer[index] = byte;
+    ssd1306_mark_dirty(ssd, x, y >> 3);
+  }
 }
 
-/*
+/**
+ * @brief Preenche todo o buffer com palavras de 32 bits
+ * @note Os bytes de pixel começam em ram_buffer + 1, então a cabeça e a cauda
+ *       desalinhadas são escritas byte a byte e o miolo palavra a palavra.
+ */
 void ssd1306_fill(ssd1306_t *ssd, bool value) {
   uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
+  uint32_t word = value ? 0xFFFFFFFFu : 0x00000000u;
+  uint8_t *p = ssd->ram_buffer + 1;
+  uint8_t *end = ssd->ram_buffer + ssd->bufsize;
 
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
-    }
+  while (p < end && ((uintptr_t)p & 3u))
+    *p++ = byte;
+  uint32_t *w = (uint32_t *)p;
+  while ((uint8_t *)(w + 1) <= end)
+    *w++ = word;
+  p = (uint8_t *)w;
+  while (p < end)
+    *p++ = byte;
+
+  ssd->dirty_x0 = 0;
+  ssd->dirty_x1 = ssd->width - 1;
+  ssd->dirty_p0 = 0;
+  ssd->dirty_p1 = ssd->pages - 1;
 }
 
+// Escreve os bits de mask na coluna x da página indicada, marcando sujo só se algo mudou
+static inline void ssd1306_write_bits(ssd1306_t *ssd, uint8_t x, uint8_t page, uint8_t mask, uint8_t bits) {
+  uint8_t *byte = &ssd->ram_buffer[(x << 3) + page + 1];
+  uint8_t updated = (*byte & ~mask) | (bits & mask);
+  if (updated != *byte) {
+    *byte = updated;
+    ssd1306_mark_dirty(ssd, x, page);
+  }
+}
 
+// Preenche as linhas y0..y1 da coluna x, uma página (8 pixels) por escrita
+static void ssd1306_column_span(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
+  if (x >= ssd->width)
+    return;
+  if (y1 >= ssd->height)
+    y1 = ssd->height - 1;
+  if (y0 > y1)
+    return;
 
-void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-  for (uint8_t x = left; x < left + width; ++x) {
-    ssd1306_pixel(ssd, x, top, value);
-    ssd1306_pixel(ssd, x, top + height - 1, value);
-  }
-  for (uint8_t y = top; y < top + height; ++y) {
-    ssd1306_pixel(ssd, left, y, value);
-    ssd1306_pixel(ssd, left + width - 1, y, value);
+  uint8_t bits = value ? 0xFF : 0x00;
+  uint8_t p0 = y0 >> 3, p1 = y1 >> 3;
+  for (uint8_t p = p0; p <= p1; ++p) {
+    uint8_t mask = 0xFF;
+    if (p == p0) mask &= (uint8_t)(0xFF << (y0 & 7));
+    if (p == p1) mask &= (uint8_t)(0xFF >> (7 - (y1 & 7)));
+    ssd1306_write_bits(ssd, x, p, mask, bits);
   }
+}
+
+void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
+  if (width == 0 || height == 0)
+    return;
+  uint16_t right = left + width - 1;
+  uint8_t bottom = (top + height - 1 > 0xFF) ? 0xFF : top + height - 1;
 
   if (fill) {
-    for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-      for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
-      }
-    }
+    for (uint16_t x = left; x <= right && x < ssd->width; ++x)
+      ssd1306_column_span(ssd, x, top, bottom, value);
+    return;
   }
+
+  ssd1306_hline(ssd, left, right > 0xFF ? 0xFF : right, top, value);
+  ssd1306_hline(ssd, left, right > 0xFF ? 0xFF : right, bottom, value);
+  ssd1306_column_span(ssd, left, top, bottom, value);
+  if (right < ssd->width)
+    ssd1306_column_span(ssd, right, top, bottom, value);
 }
 
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
@@ -144,13 +350,16 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 }
 
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-  for (uint8_t x = x0; x <= x1; ++x)
-    ssd1306_pixel(ssd, x, y, value);
+  if (y >= ssd->height)
+    return;
+  uint8_t page = y >> 3;
+  uint8_t bit = 1 << (y & 7);
+  for (uint16_t x = x0; x <= x1 && x < ssd->width; ++x)
+    ssd1306_write_bits(ssd, x, page, bit, value ? bit : 0);
 }
 
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+  ssd1306_column_span(ssd, x, y0, y1, value);
 }
 
 
@@ -180,14 +389,23 @@ void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
         index = 0;
     }
 
-    // Desenha o caractere no display, assumindo uma matriz de 8x8 pixels por caractere
+    uint8_t page = y >> 3;
+    uint8_t shift = y & 7;
+    if (page >= ssd->pages)
+        return;
+
+    // Cada byte da fonte é uma coluna de 8 pixels, o mesmo formato de uma página do
+    // display: com y alinhado basta copiar a coluna, senão ela é dividida em duas páginas
     for (uint8_t i = 0; i < 8; ++i)
     {
+        uint16_t column = x + i;
+        if (column >= ssd->width)
+            break;
         uint8_t line = font[index + i];
-        for (uint8_t j = 0; j < 8; ++j)
+        ssd1306_write_bits(ssd, column, page, 0xFF << shift, line << shift);
+        if (shift && page + 1 < ssd->pages)
         {
-            // Verifica se o bit j de 'line' está setado e desenha o pixel
-            ssd1306_pixel(ssd, x + i, y + j, (line & (1 << j)) ? 1 : 0);
+            ssd1306_write_bits(ssd, column, page + 1, 0xFF >> (8 - shift), line >> (8 - shift));
         }
     }
 }
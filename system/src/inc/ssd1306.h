@@ -1,9 +1,9 @@
 #include <stdlib.h>
-#include "pico/stdlib.h"
-#include "hardware/i2c.h"
+#include "src/hal/hal.h"
 
 #define WIDTH 128
 #define HEIGHT 64
+#define SSD1306_CMD_BATCH_MAX 32   // Comandos acumulados por transação I2C
 
 typedef enum {
   SET_CONTRAST = 0x81,
@@ -27,17 +27,32 @@ typedef enum {
 
 typedef struct {
   uint8_t width, height, pages, address;
-  i2c_inst_t *i2c_port;
+  uint i2c_bus;
   bool external_vcc;
   uint8_t *ram_buffer;
   size_t bufsize;
   uint8_t port_buffer[2];
+  uint8_t cmd_buffer[SSD1306_CMD_BATCH_MAX + 1]; // Byte de controle 0x00 seguido dos comandos em lote
+  uint8_t cmd_len;
+  uint8_t *sent_buffer;   // Cópia do último quadro efetivamente enviado ao display
+  uint16_t *dma_buffer;   // Quadro em trânsito: janela + dados no formato de fluxo I2C da HAL
+  int stream;             // Fluxo I2C assíncrono (canal DMA) reservado para o display
+  void (*flush_done)(void); // Chamada (em contexto de IRQ) ao fim de cada transferência assíncrona
+  uint8_t dirty_x0, dirty_x1, dirty_p0, dirty_p1; // Retângulo sujo (colunas/páginas), vazio se x0 > x1
 } ssd1306_t;
 
-void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
+void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, uint i2c_bus);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
+void ssd1306_cmd_begin(ssd1306_t *ssd);
+void ssd1306_cmd_add(ssd1306_t *ssd, uint8_t command);
+void ssd1306_cmd_send(ssd1306_t *ssd);
+void ssd1306_contrast(ssd1306_t *ssd, uint8_t value);
 void ssd1306_send_data(ssd1306_t *ssd);
+bool ssd1306_flush(ssd1306_t *ssd);
+bool ssd1306_flush_async(ssd1306_t *ssd);
+bool ssd1306_busy(ssd1306_t *ssd);
+void ssd1306_wait(ssd1306_t *ssd);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
@@ -0,0 +1,255 @@
+#include "src/input_stream.h"
+#include "src/trace.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Entrada de texto pela USB (stdio), pela UART e pelo teclado matricial.
+ *
+ * Cada origem tem um anel SPSC sem travas, preenchido em contexto de
+ * interrupção: a UART pela interrupção de RX (FIFO com nível ou tempo ocioso)
+ * e a USB pelo aviso de caracteres disponíveis do stdio; o teclado, que já
+ * chega como eventos, é repassado com input_stream_put(). O laço principal
+ * consome os anéis com input_stream_read(), alternando entre as origens.
+ *
+ * Contrapressão: com o anel cheio a origem é suspensa em vez de descartar
+ * dados. A UART desliga a própria interrupção (a FIFO de hardware segura os
+ * próximos bytes) e a USB deixa os bytes no buffer do CDC, que passa a
+ * recusar pacotes do host. A recepção é retomada quando o consumidor libera
+ * INPUT_RESUME_FREE posições.
+ *
+ * Sobre os anéis, input_line_poll() monta uma linha de dígitos por origem,
+ * ecoando '*' para quem digitou, e descarta digitações interrompidas.
+ */
+
+#define INPUT_RING_MASK (INPUT_RING_SIZE - 1)
+
+typedef struct {
+    char data[INPUT_RING_SIZE];
+    uint32_t head;          // Escrito apenas pelo produtor (interrupção)
+    uint32_t tail;          // Escrito apenas pelo consumidor
+    volatile bool throttled;
+    input_stats_t stats;
+} input_ring_t;
+
+typedef struct {
+    char text[INPUT_LINE_MAX];
+    uint8_t len;
+    uint32_t last_us;       // Instante do último dígito
+} input_line_t;
+
+static input_ring_t rings[INPUT_SOURCES];
+static uint input_uart;
+static uint8_t next_source;
+
+static input_line_t lines[INPUT_SOURCES];
+static uint8_t line_length;
+static uint32_t line_timeout_us;
+static uint32_t line_activity_us;   // Início da espera ou último dígito de qualquer origem
+static bool line_echo = true;
+
+static uint32_t ring_free(const input_ring_t *r) {
+    return INPUT_RING_SIZE - (r->head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE));
+}
+
+static void ring_push(input_ring_t *r, char c) {
+    uint32_t head = r->head;
+    r->data[head & INPUT_RING_MASK] = c;
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+    r->stats.received++;
+}
+
+static void ring_throttle(input_ring_t *r) {
+    r->throttled = true;
+    r->stats.throttled++;
+}
+
+// Interrupção de RX da UART: esvazia a FIFO enquanto houver espaço no anel
+static void uart_rx_irq(void *ctx) {
+    input_ring_t *r = &rings[INPUT_SRC_UART];
+    uint32_t received = r->stats.received;
+    TRACE_BEGIN(UART_RX_IRQ, 0);
+    while (hal_uart_readable(input_uart)) {
+        if (ring_free(r) == 0) {
+            hal_uart_rx_irq_enable(input_uart, false);
+            ring_throttle(r);
+            break;
+        }
+        ring_push(r, hal_uart_getc(input_uart));
+    }
+    TRACE_END(UART_RX_IRQ, r->stats.received - received);
+}
+
+// Aviso de caracteres da USB: só retira do CDC o que cabe no anel
+static void usb_rx_drain(void *ctx) {
+    input_ring_t *r = &rings[INPUT_SRC_USB];
+    if (r->throttled) {
+        return;
+    }
+    while (true) {
+        if (ring_free(r) == 0) {
+            ring_throttle(r);
+            return;
+        }
+        int c = hal_stdio_getchar(0);
+        if (c == HAL_NO_CHAR) {
+            return;
+        }
+        ring_push(r, (char)c);
+    }
+}
+
+// Retoma uma origem suspensa quando o consumidor liberou espaço suficiente
+static void ring_resume(uint8_t source) {
+    input_ring_t *r = &rings[source];
+    if (!r->throttled || ring_free(r) < INPUT_RESUME_FREE) {
+        return;
+    }
+    r->throttled = false;
+    if (source == INPUT_SRC_UART) {
+        hal_uart_rx_irq_enable(input_uart, true);
+    } else if (source == INPUT_SRC_USB) {
+        // O aviso da USB só vem com dados novos: busca agora o que ficou no CDC
+        uint32_t state = hal_irq_save();
+        usb_rx_drain(NULL);
+        hal_irq_restore(state);
+    }
+}
+
+/**
+ * @brief Passa a receber a USB e a UART indicada por interrupção
+ * @param uart UART já inicializada com hal_uart_init
+ */
+void input_stream_init(uint uart) {
+    memset(rings, 0, sizeof(rings));
+    memset(lines, 0, sizeof(lines));
+    input_uart = uart;
+    next_source = 0;
+    line_length = 0;
+    hal_uart_set_rx_irq(uart, uart_rx_irq, NULL);
+    hal_stdio_set_rx_callback(usb_rx_drain, NULL);
+}
+
+/**
+ * @brief Insere um caractere de uma origem sem recepção própria
+ * @return false se o anel da origem estiver cheio (o caractere é descartado)
+ * @note Cada origem deve ter um único produtor
+ */
+bool input_stream_put(uint8_t source, char c) {
+    input_ring_t *r = &rings[source];
+    if (ring_free(r) == 0) {
+        r->stats.throttled++;
+        return false;
+    }
+    ring_push(r, c);
+    return true;
+}
+
+/**
+ * @brief Retira o próximo caractere recebido, alternando entre as origens
+ * @return false se nenhuma origem tiver caracteres
+ * @note Chamada apenas pelo laço principal
+ */
+bool input_stream_read(input_char_t *in) {
+    for (uint8_t i = 0; i < INPUT_SOURCES; i++) {
+        uint8_t source = (next_source + i) % INPUT_SOURCES;
+        input_ring_t *r = &rings[source];
+        uint32_t tail = r->tail;
+        uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            continue;
+        }
+
+        in->source = source;
+        in->c = r->data[tail & INPUT_RING_MASK];
+        __atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+        ring_resume(source);
+        next_source = (source + 1) % INPUT_SOURCES;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Envia um caractere de volta à origem (eco da digitação)
+ * @note O teclado não tem saída própria: seu eco vai para o console USB
+ */
+void input_stream_echo(uint8_t source, char c) {
+    if (source == INPUT_SRC_UART) {
+        hal_uart_putc(input_uart, c);
+    } else {
+        putchar(c);
+    }
+}
+
+void input_stream_stats(uint8_t source, input_stats_t *stats) {
+    *stats = rings[source].stats;
+}
+
+/**
+ * @brief Começa a montar linhas de length dígitos, uma por origem
+ * @param timeout_ms Prazo sem dígitos (de qualquer origem) até input_line_poll
+ * indicar INPUT_LINE_TIMEOUT; 0 espera indefinidamente. Uma linha parcial
+ * parada por mais que o prazo é descartada ao receber o próximo dígito.
+ * @note Caracteres que chegaram antes continuam nos anéis e são aproveitados
+ */
+void input_line_begin(uint8_t length, uint32_t timeout_ms) {
+    line_length = length < INPUT_LINE_MAX ? length : INPUT_LINE_MAX;
+    line_timeout_us = timeout_ms * 1000u;
+    line_activity_us = hal_time_us_32();
+    for (uint8_t i = 0; i < INPUT_SOURCES; i++) {
+        lines[i].len = 0;
+    }
+}
+
+/**
+ * @brief Liga ou desliga o eco de '*' a cada dígito (ligado por padrão)
+ * @note Desligado só durante as medições de src/bench.c, para não encher o console
+ */
+void input_line_echo(bool enabled) {
+    line_echo = enabled;
+}
+
+/**
+ * @brief Consome os anéis até completar uma linha, sem bloquear
+ * @param line Destino com espaço para length + 1 caracteres
+ * @param source Origem da linha completa
+ * @note Caracteres que não são dígitos são ignorados. Os que chegarem depois
+ * da linha completa ficam nos anéis para a próxima leitura.
+ */
+input_line_status_t input_line_poll(char *line, uint8_t *source) {
+    uint32_t now = hal_time_us_32();
+    input_char_t in;
+    while (input_stream_read(&in)) {
+        if (in.c < '0' || in.c > '9') {
+            continue;
+        }
+
+        input_line_t *l = &lines[in.source];
+        if (l->len > 0 && line_timeout_us != 0 && now - l->last_us > line_timeout_us) {
+            l->len = 0;
+        }
+        l->text[l->len++] = in.c;
+        l->last_us = now;
+        line_activity_us = now;
+        if (line_echo) {
+            input_stream_echo(in.source, '*');
+        }
+
+        if (l->len >= line_length) {
+            memcpy(line, l->text, line_length);
+            line[line_length] = '\0';
+            *source = in.source;
+            for (uint8_t i = 0; i < INPUT_SOURCES; i++) {
+                lines[i].len = 0;
+            }
+            return INPUT_LINE_READY;
+        }
+    }
+
+    if (line_timeout_us != 0 && now - line_activity_us > line_timeout_us) {
+        return INPUT_LINE_TIMEOUT;
+    }
+    return INPUT_LINE_PENDING;
+}
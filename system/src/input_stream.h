@@ -0,0 +1,44 @@
+#ifndef INPUT_STREAM_H
+#define INPUT_STREAM_H
+
+#include "src/hal/hal.h"
+
+// Origens dos caracteres
+#define INPUT_SRC_USB    0
+#define INPUT_SRC_UART   1
+#define INPUT_SRC_KEYPAD 2
+#define INPUT_SOURCES    3
+
+#define INPUT_RING_SIZE   256                   // Capacidade de cada anel (potência de 2)
+#define INPUT_RESUME_FREE (INPUT_RING_SIZE / 2) // Espaço livre para retomar uma origem suspensa
+#define INPUT_LINE_MAX    16                    // Maior linha montada por input_line_poll
+
+typedef struct {
+    uint8_t source;         // INPUT_SRC_USB, INPUT_SRC_UART ou INPUT_SRC_KEYPAD
+    char c;
+} input_char_t;
+
+typedef struct {
+    uint32_t received;      // Caracteres guardados no anel
+    uint32_t throttled;     // Vezes em que a recepção foi suspensa por anel cheio
+} input_stats_t;
+
+typedef enum {
+    INPUT_LINE_PENDING,     // Linha ainda incompleta
+    INPUT_LINE_READY,       // Linha completa copiada para o destino
+    INPUT_LINE_TIMEOUT      // Nenhum dígito dentro do prazo
+} input_line_status_t;
+
+// Prototipação das funções do fluxo de entrada
+void input_stream_init(uint uart);
+bool input_stream_put(uint8_t source, char c);
+bool input_stream_read(input_char_t *in);
+void input_stream_echo(uint8_t source, char c);
+void input_stream_stats(uint8_t source, input_stats_t *stats);
+
+// Prototipação das funções de montagem de linhas por origem
+void input_line_begin(uint8_t length, uint32_t timeout_ms);
+input_line_status_t input_line_poll(char *line, uint8_t *source);
+void input_line_echo(bool enabled);
+
+#endif // INPUT_STREAM_H
@@ -0,0 +1,144 @@
+#include "src/iris_match.h"
+
+#include <string.h>
+
+/*
+ * Comparação de códigos de íris por distância de Hamming fracionária.
+ *
+ * A distância entre dois códigos é a fração de bits diferentes entre os bits
+ * válidos nas duas máscaras: popcount((a ^ b) & ma & mb) / popcount(ma & mb),
+ * calculada palavra a palavra. A rotação da cabeça desloca o código ao longo
+ * do ângulo, então cada comparação procura o melhor alinhamento entre
+ * ±IRIS_MAX_SHIFT posições; as rotações da amostra são calculadas uma vez em
+ * iris_probe_prepare() e reaproveitadas para todos os modelos.
+ *
+ * Para buscar em centenas de modelos em poucos milissegundos no Cortex-M0+
+ * (sem instrução de popcount nem FPU), as contas são inteiras, a contagem de
+ * bits é feita em paralelo na palavra e cada comparação é avaliada anel a
+ * anel: se a distância parcial passar de IRIS_EARLY_HD com bits suficientes,
+ * o par é descartado. Códigos de olhos diferentes ficam perto de 0,5 e quase
+ * sempre são descartados no primeiro anel; as rotações seguem do centro para
+ * as bordas, com o limite apertando a cada melhor alinhamento encontrado.
+ */
+
+/**
+ * @brief Bits em 1 de uma palavra (soma paralela, sem tabela)
+ */
+uint32_t iris_popcount(uint32_t x) {
+    x = x - ((x >> 1) & 0x55555555u);
+    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+    x = (x + (x >> 4)) & 0x0F0F0F0Fu;
+    return (x * 0x01010101u) >> 24;
+}
+
+// Gira cada anel de bits posições (bit j passa a j + bits)
+static void rotate_rings(const uint32_t *src, uint32_t *dst, uint32_t bits) {
+    uint32_t q = bits / 32;
+    uint32_t r = bits % 32;
+    for (int ring = 0; ring < IRIS_RINGS; ring++) {
+        const uint32_t *s = &src[ring * IRIS_RING_WORDS];
+        uint32_t *d = &dst[ring * IRIS_RING_WORDS];
+        for (uint32_t k = 0; k < IRIS_RING_WORDS; k++) {
+            uint32_t hi = s[(k + IRIS_RING_WORDS - q) % IRIS_RING_WORDS];
+            uint32_t lo = s[(k + 2 * IRIS_RING_WORDS - q - 1) % IRIS_RING_WORDS];
+            d[k] = r ? (hi << r) | (lo >> (32 - r)) : hi;
+        }
+    }
+}
+
+/**
+ * @brief Calcula as rotações de uma amostra para a busca
+ */
+void iris_probe_prepare(const iris_code_t *code, iris_probe_t *probe) {
+    const uint32_t ring_bits = IRIS_RING_WORDS * 32;
+    for (int s = -IRIS_MAX_SHIFT; s <= IRIS_MAX_SHIFT; s++) {
+        uint32_t bits = (uint32_t)((s * IRIS_BITS_PER_ANGLE + (int)ring_bits) % (int)ring_bits);
+        iris_code_t *rot = &probe->rot[IRIS_MAX_SHIFT + s];
+        rotate_rings(code->code, rot->code, bits);
+        rotate_rings(code->mask, rot->mask, bits);
+    }
+
+    uint32_t valid = 0;
+    for (int i = 0; i < IRIS_CODE_WORDS; i++) {
+        valid += iris_popcount(code->mask[i]);
+    }
+    probe->valid_bits = (uint16_t)valid;
+}
+
+// Distância de um alinhamento, ou IRIS_HD_REJECT se passar de early no meio
+// ou de limit no fim
+static uint32_t compare(const iris_code_t *a, const iris_code_t *b, uint32_t limit, uint32_t early,
+                        iris_match_t *m) {
+    uint32_t diff = 0;
+    uint32_t valid = 0;
+    for (int ring = 0; ring < IRIS_RINGS; ring++) {
+        for (int i = ring * IRIS_RING_WORDS; i < (ring + 1) * IRIS_RING_WORDS; i++) {
+            uint32_t mask = a->mask[i] & b->mask[i];
+            diff += iris_popcount((a->code[i] ^ b->code[i]) & mask);
+            valid += iris_popcount(mask);
+        }
+        m->words += IRIS_RING_WORDS;
+        // diff / valid > early, sem divisão (diff << 16 cabe em 32 bits)
+        if (valid >= IRIS_EARLY_MIN_BITS && (diff << 16) > early * valid) {
+            m->early_exits++;
+            return IRIS_HD_REJECT;
+        }
+    }
+    if (valid < IRIS_MIN_VALID_BITS) {
+        return IRIS_HD_REJECT;
+    }
+    uint32_t hd = (diff << 16) / valid;
+    return hd <= limit ? hd : IRIS_HD_REJECT;
+}
+
+/**
+ * @brief Menor distância entre a amostra e um modelo entre todas as rotações
+ * @param limit Distâncias acima dele não interessam (IRIS_HD_REJECT: calcula
+ *              sempre a distância exata, sem encerrar pela parcial)
+ * @param m Acumula palavras comparadas e encerramentos; recebe a rotação
+ * @return Distância em Q16, ou IRIS_HD_REJECT se nenhuma rotação ficou até limit
+ */
+uint32_t iris_distance(const iris_probe_t *probe, const iris_code_t *tpl, uint32_t limit, iris_match_t *m) {
+    uint32_t best = IRIS_HD_REJECT;
+    for (int step = 0; step < IRIS_ROTATIONS; step++) {
+        // 0, +1, -1, +2, -2, ...: o alinhamento certo costuma estar perto do centro
+        int s = (step + 1) / 2 * (step % 2 ? 1 : -1);
+        uint32_t bound = best < limit ? best : limit;
+        uint32_t early = bound >= IRIS_HD(1.0) ? IRIS_HD(1.0) : (bound > IRIS_EARLY_HD ? bound : IRIS_EARLY_HD);
+        uint32_t hd = compare(&probe->rot[IRIS_MAX_SHIFT + s], tpl, bound, early, m);
+        if (hd < best) {
+            best = hd;
+            m->shift = (int8_t)s;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Busca o modelo mais próximo da amostra em uma galeria
+ * @param limit Maior distância aceita (normalmente IRIS_ACCEPT_HD)
+ * @return true se algum modelo ficou até limit; best recebe o mais próximo
+ */
+bool iris_search(const iris_probe_t *probe, const iris_code_t *gallery, size_t count, uint32_t limit,
+                 iris_match_t *best) {
+    memset(best, 0, sizeof(*best));
+    best->index = -1;
+    best->hd = IRIS_HD_REJECT;
+    if (probe->valid_bits < IRIS_MIN_VALID_BITS) {
+        return false;
+    }
+
+    iris_match_t m = {0};
+    for (size_t i = 0; i < count; i++) {
+        uint32_t bound = best->hd < limit ? best->hd : limit;
+        uint32_t hd = iris_distance(probe, &gallery[i], bound, &m);
+        if (hd < best->hd) {
+            best->hd = hd;
+            best->index = (int32_t)i;
+            best->shift = m.shift;
+        }
+    }
+    best->words = m.words;
+    best->early_exits = m.early_exits;
+    return best->index >= 0;
+}
@@ -0,0 +1,56 @@
+#ifndef IRIS_MATCH_H
+#define IRIS_MATCH_H
+
+#include "src/hal/hal.h"
+
+// Código de íris: 8 anéis radiais x 128 posições angulares x 2 bits de fase,
+// cada anel em 8 palavras de 32 bits. Bit i do código = bit i % 32 da palavra i / 32.
+#define IRIS_CODE_BITS      2048
+#define IRIS_CODE_WORDS     (IRIS_CODE_BITS / 32)
+#define IRIS_RINGS          8
+#define IRIS_RING_WORDS     (IRIS_CODE_WORDS / IRIS_RINGS)
+#define IRIS_BITS_PER_ANGLE 2
+#define IRIS_ANGLES         (IRIS_RING_WORDS * 32 / IRIS_BITS_PER_ANGLE)
+
+_Static_assert(IRIS_CODE_WORDS == HAL_IRIS_CODE_WORDS, "Código de íris difere do entregue pela HAL");
+
+#define IRIS_MAX_SHIFT  8                       // Rotação tolerada: ±8 posições (±22,5°)
+#define IRIS_ROTATIONS  (2 * IRIS_MAX_SHIFT + 1)
+
+// Distâncias de Hamming fracionárias em Q16 (65536 = 1,0)
+#define IRIS_HD(x)        ((uint32_t)((x) * 65536.0 + 0.5))
+#define IRIS_HD_REJECT    0xFFFFFFFFu
+#ifndef IRIS_ACCEPT_HD
+#define IRIS_ACCEPT_HD    IRIS_HD(0.32)         // Aceita abaixo deste limiar
+#endif
+#define IRIS_EARLY_HD     IRIS_HD(0.42)         // Parcial acima disto encerra a comparação
+#define IRIS_EARLY_MIN_BITS 192                 // Bits válidos antes de decidir pela parcial
+#define IRIS_MIN_VALID_BITS 512                 // Menos bits válidos que isto não é comparável
+
+typedef struct {
+    uint32_t code[IRIS_CODE_WORDS];
+    uint32_t mask[IRIS_CODE_WORDS];             // 1 = bit válido (sem pálpebra, cílio ou reflexo)
+} iris_code_t;
+
+// Amostra pronta para busca: todas as rotações calculadas uma única vez
+typedef struct {
+    iris_code_t rot[IRIS_ROTATIONS];            // rot[IRIS_MAX_SHIFT + s] = rotação de s posições
+    uint16_t valid_bits;
+} iris_probe_t;
+
+typedef struct {
+    int32_t index;                              // Modelo mais próximo; -1 se nenhum abaixo do limite
+    int8_t shift;                               // Rotação do melhor alinhamento
+    uint32_t hd;                                // Distância em Q16
+    uint32_t words;                             // Palavras comparadas na busca inteira
+    uint32_t early_exits;                       // Comparações encerradas pela parcial
+} iris_match_t;
+
+// Prototipação das funções de comparação de íris
+void iris_probe_prepare(const iris_code_t *code, iris_probe_t *probe);
+uint32_t iris_distance(const iris_probe_t *probe, const iris_code_t *tpl, uint32_t limit, iris_match_t *m);
+bool iris_search(const iris_probe_t *probe, const iris_code_t *gallery, size_t count, uint32_t limit,
+                 iris_match_t *best);
+uint32_t iris_popcount(uint32_t x);
+
+#endif // IRIS_MATCH_H
@@ -0,0 +1,135 @@
+#include "src/joystick.h"
+#include "src/adc_sampler.h"
+#include "src/scheduler.h"
+#include <stdio.h>
+
+/*
+ * Entrada do joystick como eventos de navegação.
+ *
+ * A cada JOYSTICK_POLL_MS os dois eixos são lidos como a média das últimas
+ * JOYSTICK_OVERSAMPLE amostras do ADC e comparados ao centro medido na
+ * inicialização. Cada eixo só sai do repouso além de JOYSTICK_DEADZONE_ON e
+ * só volta abaixo de JOYSTICK_DEADZONE_OFF; com os dois eixos fora do
+ * repouso vale o de maior deslocamento. Uma direção nova gera um evento
+ * imediato; mantida, repete após o atraso inicial com intervalos cada vez
+ * menores. Os prazos usam o relógio do timer, de modo que a cadência não
+ * depende do período de quem consome os eventos.
+ */
+
+typedef struct {
+    uint channel;
+    uint16_t center;
+    int8_t state;           // -1, 0 ou +1 após a histerese
+    int32_t offset;         // Deslocamento da última leitura
+} joystick_axis_t;
+
+static joystick_axis_t axis_x = {ADC_CH_JOY_X, JOYSTICK_CENTER_NOMINAL, 0, 0};
+static joystick_axis_t axis_y = {ADC_CH_JOY_Y, JOYSTICK_CENTER_NOMINAL, 0, 0};
+static event_queue_t *nav_events;
+
+static uint8_t held;                // Direção mantida (0 = repouso)
+static uint32_t next_repeat_us;
+static uint32_t interval_us;
+
+static uint32_t repeat_delay_us = JOYSTICK_REPEAT_DELAY_MS * 1000u;
+static uint32_t repeat_start_us = JOYSTICK_REPEAT_START_MS * 1000u;
+static uint32_t repeat_min_us = JOYSTICK_REPEAT_MIN_MS * 1000u;
+static uint8_t repeat_accel = JOYSTICK_REPEAT_ACCEL;
+
+static void axis_calibrate(joystick_axis_t *axis) {
+    uint16_t center = adc_sampler_average(axis->channel, JOYSTICK_CALIB_SAMPLES);
+    int32_t dev = (int32_t)center - JOYSTICK_CENTER_NOMINAL;
+    if (dev > JOYSTICK_CENTER_MAX_DEV || dev < -JOYSTICK_CENTER_MAX_DEV) {
+        printf("Joystick fora do centro na calibração (canal %u: %u)\n", axis->channel, center);
+        center = JOYSTICK_CENTER_NOMINAL;
+    }
+    axis->center = center;
+}
+
+static void axis_update(joystick_axis_t *axis) {
+    axis->offset = (int32_t)adc_sampler_average(axis->channel, JOYSTICK_OVERSAMPLE) - axis->center;
+    int32_t magnitude = axis->offset < 0 ? -axis->offset : axis->offset;
+    if (axis->state == 0) {
+        if (magnitude > JOYSTICK_DEADZONE_ON) {
+            axis->state = axis->offset < 0 ? -1 : 1;
+        }
+    } else if (magnitude < JOYSTICK_DEADZONE_OFF || (axis->offset < 0) != (axis->state < 0)) {
+        axis->state = 0;
+    }
+}
+
+// Direção atual; abaixo do centro no eixo vertical é "para baixo"
+static uint8_t joystick_direction(void) {
+    int32_t mx = axis_x.state ? (axis_x.offset < 0 ? -axis_x.offset : axis_x.offset) : -1;
+    int32_t my = axis_y.state ? (axis_y.offset < 0 ? -axis_y.offset : axis_y.offset) : -1;
+    if (mx < 0 && my < 0) {
+        return 0;
+    }
+    if (my >= mx) {
+        return axis_y.state < 0 ? JOYSTICK_DOWN : JOYSTICK_UP;
+    }
+    return axis_x.state < 0 ? JOYSTICK_LEFT : JOYSTICK_RIGHT;
+}
+
+static void joystick_task(void *ctx) {
+    axis_update(&axis_x);
+    axis_update(&axis_y);
+    uint8_t dir = joystick_direction();
+    uint32_t now = hal_time_us_32();
+
+    if (dir != held) {
+        held = dir;
+        if (dir != 0) {
+            event_queue_push(nav_events, EVENT_NAV, dir, now);
+            next_repeat_us = now + repeat_delay_us;
+            interval_us = repeat_start_us;
+        }
+        return;
+    }
+    if (dir == 0 || (int32_t)(now - next_repeat_us) < 0) {
+        return;
+    }
+    event_queue_push(nav_events, EVENT_NAV, dir, now);
+    next_repeat_us += interval_us;
+    if ((int32_t)(now - next_repeat_us) >= 0) {
+        next_repeat_us = now + interval_us;     // Não acumula repetições atrasadas
+    }
+    interval_us = interval_us * repeat_accel / 100;
+    if (interval_us < repeat_min_us) {
+        interval_us = repeat_min_us;
+    }
+}
+
+/**
+ * @brief Mede o centro dos eixos e passa a gerar eventos EVENT_NAV em events
+ * @note O amostrador do ADC já deve estar rodando; a alavanca deve estar solta
+ */
+void joystick_init(event_queue_t *events) {
+    nav_events = events;
+    axis_calibrate(&axis_x);
+    axis_calibrate(&axis_y);
+    held = 0;
+    sched_every(joystick_task, NULL, JOYSTICK_POLL_MS);
+}
+
+/**
+ * @brief Ajusta a repetição automática
+ * @param delay_ms Tempo mantido antes da primeira repetição
+ * @param interval_ms Intervalo entre a primeira e a segunda repetição
+ * @param min_interval_ms Limite inferior da aceleração
+ * @param accel_pct Cada intervalo é accel_pct% do anterior (100 = sem aceleração)
+ */
+void joystick_set_repeat(uint32_t delay_ms, uint32_t interval_ms, uint32_t min_interval_ms, uint8_t accel_pct) {
+    repeat_delay_us = delay_ms * 1000u;
+    repeat_start_us = interval_ms * 1000u;
+    repeat_min_us = min_interval_ms * 1000u;
+    repeat_accel = accel_pct > 100 ? 100 : accel_pct;
+}
+
+/**
+ * @brief Centro medido de cada eixo
+ */
+void joystick_center(uint16_t *x, uint16_t *y) {
+    *x = axis_x.center;
+    *y = axis_y.center;
+}
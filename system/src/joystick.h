@@ -0,0 +1,34 @@
+#ifndef JOYSTICK_H
+#define JOYSTICK_H
+
+#include "src/hal/hal.h"
+#include "src/event_queue.h"
+
+// Direções entregues como source dos eventos EVENT_NAV
+#define JOYSTICK_UP    1
+#define JOYSTICK_DOWN  2
+#define JOYSTICK_LEFT  3
+#define JOYSTICK_RIGHT 4
+
+#define JOYSTICK_POLL_MS        10      // Período de leitura dos eixos
+#define JOYSTICK_OVERSAMPLE     64      // Amostras por leitura (8 ms a 8 kHz)
+#define JOYSTICK_CALIB_SAMPLES  1024    // Amostras para medir o centro na inicialização
+#define JOYSTICK_CENTER_NOMINAL 2048
+#define JOYSTICK_CENTER_MAX_DEV 600     // Centro medido além disto: alavanca estava deslocada
+
+// Zona morta com histerese, em contagens do ADC a partir do centro
+#define JOYSTICK_DEADZONE_ON    600
+#define JOYSTICK_DEADZONE_OFF   350
+
+// Repetição automática padrão
+#define JOYSTICK_REPEAT_DELAY_MS 400    // Espera antes da primeira repetição
+#define JOYSTICK_REPEAT_START_MS 200    // Intervalo da primeira repetição
+#define JOYSTICK_REPEAT_MIN_MS   50     // Intervalo mínimo após a aceleração
+#define JOYSTICK_REPEAT_ACCEL    75     // Cada intervalo é 75% do anterior
+
+// Prototipação das funções do joystick
+void joystick_init(event_queue_t *events);
+void joystick_set_repeat(uint32_t delay_ms, uint32_t interval_ms, uint32_t min_interval_ms, uint8_t accel_pct);
+void joystick_center(uint16_t *x, uint16_t *y);
+
+#endif // JOYSTICK_H
@@ -0,0 +1,130 @@
+#include "src/keypad.h"
+#include "src/trace.h"
+
+/*
+ * Teclado matricial 4x4 varrido pela PIO (programa keypad_scan).
+ *
+ * A state machine varre as linhas, compara cada varredura com a última
+ * enviada e só coloca na FIFO RX as leituras que mudaram, já espaçadas pelo
+ * tempo de acomodação dos contatos; a CPU só trabalha na interrupção de FIFO
+ * não vazia. Aqui cada leitura vira eventos EVENT_PRESS/EVENT_RELEASE cuja
+ * fonte é o caractere da tecla.
+ *
+ * Sem diodos, qualquer combinação de teclas é lida corretamente, exceto
+ * quando três delas ocupam cantos de um retângulo: o quarto canto aparece
+ * fechado. A leitura é então ambígua e, enquanto durar, novas teclas não são
+ * aceitas (só liberações).
+ */
+
+static const char keypad_chars[KEYPAD_KEYS] = {
+    '1', '2', '3', 'A',
+    '4', '5', '6', 'B',
+    '7', '8', '9', 'C',
+    '*', '0', '#', 'D'
+};
+
+static event_queue_t *keypad_events;
+static volatile uint16_t keypad_accepted;   // Teclas pressionadas aceitas
+static volatile bool keypad_is_ambiguous;
+static keypad_stats_t stats;
+
+static uint16_t keypad_row(uint16_t keys, uint8_t row) {
+    return (keys >> (row * HAL_KEYPAD_COLS)) & ((1u << HAL_KEYPAD_COLS) - 1);
+}
+
+// Duas linhas com duas ou mais colunas fechadas em comum formam um retângulo
+static bool keypad_has_rectangle(uint16_t keys) {
+    for (uint8_t a = 0; a < HAL_KEYPAD_ROWS; a++) {
+        for (uint8_t b = a + 1; b < HAL_KEYPAD_ROWS; b++) {
+            uint16_t common = keypad_row(keys, a) & keypad_row(keys, b);
+            if (common & (common - 1)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Interrupção da FIFO RX: aplica todas as leituras pendentes
+static void keypad_on_change(void *ctx) {
+    uint16_t closed;
+    TRACE_BEGIN(KEYPAD_IRQ, keypad_accepted);
+    while (hal_keypad_read(&closed)) {
+        uint32_t now = hal_time_us_32();
+        uint16_t accepted = keypad_accepted;
+        stats.reports++;
+
+        bool ambiguous = keypad_has_rectangle(closed);
+        if (ambiguous) {
+            stats.ghosts++;
+            closed &= accepted;
+        }
+        keypad_is_ambiguous = ambiguous;
+
+        uint16_t changed = closed ^ accepted;
+        for (uint8_t key = 0; changed != 0; key++, changed >>= 1) {
+            if (changed & 1u) {
+                uint8_t type = (closed >> key) & 1u ? EVENT_PRESS : EVENT_RELEASE;
+                event_queue_push(keypad_events, type, (uint8_t)keypad_chars[key], now);
+            }
+        }
+        keypad_accepted = closed;
+    }
+    TRACE_END(KEYPAD_IRQ, keypad_accepted);
+}
+
+/**
+ * @brief Inicia a varredura do teclado pela PIO
+ * @param events Fila que recebe as teclas (o teclado é o único produtor)
+ * @note O bloco PIO não pode ser o da matriz de LEDs: a janela de saída da
+ *       varredura cobre o pino da matriz
+ */
+void keypad_init(hal_pio_t pio, uint sm, event_queue_t *events) {
+    keypad_events = events;
+    keypad_accepted = 0;
+    keypad_is_ambiguous = false;
+    stats.reports = 0;
+    stats.ghosts = 0;
+    hal_keypad_init(pio, sm, keypad_on_change, NULL);
+}
+
+/**
+ * @brief Teclas pressionadas no momento (bit linha * 4 + coluna)
+ */
+uint16_t keypad_state(void) {
+    return keypad_accepted;
+}
+
+/**
+ * @brief Indica se a leitura atual tem teclas que não podem ser distinguidas
+ */
+bool keypad_ambiguous(void) {
+    return keypad_is_ambiguous;
+}
+
+char keypad_key_char(uint8_t key) {
+    return key < KEYPAD_KEYS ? keypad_chars[key] : '?';
+}
+
+/**
+ * @brief Escreve os caracteres das teclas de um conjunto, em ordem de varredura
+ * @return Quantidade de teclas escritas
+ */
+size_t keypad_format(uint16_t keys, char *dst, size_t size) {
+    size_t n = 0;
+    for (uint8_t key = 0; key < KEYPAD_KEYS && n + 1 < size; key++) {
+        if ((keys >> key) & 1u) {
+            dst[n++] = keypad_chars[key];
+        }
+    }
+    if (size > 0) {
+        dst[n] = '\0';
+    }
+    return n;
+}
+
+void keypad_get_stats(keypad_stats_t *s) {
+    uint32_t state = hal_irq_save();
+    *s = stats;
+    hal_irq_restore(state);
+}
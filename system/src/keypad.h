@@ -0,0 +1,22 @@
+#ifndef KEYPAD_H
+#define KEYPAD_H
+
+#include "src/hal/hal.h"
+#include "src/event_queue.h"
+
+#define KEYPAD_KEYS (HAL_KEYPAD_ROWS * HAL_KEYPAD_COLS)
+
+typedef struct {
+    uint32_t reports;       // Leituras recebidas da PIO (uma por mudança estável)
+    uint32_t ghosts;        // Leituras ambíguas, com possível tecla fantasma
+} keypad_stats_t;
+
+// Prototipação das funções do teclado matricial
+void keypad_init(hal_pio_t pio, uint sm, event_queue_t *events);
+uint16_t keypad_state(void);
+bool keypad_ambiguous(void);
+char keypad_key_char(uint8_t key);
+size_t keypad_format(uint16_t keys, char *dst, size_t size);
+void keypad_get_stats(keypad_stats_t *stats);
+
+#endif // KEYPAD_H
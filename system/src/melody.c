@@ -0,0 +1,199 @@
+#include "src/melody.h"
+
+/*
+ * Tocador de melodias em segundo plano.
+ *
+ * Cada buzzer tem um canal com a melodia atual e uma fila de espera. As notas
+ * avançam na interrupção de um alarme do timer: o callback programa o PWM da
+ * próxima nota e agenda o alarme seguinte com a duração dela, então a CPU
+ * fica livre durante toda a reprodução.
+ */
+
+typedef struct {
+    const melody_note_t *notes;
+    uint8_t count;
+    uint8_t priority;
+} melody_entry_t;
+
+typedef struct {
+    bool used;
+    uint pin;
+    melody_entry_t current;     // notes == NULL quando ocioso
+    uint8_t index;              // Próxima nota da melodia atual
+    melody_entry_t queue[MELODY_QUEUE_SIZE];
+    uint8_t queue_head, queue_count;
+    int alarm;
+} melody_channel_t;
+
+static melody_channel_t channels[MELODY_CHANNELS];
+
+static melody_channel_t *melody_channel(uint pin) {
+    for (int i = 0; i < MELODY_CHANNELS; i++) {
+        if (channels[i].used && channels[i].pin == pin) {
+            return &channels[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Programa o PWM do pino para a frequência e o ciclo da nota
+ * @note Usa o menor divisor (em passos de 1/16) que mantém o wrap em 16 bits,
+ *       o que dá a maior resolução de ciclo de trabalho para cada frequência
+ */
+static void melody_tone(uint pin, const melody_note_t *note) {
+    if (note->freq_hz == 0) {
+        hal_pwm_enable(pin, false);
+        return;
+    }
+
+    uint64_t clk16 = (uint64_t)hal_clock_sys_hz() * 16;
+    uint64_t per_div = (uint64_t)note->freq_hz * 65536;
+    uint32_t div16 = (uint32_t)((clk16 + per_div - 1) / per_div);
+    if (div16 < 16) {
+        div16 = 16;             // Divisor mínimo 1,0
+    } else if (div16 > 255 * 16 + 15) {
+        div16 = 255 * 16 + 15;  // Divisor máximo 255 + 15/16
+    }
+
+    uint32_t top = (uint32_t)(clk16 / ((uint64_t)div16 * note->freq_hz));  // wrap + 1
+    if (top > 65536) {
+        top = 65536;
+    } else if (top < 2) {
+        top = 2;
+    }
+    uint32_t level = top * (note->duty > 100 ? 100 : note->duty) / 100;
+
+    hal_pwm_configure(pin, div16 / 16.0f, (uint16_t)(top - 1), (uint16_t)level);
+    hal_pwm_enable(pin, true);
+}
+
+static void melody_stop(melody_channel_t *ch) {
+    if (ch->alarm > 0) {
+        hal_alarm_cancel(ch->alarm);
+        ch->alarm = 0;
+    }
+    ch->current.notes = NULL;
+    hal_pwm_enable(ch->pin, false);
+}
+
+/**
+ * @brief Toca a próxima nota ou passa para a próxima melodia da fila
+ * @note Executa na interrupção do alarme (ou com interrupções desabilitadas)
+ */
+static void melody_advance(void *ctx) {
+    melody_channel_t *ch = ctx;
+    ch->alarm = 0;
+
+    if (ch->current.notes != NULL && ch->index >= ch->current.count) {
+        ch->current.notes = NULL;
+    }
+    if (ch->current.notes == NULL) {
+        if (ch->queue_count == 0) {
+            hal_pwm_enable(ch->pin, false);
+            return;
+        }
+        ch->current = ch->queue[ch->queue_head];
+        ch->queue_head = (ch->queue_head + 1) % MELODY_QUEUE_SIZE;
+        ch->queue_count--;
+        ch->index = 0;
+    }
+
+    const melody_note_t *note = &ch->current.notes[ch->index++];
+    melody_tone(ch->pin, note);
+    uint32_t duration_ms = note->duration_ms ? note->duration_ms : 1;
+    ch->alarm = hal_alarm_in_us(duration_ms * 1000u, melody_advance, ch);
+    if (ch->alarm <= 0) {
+        // Sem alarme livre não há como encerrar a nota: interrompe a melodia
+        melody_stop(ch);
+        ch->queue_count = 0;
+    }
+}
+
+/**
+ * @brief Reserva um canal para o buzzer e configura o pino como PWM
+ * @return false se todos os canais estiverem em uso
+ */
+bool melody_init(uint pin) {
+    melody_channel_t *ch = melody_channel(pin);
+    for (int i = 0; ch == NULL && i < MELODY_CHANNELS; i++) {
+        if (!channels[i].used) {
+            ch = &channels[i];
+        }
+    }
+    if (ch == NULL) {
+        return false;
+    }
+    ch->used = true;
+    ch->pin = pin;
+    ch->current.notes = NULL;
+    ch->queue_count = 0;
+    ch->alarm = 0;
+    hal_pwm_init_pin(pin);
+    return true;
+}
+
+/**
+ * @brief Toca uma melodia no buzzer sem bloquear
+ * @param notes Tabela de notas; deve permanecer válida até o fim da reprodução
+ * @param priority Uma prioridade maior que a da melodia atual a interrompe e
+ *                 descarta a fila; caso contrário a melodia entra na fila
+ * @return false se o pino não foi iniciado ou a fila estiver cheia
+ */
+bool melody_play(uint pin, const melody_note_t *notes, size_t count, melody_priority_t priority) {
+    melody_channel_t *ch = melody_channel(pin);
+    if (ch == NULL || count == 0) {
+        return false;
+    }
+
+    bool ok = true;
+    uint32_t state = hal_irq_save();
+    if (ch->current.notes != NULL && priority > ch->current.priority) {
+        melody_stop(ch);
+        ch->queue_count = 0;
+    }
+    if (ch->queue_count < MELODY_QUEUE_SIZE) {
+        melody_entry_t *entry = &ch->queue[(ch->queue_head + ch->queue_count) % MELODY_QUEUE_SIZE];
+        entry->notes = notes;
+        entry->count = count > 255 ? 255 : (uint8_t)count;
+        entry->priority = priority;
+        ch->queue_count++;
+        if (ch->current.notes == NULL) {
+            melody_advance(ch);
+        }
+    } else {
+        ok = false;
+    }
+    hal_irq_restore(state);
+    return ok;
+}
+
+/**
+ * @brief Interrompe a melodia atual e descarta as que estavam na fila
+ */
+void melody_cancel(uint pin) {
+    melody_channel_t *ch = melody_channel(pin);
+    if (ch == NULL) {
+        return;
+    }
+    uint32_t state = hal_irq_save();
+    melody_stop(ch);
+    ch->queue_count = 0;
+    hal_irq_restore(state);
+}
+
+bool melody_busy(uint pin) {
+    melody_channel_t *ch = melody_channel(pin);
+    return ch != NULL && ch->current.notes != NULL;
+}
+
+/**
+ * @brief Soma a duração das notas, para quem precisa aguardar o fim da melodia
+ */
+uint32_t melody_duration_ms(const melody_note_t *notes, size_t count) {
+    uint32_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += notes[i].duration_ms;
+    }
+    return total;
+}
@@ -0,0 +1,28 @@
+#ifndef MELODY_H
+#define MELODY_H
+
+#include "src/hal/hal.h"
+
+#define MELODY_CHANNELS   2     // Buzzers controlados simultaneamente
+#define MELODY_QUEUE_SIZE 4     // Melodias aguardando em cada buzzer
+
+typedef struct {
+    uint16_t freq_hz;           // 0 para pausa
+    uint16_t duration_ms;
+    uint8_t duty;               // Ciclo de trabalho em % (0 a 100)
+} melody_note_t;
+
+typedef enum {
+    MELODY_PRIO_LOW,
+    MELODY_PRIO_NORMAL,
+    MELODY_PRIO_HIGH
+} melody_priority_t;
+
+// Prototipação das funções do tocador de melodias
+bool melody_init(uint pin);
+bool melody_play(uint pin, const melody_note_t *notes, size_t count, melody_priority_t priority);
+void melody_cancel(uint pin);
+bool melody_busy(uint pin);
+uint32_t melody_duration_ms(const melody_note_t *notes, size_t count);
+
+#endif // MELODY_H
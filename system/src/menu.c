@@ -1,6 +1,8 @@
 #include "src/menu.h"
 #include "src/hardwareFiles/buttons.h"
 #include "src/display.h"    // Para usar as funções do display e a variável 'ssd'
+#include "src/ui.h"
+#include "src/joystick.h"
 #include <stdio.h>
 
 // Array estático com os itens do menu
@@ -19,8 +21,13 @@ void init_menu(void) {
     selected_menu = 0;
 }
 
-// Desenha o menu no display OLED
+// Solicita ao núcleo 1 o redesenho do menu com a seleção atual
 void draw_menu(void) {
+    ui_menu(selected_menu);
+}
+
+// Desenha o menu no display OLED (executa no núcleo 1)
+void menu_draw(uint8_t selected) {
     // Limpa o display
     ssd1306_fill(&ssd, false);
     ssd1306_rect(&ssd, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, 1, 0);
@@ -32,7 +39,7 @@ void draw_menu(void) {
     for (uint8_t i = 0; i < MENU_COUNT; i++) {
         uint8_t y = 24 + i * (MENU_ITEM_HEIGHT + MENU_ITEM_SPACING);
         // Se for o item selecionado, exibe um indicador (por exemplo, "7")
-        if (i == selected_menu) {
+        if (i == selected) {
             ssd1306_draw_string(&ssd, "7", 8, y);
         } else {
             ssd1306_draw_string(&ssd, "  ", 0, y);
@@ -40,19 +47,27 @@ void draw_menu(void) {
         // Exibe o texto do item a partir da posição x=16
         ssd1306_draw_string(&ssd, menu_items[i], 20, y);
     }
-    ssd1306_send_data(&ssd);
+    // Só transfere as páginas alteradas; redesenhar o mesmo menu não gera tráfego I2C
+    ssd1306_flush_async(&ssd);
 }
 
-// Atualiza o item selecionado no menu com base na direção (negativo: cima, positivo: baixo)
-void update_menu_selection(int direction) {
-    if (direction < 0) {
+// Atualiza o item selecionado a partir de um evento de navegação do joystick
+// Retorna true se a seleção mudou
+bool update_menu_selection(const event_t *ev) {
+    if (ev->type != EVENT_NAV) {
+        return false;
+    }
+    if (ev->source == JOYSTICK_UP) {
         if (selected_menu == 0)
             selected_menu = MENU_COUNT - 1;
         else
             selected_menu--;
-    } else if (direction > 0) {
+    } else if (ev->source == JOYSTICK_DOWN) {
         selected_menu = (selected_menu + 1) % MENU_COUNT;
+    } else {
+        return false;
     }
+    return true;
 }
 // Retorna o item atualmente selecionado
 uint8_t get_selected_menu(void) {
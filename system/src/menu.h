@@ -2,6 +2,7 @@
 #define MENU_H
 
 #include <stdint.h>
+#include "src/event_queue.h"
 
 // Número de itens do menu e configurações de layout
 #define MENU_COUNT 4
@@ -11,7 +12,8 @@
 // Prototipação das funções do módulo de menu
 void init_menu(void);
 void draw_menu(void);
-void update_menu_selection(int direction);
+void menu_draw(uint8_t selected);
+bool update_menu_selection(const event_t *ev);
 void execute_menu_action(uint8_t menu_index);
 uint8_t get_selected_menu(void);
 
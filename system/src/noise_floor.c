@@ -0,0 +1,144 @@
+#include "src/noise_floor.h"
+#include "src/audio_features.h"
+
+/*
+ * Estimador adaptativo do ruído de fundo do microfone.
+ *
+ * Recebe o RMS de cada quadro de áudio e mantém média e variância móveis
+ * (exponenciais) apenas dos quadros considerados ruído. Os primeiros
+ * 2^NOISE_EMA_SHIFT quadros usam média acumulada, o que calibra o piso logo
+ * após a inicialização. A fala começa quando NOISE_ONSET_FRAMES quadros
+ * seguidos passam de piso + K_ON·sigma (o instante de início é o do primeiro
+ * deles) e termina após NOISE_HANG_FRAMES quadros abaixo de piso + K_OFF·sigma.
+ * Quadros de fala não alteram o piso; se a "fala" durar demais, o nível é
+ * tratado como novo ruído e a calibração recomeça.
+ */
+
+#define NOISE_CALIB_FRAMES 16       // Quadros iniciais sem detecção (~0,5 s)
+
+// log2(x) em Q8, com correção quadrática da mantissa
+static int32_t log2_q8(uint32_t x) {
+    if (x == 0) {
+        return 0;
+    }
+    int32_t msb = 31 - __builtin_clz(x);
+    uint32_t f = (msb >= 8 ? x >> (msb - 8) : x << (8 - msb)) & 255;
+    return msb * 256 + (int32_t)(f + ((f * (256 - f) * 88) >> 16));
+}
+
+// Incorpora um quadro de ruído à média e à variância
+static void noise_learn(noise_floor_t *nf, uint16_t rms) {
+    int32_t diff = ((int32_t)rms << 8) - nf->mean_q8;
+    int64_t sq_q8 = ((int64_t)diff * diff) >> 8;
+    if (nf->frames < (1u << NOISE_EMA_SHIFT)) {
+        uint32_t n = nf->frames + 1;
+        nf->mean_q8 += diff / (int32_t)n;
+        nf->var_q8 += (sq_q8 - nf->var_q8) / (int64_t)n;
+    } else {
+        nf->mean_q8 += diff >> NOISE_EMA_SHIFT;
+        nf->var_q8 += (sq_q8 - nf->var_q8) >> NOISE_EMA_SHIFT;
+    }
+    if (nf->frames < UINT32_MAX) {
+        nf->frames++;
+    }
+}
+
+static uint16_t noise_margin(const noise_floor_t *nf, uint32_t k_q4) {
+    uint32_t margin = (k_q4 * audio_isqrt((uint64_t)nf->var_q8) + 128) >> 8;
+    return margin < NOISE_MIN_MARGIN ? NOISE_MIN_MARGIN : (uint16_t)margin;
+}
+
+/**
+ * @brief Zera o estimador; o piso é recalibrado pelos próximos quadros
+ */
+void noise_floor_init(noise_floor_t *nf) {
+    nf->mean_q8 = 0;
+    nf->var_q8 = 0;
+    nf->frames = 0;
+    nf->active = false;
+    nf->run = 0;
+    nf->active_frames = 0;
+    nf->candidate_us = 0;
+    nf->onset_us = 0;
+    nf->onsets = 0;
+}
+
+/**
+ * @brief Processa o RMS de um quadro
+ * @param frame_start_us Instante da primeira amostra do quadro
+ * @return true se este quadro confirmou o início de uma fala (ver onset_us)
+ */
+bool noise_floor_update(noise_floor_t *nf, uint16_t rms, uint32_t frame_start_us) {
+    if (nf->frames < NOISE_CALIB_FRAMES) {
+        noise_learn(nf, rms);
+        return false;
+    }
+
+    if (!nf->active) {
+        if (rms <= noise_floor_threshold(nf)) {
+            nf->run = 0;
+            noise_learn(nf, rms);
+            return false;
+        }
+        if (nf->run++ == 0) {
+            nf->candidate_us = frame_start_us;
+        }
+        if (nf->run < NOISE_ONSET_FRAMES) {
+            return false;
+        }
+        nf->active = true;
+        nf->run = 0;
+        nf->active_frames = NOISE_ONSET_FRAMES;
+        nf->onset_us = nf->candidate_us;
+        nf->onsets++;
+        return true;
+    }
+
+    nf->active_frames++;
+    if (rms < noise_floor_level(nf) + noise_margin(nf, NOISE_K_OFF_Q4)) {
+        if (++nf->run >= NOISE_HANG_FRAMES) {
+            nf->active = false;
+            nf->run = 0;
+        }
+    } else {
+        nf->run = 0;
+    }
+    if (nf->active && nf->active_frames >= NOISE_STUCK_FRAMES) {
+        // Nível alto e estável: o ambiente mudou, não é fala
+        nf->active = false;
+        nf->run = 0;
+        nf->frames = 0;
+    }
+    return false;
+}
+
+/**
+ * @brief Piso de ruído atual (RMS em contagens do ADC)
+ */
+uint16_t noise_floor_level(const noise_floor_t *nf) {
+    return (uint16_t)((nf->mean_q8 + 128) >> 8);
+}
+
+/**
+ * @brief Desvio padrão do RMS do ruído (contagens do ADC)
+ */
+uint16_t noise_floor_sigma(const noise_floor_t *nf) {
+    return (uint16_t)((audio_isqrt((uint64_t)nf->var_q8) + 8) >> 4);
+}
+
+/**
+ * @brief RMS a partir do qual um quadro inicia uma fala
+ */
+uint16_t noise_floor_threshold(const noise_floor_t *nf) {
+    return noise_floor_level(nf) + noise_margin(nf, NOISE_K_ON_Q4);
+}
+
+/**
+ * @brief Relação sinal-ruído de um RMS em relação ao piso, em décimos de dB
+ */
+int32_t noise_floor_snr_db10(const noise_floor_t *nf, uint16_t rms) {
+    uint32_t floor_q8 = nf->mean_q8 > 256 ? (uint32_t)nf->mean_q8 : 256;
+    uint32_t rms_q8 = rms > 0 ? (uint32_t)rms << 8 : 1;
+    // 20·log10(r) = 6,0206·log2(r)
+    return (log2_q8(rms_q8) - log2_q8(floor_q8)) * 60206 / 256000;
+}
@@ -0,0 +1,38 @@
+#ifndef NOISE_FLOOR_H
+#define NOISE_FLOOR_H
+
+#include "src/hal/hal.h"
+
+// Média móvel exponencial com peso 1/2^6 por quadro (~2 s com quadros de 32 ms)
+#define NOISE_EMA_SHIFT     6
+
+// Limiares de atividade: piso + k·sigma (k em Q4), com histerese
+#define NOISE_K_ON_Q4       (4 * 16)
+#define NOISE_K_OFF_Q4      (2 * 16)
+#define NOISE_MIN_MARGIN    6       // Margem mínima acima do piso (contagens do ADC)
+
+#define NOISE_ONSET_FRAMES  2       // Quadros seguidos acima do limiar para iniciar fala
+#define NOISE_HANG_FRAMES   8       // Quadros seguidos abaixo do limiar para encerrar fala
+#define NOISE_STUCK_FRAMES  160     // Fala contínua por ~5 s é tratada como novo ruído
+
+typedef struct {
+    int32_t mean_q8;            // Piso de ruído (RMS médio) em Q8
+    int64_t var_q8;             // Variância do RMS em Q8
+    uint32_t frames;            // Quadros de ruído já incorporados
+    bool active;                // Fala em andamento
+    uint16_t run;               // Quadros seguidos do lado oposto ao estado atual
+    uint16_t active_frames;
+    uint32_t candidate_us;      // Início do primeiro quadro acima do limiar
+    uint32_t onset_us;          // Início da fala em andamento (ou da última)
+    uint32_t onsets;            // Falas detectadas desde a inicialização
+} noise_floor_t;
+
+// Prototipação das funções do estimador de ruído
+void noise_floor_init(noise_floor_t *nf);
+bool noise_floor_update(noise_floor_t *nf, uint16_t rms, uint32_t frame_start_us);
+uint16_t noise_floor_level(const noise_floor_t *nf);
+uint16_t noise_floor_sigma(const noise_floor_t *nf);
+uint16_t noise_floor_threshold(const noise_floor_t *nf);
+int32_t noise_floor_snr_db10(const noise_floor_t *nf, uint16_t rms);
+
+#endif // NOISE_FLOOR_H
@@ -0,0 +1,103 @@
+#include "src/profiler.h"
+
+#include <string.h>
+
+/*
+ * Perfilador por amostragem.
+ *
+ * Uma interrupção periódica de alta prioridade (hal_pc_sampler_start) lê o
+ * PC interrompido no quadro empilhado pela exceção e o conta num histograma
+ * de endereços: tabela aberta de PROFILER_SLOTS posições, sondagem linear
+ * curta e nenhuma trava, já que só a interrupção escreve enquanto a
+ * amostragem está ligada. O tempo gasto em cada função sai da proporção de
+ * amostras nos seus endereços, sem instrumentar o código; a associação
+ * endereço -> função é feita no host, contra o ELF (host/profile_report.c).
+ *
+ * Só o núcleo 0 é amostrado. A leitura do histograma (profiler_entry) deve
+ * ser feita com a amostragem desligada.
+ */
+
+typedef struct {
+    uintptr_t pc;                   // 0: posição livre
+    uint32_t count;
+} profiler_slot_t;
+
+static profiler_slot_t slots[PROFILER_SLOTS];
+static volatile uint32_t samples, lost, addresses;
+static uint32_t sample_period_us;
+static bool running;
+
+static void profiler_sample(uintptr_t pc) {
+    // Endereços Thumb são pares: o bit 0 não entra no hash
+    uint32_t h = (uint32_t)(pc >> 1) * 2654435761u;
+    uint32_t index = h >> (32 - PROFILER_SLOT_BITS);
+    for (int i = 0; i < PROFILER_PROBES; i++) {
+        profiler_slot_t *s = &slots[(index + i) & (PROFILER_SLOTS - 1)];
+        if (s->pc == pc) {
+            s->count++;
+            samples++;
+            return;
+        }
+        if (s->pc == 0) {
+            s->pc = pc;
+            s->count = 1;
+            samples++;
+            addresses++;
+            return;
+        }
+    }
+    lost++;
+}
+
+/**
+ * @brief Zera o histograma e liga a amostragem
+ * @param period_us Intervalo entre amostras (mínimo PROFILER_MIN_US)
+ * @return false se já estiver ligada ou se não houver temporizador livre
+ */
+bool profiler_start(uint32_t period_us) {
+    if (running) {
+        return false;
+    }
+    memset(slots, 0, sizeof(slots));
+    samples = lost = addresses = 0;
+    sample_period_us = period_us < PROFILER_MIN_US ? PROFILER_MIN_US : period_us;
+    running = hal_pc_sampler_start(sample_period_us, profiler_sample);
+    return running;
+}
+
+void profiler_stop(void) {
+    if (running) {
+        hal_pc_sampler_stop();
+        running = false;
+    }
+}
+
+void profiler_get_stats(profiler_stats_t *stats) {
+    stats->samples = samples;
+    stats->lost = lost;
+    stats->addresses = addresses;
+    stats->period_us = sample_period_us;
+    stats->running = running;
+}
+
+/**
+ * @brief Lê uma posição do histograma
+ * @return false se a posição estiver livre
+ */
+bool profiler_entry(uint32_t slot, uintptr_t *pc, uint32_t *count) {
+    if (slot >= PROFILER_SLOTS || slots[slot].pc == 0) {
+        return false;
+    }
+    *pc = slots[slot].pc;
+    *count = slots[slot].count;
+    return true;
+}
+
+/**
+ * @brief Endereço de profiler_start em execução
+ * @note Enviado junto com o histograma; o host compara com o endereço no ELF
+ *       para descontar a relocação (no simulador, o executável é PIE)
+ */
+uintptr_t profiler_anchor(void) {
+    return (uintptr_t)profiler_start;
+}
@@ -0,0 +1,27 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "src/hal/hal.h"
+
+#define PROFILER_SLOT_BITS  10
+#define PROFILER_SLOTS      (1u << PROFILER_SLOT_BITS)  // Endereços distintos no histograma
+#define PROFILER_PROBES     8       // Posições tentadas antes de descartar a amostra
+#define PROFILER_DEFAULT_US 1000    // Período de amostragem padrão
+#define PROFILER_MIN_US     100
+
+typedef struct {
+    uint32_t samples;               // Amostras guardadas no histograma
+    uint32_t lost;                  // Amostras descartadas com o histograma cheio
+    uint32_t addresses;             // Endereços distintos
+    uint32_t period_us;
+    bool running;
+} profiler_stats_t;
+
+// Prototipação das funções do perfilador por amostragem
+bool profiler_start(uint32_t period_us);
+void profiler_stop(void);
+void profiler_get_stats(profiler_stats_t *stats);
+bool profiler_entry(uint32_t slot, uintptr_t *pc, uint32_t *count);
+uintptr_t profiler_anchor(void);
+
+#endif // PROFILER_H
@@ -0,0 +1,175 @@
+#include "src/scheduler.h"
+#include "src/trace.h"
+
+/*
+ * Escalonador cooperativo baseado em prazos.
+ *
+ * Cada tarefa é uma função curta que nunca bloqueia; fluxos longos são
+ * máquinas de estados que reagendam o próprio passo com o atraso que antes
+ * era um busy_wait_ms. Entre prazos o núcleo dorme em hal_wait_until(), que
+ * usa um alarme do timer de hardware e acorda também com qualquer interrupção.
+ */
+
+typedef struct {
+    sched_task_t task;
+    void *ctx;
+    uint64_t deadline_us;
+    uint32_t period_us;     // 0 para tarefas únicas
+} sched_slot_t;
+
+static sched_slot_t slots[SCHED_MAX_TASKS];
+static uint64_t wake_us;        // Instante em que o núcleo acordou pela última vez
+static sched_stats_t stats;
+
+// Procura a tarefa (task, ctx); chamada com interrupções desabilitadas
+static sched_slot_t *sched_find(sched_task_t task, void *ctx) {
+    for (int i = 0; i < SCHED_MAX_TASKS; i++) {
+        if (slots[i].task == task && slots[i].ctx == ctx) {
+            return &slots[i];
+        }
+    }
+    return NULL;
+}
+
+static bool sched_add(sched_task_t task, void *ctx, uint32_t delay_ms, uint32_t period_ms) {
+    uint64_t deadline = hal_time_us_64() + (uint64_t)delay_ms * 1000u;
+    uint32_t state = hal_irq_save();
+
+    // Reagendar uma tarefa já pendente substitui o prazo anterior
+    sched_slot_t *slot = sched_find(task, ctx);
+    if (slot == NULL) {
+        slot = sched_find(NULL, NULL);
+    }
+    if (slot != NULL) {
+        slot->task = task;
+        slot->ctx = ctx;
+        slot->deadline_us = deadline;
+        slot->period_us = period_ms * 1000u;
+    }
+
+    hal_irq_restore(state);
+    return slot != NULL;
+}
+
+/**
+ * @brief Limpa a fila de tarefas
+ */
+void sched_init(void) {
+    uint32_t state = hal_irq_save();
+    for (int i = 0; i < SCHED_MAX_TASKS; i++) {
+        slots[i].task = NULL;
+        slots[i].ctx = NULL;
+    }
+    hal_irq_restore(state);
+    wake_us = hal_time_us_64();
+    sched_get_stats(NULL, true);
+}
+
+/**
+ * @brief Agenda uma execução única de task após delay_ms
+ * @return false se a fila estiver cheia
+ * @note Se (task, ctx) já estiver pendente, apenas o prazo é atualizado.
+ *       Pode ser chamada de interrupções.
+ */
+bool sched_post(sched_task_t task, void *ctx, uint32_t delay_ms) {
+    return sched_add(task, ctx, delay_ms, 0);
+}
+
+/**
+ * @brief Agenda task para executar a cada period_ms
+ * @return false se a fila estiver cheia
+ */
+bool sched_every(sched_task_t task, void *ctx, uint32_t period_ms) {
+    return sched_add(task, ctx, period_ms, period_ms);
+}
+
+/**
+ * @brief Remove (task, ctx) da fila, se estiver pendente
+ */
+void sched_cancel(sched_task_t task, void *ctx) {
+    uint32_t state = hal_irq_save();
+    sched_slot_t *slot = sched_find(task, ctx);
+    if (slot != NULL) {
+        slot->task = NULL;
+        slot->ctx = NULL;
+    }
+    hal_irq_restore(state);
+}
+
+bool sched_pending(sched_task_t task, void *ctx) {
+    uint32_t state = hal_irq_save();
+    bool pending = sched_find(task, ctx) != NULL;
+    hal_irq_restore(state);
+    return pending;
+}
+
+/**
+ * @brief Executa as tarefas vencidas, em ordem de prazo, e dorme até o próximo
+ * @note Deve ser chamada continuamente pelo laço principal
+ */
+void sched_run(void) {
+    while (true) {
+        uint64_t now = hal_time_us_64();
+        uint64_t next_deadline = UINT64_MAX;
+        sched_slot_t *due = NULL;
+
+        uint32_t state = hal_irq_save();
+        for (int i = 0; i < SCHED_MAX_TASKS; i++) {
+            if (slots[i].task != NULL && slots[i].deadline_us < next_deadline) {
+                next_deadline = slots[i].deadline_us;
+                due = &slots[i];
+            }
+        }
+        if (due == NULL || due->deadline_us > now) {
+            hal_irq_restore(state);
+
+            // Tudo desde o último despertar (inclusive o trabalho do laço principal) conta como ocupado
+            uint32_t busy = (uint32_t)(now - wake_us);
+            stats.total_busy_us += busy;
+            stats.passes++;
+            if (busy > stats.max_busy_us) {
+                stats.max_busy_us = busy;
+            }
+
+            // Sem tarefas, acorda periodicamente só para reavaliar a fila
+            hal_wait_until(due != NULL ? next_deadline : now + 100000u);
+            wake_us = hal_time_us_64();
+            return;
+        }
+
+        sched_task_t task = due->task;
+        void *ctx = due->ctx;
+        if (due->period_us) {
+            // Tarefas periódicas mantêm a cadência, sem acumular atrasos
+            due->deadline_us += due->period_us;
+            if (due->deadline_us <= now) {
+                due->deadline_us = now + due->period_us;
+            }
+        } else {
+            due->task = NULL;
+            due->ctx = NULL;
+        }
+        int slot = (int)(due - slots);
+        hal_irq_restore(state);
+
+        TRACE_BEGIN(SCHED_TASK, slot);
+        task(ctx);
+        TRACE_END(SCHED_TASK, slot);
+    }
+}
+
+/**
+ * @brief Copia as estatísticas de latência do laço
+ * @param out Destino (pode ser NULL)
+ * @param reset Zera as estatísticas após a leitura
+ */
+void sched_get_stats(sched_stats_t *out, bool reset) {
+    if (out != NULL) {
+        *out = stats;
+    }
+    if (reset) {
+        stats.max_busy_us = 0;
+        stats.total_busy_us = 0;
+        stats.passes = 0;
+    }
+}
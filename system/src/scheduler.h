@@ -0,0 +1,27 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "src/hal/hal.h"
+
+// Número máximo de tarefas pendentes (periódicas + únicas)
+#define SCHED_MAX_TASKS 16
+
+typedef void (*sched_task_t)(void *ctx);
+
+// Latência do laço: trechos em que o núcleo trabalha sem voltar a dormir
+typedef struct {
+    uint32_t max_busy_us;     // Maior trecho ocupado (pior latência de resposta)
+    uint64_t total_busy_us;
+    uint32_t passes;          // Número de trechos medidos
+} sched_stats_t;
+
+// Prototipação das funções do escalonador cooperativo
+void sched_init(void);
+bool sched_post(sched_task_t task, void *ctx, uint32_t delay_ms);
+bool sched_every(sched_task_t task, void *ctx, uint32_t period_ms);
+void sched_cancel(sched_task_t task, void *ctx);
+bool sched_pending(sched_task_t task, void *ctx);
+void sched_run(void);
+void sched_get_stats(sched_stats_t *out, bool reset);
+
+#endif // SCHEDULER_H
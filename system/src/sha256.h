@@ -0,0 +1,21 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include "src/hal/hal.h"
+
+#define SHA256_DIGEST_SIZE 32
+#define SHA256_BLOCK_SIZE  64
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;        // Bytes processados
+    uint8_t block[SHA256_BLOCK_SIZE];
+    uint8_t used;           // Bytes pendentes em block
+} sha256_t;
+
+// Prototipação das funções de SHA-256
+void sha256_init(sha256_t *ctx);
+void sha256_update(sha256_t *ctx, const void *data, size_t len);
+void sha256_final(sha256_t *ctx, uint8_t digest[SHA256_DIGEST_SIZE]);
+
+#endif // SHA256_H
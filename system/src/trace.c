@@ -0,0 +1,122 @@
+#include "src/trace.h"
+
+/*
+ * Pontos de rastreamento enviados pela UART.
+ *
+ * Cada núcleo grava seus registros (tempo do timer de 1 MHz, id, fase e um
+ * argumento de 16 bits) num anel próprio, sem travas entre os núcleos:
+ * trace_emit() é o único produtor do anel do núcleo em que roda e
+ * trace_drain(), no laço principal do núcleo 0, o único consumidor dos dois.
+ *
+ * trace_drain() codifica os registros em quadros compactos (tempo como delta
+ * do quadro anterior do mesmo núcleo, em varint) e os entrega à UART por DMA,
+ * sem esperar a transmissão. Com o DMA ainda ocupado os registros esperam no
+ * anel; com o anel cheio são descartados e contados, e a contagem segue num
+ * quadro TRACE_DROPPED. O texto do stdio pode se intercalar com os quadros
+ * na mesma UART: o conversor do host (host/trace_to_json.c) procura o byte de
+ * sincronismo, descarta quadros com a soma errada e retoma os deltas no
+ * próximo tempo absoluto, enviado a cada TRACE_ABS_EVERY quadros.
+ */
+
+#if TRACE_ENABLED
+
+typedef struct {
+    uint32_t last_us;               // Tempo do último quadro enviado
+    uint32_t dropped_sent;          // Perdas já informadas
+    uint8_t since_abs;              // Quadros desde o último tempo absoluto
+} trace_core_t;
+
+trace_ring_t trace_rings[2];
+
+static trace_core_t cores[2];
+static uint8_t tx_buffer[TRACE_TX_BYTES];
+static int tx_stream = -1;
+static uint8_t next_core;
+
+static uint8_t *put_varint(uint8_t *p, uint32_t value) {
+    while (value >= 0x80) {
+        *p++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+static size_t encode_frame(uint8_t *dst, uint core, uint32_t time_us, uint32_t tag) {
+    trace_core_t *c = &cores[core];
+    bool absolute = c->since_abs == 0;
+    uint8_t *p = dst;
+    *p++ = TRACE_SYNC;
+    *p++ = (core ? TRACE_HDR_CORE1 : 0) | (absolute ? TRACE_HDR_ABS : 0) | ((tag >> 8) & TRACE_HDR_PHASE);
+    *p++ = (uint8_t)tag;
+    p = put_varint(p, absolute ? time_us : time_us - c->last_us);
+    p = put_varint(p, tag >> 16);
+
+    uint8_t sum = 0;
+    for (const uint8_t *q = dst + 1; q < p; q++) {
+        sum += *q;
+    }
+    *p++ = (uint8_t)~sum;
+
+    c->last_us = time_us;
+    c->since_abs = (uint8_t)((c->since_abs + 1) % TRACE_ABS_EVERY);
+    return (size_t)(p - dst);
+}
+
+// Codifica o próximo registro do núcleo, ou a contagem de perdas com o anel vazio
+static size_t drain_one(uint core, uint8_t *dst) {
+    trace_ring_t *r = &trace_rings[core];
+    trace_core_t *c = &cores[core];
+    uint32_t tail = r->tail;
+    if (tail != __atomic_load_n(&r->head, __ATOMIC_ACQUIRE)) {
+        trace_record_t rec = r->records[tail & (TRACE_RING_SIZE - 1)];
+        __atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+        return encode_frame(dst, core, rec.time_us, rec.tag);
+    }
+
+    // As perdas ocorreram depois do último registro enviado
+    uint32_t lost = __atomic_load_n(&r->dropped, __ATOMIC_RELAXED) - c->dropped_sent;
+    if (lost == 0) {
+        return 0;
+    }
+    if (lost > UINT16_MAX) {
+        lost = UINT16_MAX;
+    }
+    c->dropped_sent += lost;
+    return encode_frame(dst, core, c->last_us,
+                        TRACE_DROPPED | (uint32_t)TRACE_PHASE_INSTANT << 8 | lost << 16);
+}
+
+/**
+ * @brief Reserva o DMA de envio dos registros
+ * @param uart UART já inicializada com hal_uart_init
+ */
+void trace_init(uint uart) {
+    tx_stream = hal_uart_stream_claim(uart);
+}
+
+/**
+ * @brief Envia pela UART os registros pendentes dos dois núcleos (tarefa periódica)
+ * @note Cada chamada envia até TRACE_TX_BYTES; a UART a 250 kbaud leva ~10 ms para isso
+ */
+void trace_drain(void *ctx) {
+    (void)ctx;
+    if (tx_stream < 0 || hal_uart_stream_busy(tx_stream)) {
+        return;
+    }
+
+    // Alterna entre os núcleos para que nenhum monopolize o envio
+    size_t len = 0;
+    uint8_t idle = 0;
+    while (idle < 2 && len + TRACE_FRAME_MAX <= sizeof(tx_buffer)) {
+        size_t n = drain_one(next_core, tx_buffer + len);
+        next_core ^= 1;
+        idle = n ? 0 : idle + 1;
+        len += n;
+    }
+    if (len > 0) {
+        hal_uart_stream_start(tx_stream, tx_buffer, len);
+    }
+}
+
+#endif // TRACE_ENABLED
@@ -0,0 +1,107 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "src/hal/hal.h"
+
+// 1: pontos de rastreamento gravados e enviados pela UART; 0: macros sem código
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+
+// Pontos de rastreamento: X(id, nome). O nome é usado pelo conversor do host
+#define TRACE_IDS(X)                            \
+    X(DROPPED,         "registros perdidos")    \
+    X(SCHED_TASK,      "tarefa")                \
+    X(DEBOUNCE_IRQ,    "debouncer")             \
+    X(UART_RX_IRQ,     "uart rx")               \
+    X(KEYPAD_IRQ,      "teclado")               \
+    X(OLED_SEND,       "ssd1306_send_data")     \
+    X(OLED_FLUSH,      "ssd1306 i2c dma")       \
+    X(UI,              "interface (núcleo 1)")  \
+    X(ACCESS_CHECK,    "acesso: senha")         \
+    X(ACCESS_VOICE,    "acesso: voz")           \
+    X(ACCESS_SCORE,    "acesso: voiceprint")    \
+    X(ACCESS_IRIS,     "acesso: íris")          \
+    X(ACCESS_DECISION, "acesso: decisão")
+
+#define TRACE_ID_ENUM(id, name) TRACE_##id,
+typedef enum { TRACE_IDS(TRACE_ID_ENUM) TRACE_ID_COUNT } trace_id_t;
+#undef TRACE_ID_ENUM
+
+// Fases, no sentido do formato de trace do Chrome
+#define TRACE_PHASE_INSTANT     0       // Evento pontual
+#define TRACE_PHASE_BEGIN       1       // Início de trecho no mesmo núcleo (aninha)
+#define TRACE_PHASE_END         2
+#define TRACE_PHASE_ASYNC_BEGIN 3       // Início de operação que termina em outro contexto
+#define TRACE_PHASE_ASYNC_END   4
+
+#define TRACE_RING_SIZE 256             // Registros por núcleo (potência de 2)
+#define TRACE_TX_BYTES  256             // Bytes enviados por vez pela UART
+#define TRACE_DRAIN_MS  10              // Período de trace_drain (TRACE_TX_BYTES a 250 kbaud)
+
+// Formato na UART, um quadro por registro:
+//   TRACE_SYNC, cabeçalho, id, tempo (varint), arg (varint), soma de verificação
+// cabeçalho: bit 7 núcleo, bit 6 tempo absoluto (senão, delta do quadro anterior
+// do mesmo núcleo), bits 0..2 fase. A soma é o complemento da soma dos bytes
+// entre TRACE_SYNC e ela
+#define TRACE_SYNC        0xA5
+#define TRACE_HDR_CORE1   0x80
+#define TRACE_HDR_ABS     0x40
+#define TRACE_HDR_PHASE   0x07
+#define TRACE_FRAME_MAX   14
+#define TRACE_ABS_EVERY   32            // Quadros entre dois tempos absolutos
+
+typedef struct {
+    uint32_t time_us;
+    uint32_t tag;                       // id | fase << 8 | arg << 16
+} trace_record_t;
+
+typedef struct {
+    trace_record_t records[TRACE_RING_SIZE];
+    uint32_t head;                      // Escrito apenas pelo próprio núcleo
+    uint32_t tail;                      // Escrito apenas por trace_drain
+    uint32_t dropped;                   // Registros descartados com o anel cheio
+} trace_ring_t;
+
+extern trace_ring_t trace_rings[2];
+
+/*
+ * Grava um registro no anel do núcleo atual. O anel só tem um produtor por
+ * núcleo; as interrupções ficam bloqueadas pelas poucas instruções da escrita
+ * para que uma interrupção no meio não reserve a mesma posição.
+ */
+static inline void trace_emit(uint8_t id, uint8_t phase, uint16_t arg) {
+    trace_ring_t *r = &trace_rings[HAL_CORE_NUM()];
+    uint32_t state = HAL_IRQ_SAVE_INLINE();
+    uint32_t head = r->head;
+    if (head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) < TRACE_RING_SIZE) {
+        trace_record_t *rec = &r->records[head & (TRACE_RING_SIZE - 1)];
+        rec->time_us = HAL_TRACE_TIME_US();
+        rec->tag = id | (uint32_t)phase << 8 | (uint32_t)arg << 16;
+        __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+    } else {
+        r->dropped++;
+    }
+    HAL_IRQ_RESTORE_INLINE(state);
+}
+
+#if TRACE_ENABLED
+#define TRACE_INSTANT(id, arg)     trace_emit(TRACE_##id, TRACE_PHASE_INSTANT, (uint16_t)(arg))
+#define TRACE_BEGIN(id, arg)       trace_emit(TRACE_##id, TRACE_PHASE_BEGIN, (uint16_t)(arg))
+#define TRACE_END(id, arg)         trace_emit(TRACE_##id, TRACE_PHASE_END, (uint16_t)(arg))
+#define TRACE_ASYNC_BEGIN(id, arg) trace_emit(TRACE_##id, TRACE_PHASE_ASYNC_BEGIN, (uint16_t)(arg))
+#define TRACE_ASYNC_END(id, arg)   trace_emit(TRACE_##id, TRACE_PHASE_ASYNC_END, (uint16_t)(arg))
+#else
+// sizeof não avalia o argumento, mas conta as variáveis usadas só nele como usadas
+#define TRACE_INSTANT(id, arg)     ((void)sizeof(arg))
+#define TRACE_BEGIN(id, arg)       ((void)sizeof(arg))
+#define TRACE_END(id, arg)         ((void)sizeof(arg))
+#define TRACE_ASYNC_BEGIN(id, arg) ((void)sizeof(arg))
+#define TRACE_ASYNC_END(id, arg)   ((void)sizeof(arg))
+#endif
+
+// Prototipação das funções de envio dos registros
+void trace_init(uint uart);
+void trace_drain(void *ctx);
+
+#endif // TRACE_H
@@ -0,0 +1,143 @@
+#include "src/ui.h"
+#include "src/display.h"
+#include "src/menu.h"
+#include "src/hardwareFiles/Led_Matrix.h"
+#include "src/trace.h"
+#include <string.h>
+
+/*
+ * Interface entre o núcleo 0 (entrada, escalonador e fluxos) e o núcleo 1
+ * (display OLED e matriz WS2812).
+ *
+ * O núcleo 0 copia cada comando para uma fila circular de um produtor e um
+ * consumidor e acorda o núcleo 1 (hal_core1_signal). O núcleo 1 esvazia
+ * a fila e desenha só o último comando de cada destino: mensagens e menu
+ * redesenham a tela inteira, e um frame da matriz substitui o anterior.
+ */
+
+static void ui_render(const ui_cmd_t *cmd) {
+    switch (cmd->type) {
+        case UI_CMD_MESSAGE:
+            display_draw_message(cmd->lines[0], cmd->lines[1], cmd->lines[2]);
+            break;
+        case UI_CMD_MENU:
+            menu_draw(cmd->menu_selected);
+            break;
+        case UI_CMD_DISPLAY_OFF:
+            display_draw_off();
+            break;
+        case UI_CMD_MATRIX:
+            matrix_draw(cmd->frame);
+            break;
+    }
+}
+
+#if UI_CORE1
+#define UI_QUEUE_MASK (UI_QUEUE_SIZE - 1)
+
+static ui_cmd_t queue[UI_QUEUE_SIZE];
+static uint32_t queue_head;   // Escrito apenas pelo núcleo 0
+static uint32_t queue_tail;   // Escrito apenas pelo núcleo 1
+
+/**
+ * @brief Consome os comandos pendentes (executa no núcleo 1)
+ */
+static void ui_process(void *ctx) {
+    static ui_cmd_t screen, matrix;
+    bool have_screen = false, have_matrix = false;
+
+    uint32_t head = __atomic_load_n(&queue_head, __ATOMIC_ACQUIRE);
+    uint32_t tail = queue_tail;
+    TRACE_BEGIN(UI, head - tail);
+    while (tail != head) {
+        const ui_cmd_t *cmd = &queue[tail & UI_QUEUE_MASK];
+        if (cmd->type == UI_CMD_MATRIX) {
+            matrix = *cmd;
+            have_matrix = true;
+        } else {
+            screen = *cmd;
+            have_screen = true;
+        }
+        tail++;
+    }
+    __atomic_store_n(&queue_tail, tail, __ATOMIC_RELEASE);
+
+    if (have_matrix) {
+        ui_render(&matrix);
+    }
+    if (have_screen) {
+        ui_render(&screen);
+    }
+    TRACE_END(UI, have_matrix | have_screen << 1);
+}
+#endif
+
+/**
+ * @brief Entrega um comando ao núcleo 1 (ou o executa em linha se UI_CORE1 for 0)
+ * @note Só espera se a fila estiver cheia, o que exige 16 comandos sem o
+ *       núcleo 1 ter sido escalonado
+ */
+static void ui_post(const ui_cmd_t *cmd) {
+#if UI_CORE1
+    uint32_t head = queue_head;
+    while (head - __atomic_load_n(&queue_tail, __ATOMIC_ACQUIRE) >= UI_QUEUE_SIZE) {
+        hal_core1_signal();
+        hal_wait_until(hal_time_us_64() + 100);
+    }
+    queue[head & UI_QUEUE_MASK] = *cmd;
+    __atomic_store_n(&queue_head, head + 1, __ATOMIC_RELEASE);
+    hal_core1_signal();
+#else
+    ui_render(cmd);
+#endif
+}
+
+/**
+ * @brief Prepara a fila e inicia o laço de renderização no núcleo 1
+ * @note O display e a matriz devem estar inicializados
+ */
+void ui_init(void) {
+#if UI_CORE1
+    queue_head = 0;
+    queue_tail = 0;
+    hal_core1_start(ui_process, NULL);
+#endif
+}
+
+static void ui_copy_line(char *dst, const char *src) {
+    if (src == NULL) {
+        dst[0] = '\0';
+        return;
+    }
+    strncpy(dst, src, UI_LINE_MAX);
+    dst[UI_LINE_MAX] = '\0';
+}
+
+void ui_message(const char *msg1, const char *msg2, const char *msg3) {
+    ui_cmd_t cmd;
+    cmd.type = UI_CMD_MESSAGE;
+    ui_copy_line(cmd.lines[0], msg1);
+    ui_copy_line(cmd.lines[1], msg2);
+    ui_copy_line(cmd.lines[2], msg3);
+    ui_post(&cmd);
+}
+
+void ui_menu(uint8_t selected) {
+    ui_cmd_t cmd;
+    cmd.type = UI_CMD_MENU;
+    cmd.menu_selected = selected;
+    ui_post(&cmd);
+}
+
+void ui_display_off(void) {
+    ui_cmd_t cmd;
+    cmd.type = UI_CMD_DISPLAY_OFF;
+    ui_post(&cmd);
+}
+
+void ui_matrix(const uint32_t *frame) {
+    ui_cmd_t cmd;
+    cmd.type = UI_CMD_MATRIX;
+    memcpy(cmd.frame, frame, sizeof(cmd.frame));
+    ui_post(&cmd);
+}
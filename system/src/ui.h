@@ -0,0 +1,38 @@
+#ifndef UI_H
+#define UI_H
+
+#include "src/hal/hal.h"
+
+// 1: display e matriz são atualizados pelo núcleo 1; 0: no próprio núcleo 0
+#ifndef UI_CORE1
+#define UI_CORE1 1
+#endif
+
+#define UI_QUEUE_SIZE 16     // Comandos pendentes (potência de 2)
+#define UI_LINE_MAX   16     // Caracteres por linha (128 px / fonte de 8 px)
+#define UI_MATRIX_LEDS 25
+
+typedef enum {
+    UI_CMD_MESSAGE,
+    UI_CMD_MENU,
+    UI_CMD_DISPLAY_OFF,
+    UI_CMD_MATRIX
+} ui_cmd_type_t;
+
+typedef struct {
+    uint8_t type;
+    union {
+        char lines[3][UI_LINE_MAX + 1];
+        uint8_t menu_selected;
+        uint32_t frame[UI_MATRIX_LEDS];
+    };
+} ui_cmd_t;
+
+// Prototipação das funções da interface (chamadas pelo núcleo 0)
+void ui_init(void);
+void ui_message(const char *msg1, const char *msg2, const char *msg3);
+void ui_menu(uint8_t selected);
+void ui_display_off(void);
+void ui_matrix(const uint32_t *frame);
+
+#endif // UI_H
@@ -0,0 +1,70 @@
+#include "src/verify_pipeline.h"
+
+#include <string.h>
+
+/*
+ * Decisão de acesso a partir de verificações independentes.
+ *
+ * Cada fator (senha, voz, íris) é uma verificação que o fluxo inicia e
+ * conclui quando quiser; várias podem estar em andamento ao mesmo tempo. A
+ * política é aplicada a cada conclusão: a falha de um fator obrigatório nega
+ * na hora, sem esperar os demais, e a aprovação do último obrigatório
+ * concede. Resultados que chegam depois da decisão só têm a duração
+ * registrada. O tempo até a decisão conta do início da tentativa.
+ */
+
+static int factor_index(uint8_t factor) {
+    int i = 0;
+    while (i < VERIFY_MAX_FACTORS - 1 && !(factor & (1u << i))) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief Inicia uma tentativa
+ * @param required Fatores cuja falha nega e cuja aprovação conjunta concede
+ */
+void verify_begin(verify_pipeline_t *p, uint8_t required) {
+    memset(p, 0, sizeof(*p));
+    p->required = required;
+    p->decision = required ? VERIFY_PENDING : VERIFY_GRANTED;
+    p->start_us = hal_time_us_32();
+}
+
+void verify_job_start(verify_pipeline_t *p, uint8_t factor) {
+    p->running |= factor;
+    p->job_start_us[factor_index(factor)] = hal_time_us_32();
+}
+
+/**
+ * @brief Conclui a verificação de um fator e aplica a política
+ * @return Decisão atual (a primeira tomada não muda mais)
+ */
+verify_decision_t verify_job_done(verify_pipeline_t *p, uint8_t factor, bool pass) {
+    uint32_t now = hal_time_us_32();
+    int i = factor_index(factor);
+    p->job_us[i] = now - p->job_start_us[i];
+    p->running &= (uint8_t)~factor;
+    if (pass) {
+        p->passed |= factor;
+    } else {
+        p->failed |= factor;
+    }
+
+    if (p->decision == VERIFY_PENDING) {
+        if (p->failed & p->required) {
+            p->decision = VERIFY_DENIED;
+        } else if ((p->passed & p->required) == p->required) {
+            p->decision = VERIFY_GRANTED;
+        }
+        if (p->decision != VERIFY_PENDING) {
+            p->decision_us = now - p->start_us;
+        }
+    }
+    return p->decision;
+}
+
+uint32_t verify_job_us(const verify_pipeline_t *p, uint8_t factor) {
+    return p->job_us[factor_index(factor)];
+}
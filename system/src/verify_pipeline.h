@@ -0,0 +1,33 @@
+#ifndef VERIFY_PIPELINE_H
+#define VERIFY_PIPELINE_H
+
+#include "src/hal/hal.h"
+
+// Fatores são identificados por bits (até 8); o fluxo de acesso usa LOG_FACTOR_*
+#define VERIFY_MAX_FACTORS 8
+
+typedef enum {
+    VERIFY_PENDING,                 // Ainda faltam fatores obrigatórios
+    VERIFY_GRANTED,                 // Todos os obrigatórios aprovados
+    VERIFY_DENIED                   // Um obrigatório falhou
+} verify_decision_t;
+
+typedef struct {
+    uint8_t required;               // Fatores que decidem; os demais só são registrados
+    uint8_t running;                // Verificações em andamento
+    uint8_t passed;
+    uint8_t failed;
+    verify_decision_t decision;
+    uint32_t start_us;              // Início da tentativa (senha digitada)
+    uint32_t decision_us;           // Tempo até a decisão; 0 enquanto pendente
+    uint32_t job_start_us[VERIFY_MAX_FACTORS];
+    uint32_t job_us[VERIFY_MAX_FACTORS];    // Duração de cada verificação concluída
+} verify_pipeline_t;
+
+// Prototipação das funções da verificação por fatores
+void verify_begin(verify_pipeline_t *p, uint8_t required);
+void verify_job_start(verify_pipeline_t *p, uint8_t factor);
+verify_decision_t verify_job_done(verify_pipeline_t *p, uint8_t factor, bool pass);
+uint32_t verify_job_us(const verify_pipeline_t *p, uint8_t factor);
+
+#endif // VERIFY_PIPELINE_H
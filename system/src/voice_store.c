@@ -0,0 +1,105 @@
+#include "src/voice_store.h"
+#include "src/crc32.h"
+
+#include <string.h>
+
+/*
+ * Modelos de voz cadastrados, guardados na flash.
+ *
+ * Segue o esquema do cadastro de senhas: dois bancos gravados
+ * alternadamente, cada um com cabeçalho, número de sequência e CRC dos
+ * modelos. A gravação vai sempre para o banco que não está em uso, então
+ * uma gravação interrompida deixa os modelos anteriores válidos.
+ */
+
+#define VOICE_MAGIC   0x45434F56u  // "VOCE"
+#define VOICE_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t sequence;
+    uint32_t crc;                   // CRC-32 do cabeçalho (até aqui) e dos modelos
+} voice_header_t;
+
+_Static_assert(sizeof(voice_header_t) + VOICEPRINT_MAX_TEMPLATES * sizeof(voiceprint_template_t) <= VOICE_BANK_SIZE,
+               "Os modelos de voz não cabem em um banco");
+
+static uint32_t sequence;
+static uint8_t bank;                // Banco com os modelos atuais
+
+static uint32_t voice_crc(const voice_header_t *h, const voiceprint_template_t *t) {
+    uint32_t crc = crc32_update(0, h, offsetof(voice_header_t, crc));
+    return crc32_update(crc, t, h->count * sizeof(voiceprint_template_t));
+}
+
+static const voice_header_t *bank_header(uint8_t b) {
+    return (const voice_header_t *)hal_flash_data(VOICE_FLASH_OFFSET + b * VOICE_BANK_SIZE);
+}
+
+static bool bank_valid(uint8_t b) {
+    const voice_header_t *h = bank_header(b);
+    if (h->magic != VOICE_MAGIC || h->version != VOICE_VERSION || h->count > VOICEPRINT_MAX_TEMPLATES) {
+        return false;
+    }
+    return voice_crc(h, (const voiceprint_template_t *)(h + 1)) == h->crc;
+}
+
+/**
+ * @brief Carrega os modelos do banco válido mais recente da flash
+ * @return Quantidade de modelos; 0 se a flash não tiver modelos gravados
+ */
+uint8_t voice_store_load(voiceprint_store_t *store) {
+    bool valid0 = bank_valid(0);
+    bool valid1 = bank_valid(1);
+    store->count = 0;
+    if (!valid0 && !valid1) {
+        sequence = 0;
+        bank = 1;                   // A primeira gravação vai para o banco 0
+        return 0;
+    }
+
+    // Sequência comparada por diferença para tolerar a volta do contador
+    bank = valid1 && (!valid0 || (int32_t)(bank_header(1)->sequence - bank_header(0)->sequence) > 0);
+    const voice_header_t *h = bank_header(bank);
+    sequence = h->sequence;
+    store->count = (uint8_t)h->count;
+    memcpy(store->templates, h + 1, h->count * sizeof(voiceprint_template_t));
+    return store->count;
+}
+
+/**
+ * @brief Grava os modelos no banco livre; só passa a usá-lo depois de gravado
+ * @note Pausa a CPU por ~45 ms por setor apagado e ~1 ms por página: chamar
+ *       fora dos fluxos de acesso
+ */
+void voice_store_save(const voiceprint_store_t *store) {
+    voice_header_t header = {
+        .magic = VOICE_MAGIC,
+        .version = VOICE_VERSION,
+        .count = store->count,
+        .sequence = ++sequence,
+    };
+    header.crc = voice_crc(&header, store->templates);
+
+    uint8_t target = bank ^ 1u;
+    uint32_t base = VOICE_FLASH_OFFSET + target * VOICE_BANK_SIZE;
+    uint32_t size = sizeof(header) + store->count * sizeof(voiceprint_template_t);
+    uint32_t sectors = (size + HAL_FLASH_SECTOR_SIZE - 1) / HAL_FLASH_SECTOR_SIZE;
+    hal_flash_erase(base, sectors * HAL_FLASH_SECTOR_SIZE);
+
+    // Cabeçalho e modelos são contíguos na imagem, mas não na RAM
+    const uint8_t *templates = (const uint8_t *)store->templates;
+    uint8_t page[HAL_FLASH_PAGE_SIZE];
+    for (uint32_t offset = 0; offset < size; offset += HAL_FLASH_PAGE_SIZE) {
+        memset(page, 0xFF, sizeof(page));
+        uint32_t len = size - offset < sizeof(page) ? size - offset : sizeof(page);
+        for (uint32_t i = 0; i < len; i++) {
+            uint32_t at = offset + i;
+            page[i] = at < sizeof(header) ? ((const uint8_t *)&header)[at] : templates[at - sizeof(header)];
+        }
+        hal_flash_program(base + offset, page, sizeof(page));
+    }
+    bank = target;
+}
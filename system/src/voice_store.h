@@ -0,0 +1,17 @@
+#ifndef VOICE_STORE_H
+#define VOICE_STORE_H
+
+#include "src/hal/hal.h"
+#include "src/credentials.h"
+#include "src/voiceprint.h"
+
+// Região da flash de dados logo após o cadastro de senhas: dois bancos de 2 setores
+#define VOICE_FLASH_OFFSET (CRED_FLASH_OFFSET + CRED_FLASH_SIZE)
+#define VOICE_BANK_SIZE    (2 * HAL_FLASH_SECTOR_SIZE)
+#define VOICE_FLASH_SIZE   (2 * VOICE_BANK_SIZE)
+
+// Prototipação das funções dos modelos de voz em flash
+uint8_t voice_store_load(voiceprint_store_t *store);
+void voice_store_save(const voiceprint_store_t *store);
+
+#endif // VOICE_STORE_H
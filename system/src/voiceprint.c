@@ -0,0 +1,358 @@
+#include "src/voiceprint.h"
+#include <string.h>
+
+/*
+ * Verificação de locutor por modelo de frase (voiceprint), em ponto fixo.
+ *
+ * Extração (por quadro de 32 ms, a cada 16 ms):
+ *   remoção de DC -> pré-ênfase -> janela de Hamming -> normalização de bloco
+ *   -> FFT radix-2 de 256 pontos em Q15 (escala 1/2 por estágio) -> potência
+ *   -> banco mel triangular -> log2 em Q8 -> DCT-II -> c1..c12.
+ * Ao fim da captura, os quadros de silêncio das pontas são descartados pela
+ * energia e a média de cada coeficiente é subtraída (CMN), o que remove o
+ * ganho do microfone e a coloração do canal.
+ *
+ * Comparação: DTW simétrico com distância L1, restrito a uma faixa em torno
+ * da diagonal, com duas linhas de custo e abandono antecipado quando a linha
+ * inteira já supera a melhor distância encontrada.
+ *
+ * Tudo usa uma única tabela de seno (quarto de onda, Q15): fatores da FFT,
+ * janela e base da DCT.
+ */
+
+#define PREEMPHASIS_Q15 31785       // 0,97
+#define HAMMING_A_Q15   17695       // 0,54
+#define HAMMING_B_Q15   15073       // 0,46
+#define DTW_INF         (UINT32_MAX / 2)
+
+// sin(2πk/256) em Q15, k = 0..64
+static const int16_t quarter_sine_q15[65] = {
+    0, 804, 1608, 2410, 3212, 4011, 4808, 5602, 6393,
+    7179, 7962, 8739, 9512, 10278, 11039, 11793, 12539, 13279,
+    14010, 14732, 15446, 16151, 16846, 17530, 18204, 18868, 19519,
+    20159, 20787, 21403, 22005, 22594, 23170, 23731, 24279, 24811,
+    25329, 25832, 26319, 26790, 27245, 27683, 28105, 28510, 28898,
+    29268, 29621, 29956, 30273, 30571, 30852, 31113, 31356, 31580,
+    31785, 31971, 32137, 32285, 32412, 32521, 32609, 32678, 32728,
+    32757, 32767,
+};
+
+// Bordas dos filtros mel (bins de 31,25 Hz), de 125 Hz a 3,8 kHz
+static const uint8_t mel_edges[VOICEPRINT_MEL_BANDS + 2] = {
+    4, 7, 10, 13, 17, 21, 26, 31, 36, 42, 49, 57, 65, 74, 84, 96, 108, 122
+};
+
+static uint32_t dtw_rows[2][VOICEPRINT_MAX_FRAMES + 1];
+
+static int32_t sin_q15(uint32_t i) {
+    i &= 255;
+    if (i <= 64) {
+        return quarter_sine_q15[i];
+    }
+    if (i <= 128) {
+        return quarter_sine_q15[128 - i];
+    }
+    if (i <= 192) {
+        return -quarter_sine_q15[i - 128];
+    }
+    return -quarter_sine_q15[256 - i];
+}
+
+static int32_t cos_q15(uint32_t i) {
+    return sin_q15(i + 64);
+}
+
+static int16_t clamp_i16(int32_t v) {
+    return v > INT16_MAX ? INT16_MAX : v < INT16_MIN ? INT16_MIN : (int16_t)v;
+}
+
+// log2(x) em Q8, com correção quadrática da mantissa (erro < 0,01)
+static int32_t log2_q8(uint64_t x) {
+    if (x == 0) {
+        return 0;
+    }
+    int32_t msb = 63 - __builtin_clzll(x);
+    uint32_t f = (uint32_t)(msb >= 8 ? x >> (msb - 8) : x << (8 - msb)) & 255;
+    return msb * 256 + (int32_t)(f + ((f * (256 - f) * 88) >> 16));
+}
+
+// FFT complexa de 256 pontos, in-place, com saída escalada por 1/256
+static void fft256(int16_t *re, int16_t *im) {
+    for (uint32_t i = 0, j = 0; i < VOICEPRINT_FRAME_SAMPLES; i++) {
+        if (i < j) {
+            int16_t t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+        uint32_t bit = VOICEPRINT_FRAME_SAMPLES >> 1;
+        while (j & bit) {
+            j ^= bit;
+            bit >>= 1;
+        }
+        j |= bit;
+    }
+
+    for (uint32_t size = 2; size <= VOICEPRINT_FRAME_SAMPLES; size <<= 1) {
+        uint32_t half = size >> 1;
+        uint32_t step = VOICEPRINT_FRAME_SAMPLES / size;
+        for (uint32_t k = 0; k < half; k++) {
+            int32_t c = cos_q15(k * step);
+            int32_t s = sin_q15(k * step);
+            for (uint32_t i = k; i < VOICEPRINT_FRAME_SAMPLES; i += size) {
+                uint32_t j = i + half;
+                int32_t tr = (c * re[j] + s * im[j]) >> 15;
+                int32_t ti = (c * im[j] - s * re[j]) >> 15;
+                re[j] = (int16_t)((re[i] - tr) >> 1);
+                im[j] = (int16_t)((im[i] - ti) >> 1);
+                re[i] = (int16_t)((re[i] + tr) >> 1);
+                im[i] = (int16_t)((im[i] + ti) >> 1);
+            }
+        }
+    }
+}
+
+static uint32_t bin_power(const voiceprint_frontend_t *fe, uint32_t k) {
+    return (uint32_t)((int32_t)fe->re[k] * fe->re[k]) + (uint32_t)((int32_t)fe->im[k] * fe->im[k]);
+}
+
+static void frontend_frame(voiceprint_frontend_t *fe) {
+    voiceprint_utterance_t *utt = fe->utt;
+    if (utt->frames >= VOICEPRINT_MAX_FRAMES) {
+        return;
+    }
+    int16_t *feat = utt->feat[utt->frames];
+
+    int32_t peak = 0;
+    for (uint32_t n = 0; n < VOICEPRINT_FRAME_SAMPLES; n++) {
+        int32_t w = HAMMING_A_Q15 - ((HAMMING_B_Q15 * cos_q15(n)) >> 15);
+        int32_t v = (fe->samples[n] * w) >> 15;
+        fe->re[n] = (int16_t)v;
+        fe->im[n] = 0;
+        if (v < 0) {
+            v = -v;
+        }
+        if (v > peak) {
+            peak = v;
+        }
+    }
+    if (peak == 0) {
+        memset(feat, 0, VOICEPRINT_CEPS * sizeof(int16_t));
+        utt->energy[utt->frames++] = INT16_MIN;
+        return;
+    }
+
+    // Normalização de bloco: leva o pico a [2^13, 2^14) para aproveitar os 16 bits
+    uint32_t shift = 0;
+    while ((peak << shift) < 8192) {
+        shift++;
+    }
+    for (uint32_t n = 0; n < VOICEPRINT_FRAME_SAMPLES; n++) {
+        fe->re[n] = (int16_t)(fe->re[n] << shift);
+    }
+
+    fft256(fe->re, fe->im);
+
+    uint64_t total = 0;
+    for (uint32_t k = 0; k <= VOICEPRINT_FRAME_SAMPLES / 2; k++) {
+        total += bin_power(fe, k);
+    }
+
+    int32_t logmel[VOICEPRINT_MEL_BANDS];
+    for (uint32_t b = 0; b < VOICEPRINT_MEL_BANDS; b++) {
+        uint32_t lo = mel_edges[b], mid = mel_edges[b + 1], hi = mel_edges[b + 2];
+        uint64_t acc = 1;
+        for (uint32_t k = lo + 1; k < hi; k++) {
+            uint32_t w = k < mid ? (k - lo) * 256 / (mid - lo) : (hi - k) * 256 / (hi - mid);
+            acc += (uint64_t)bin_power(fe, k) * w;
+        }
+        logmel[b] = log2_q8(acc);
+    }
+
+    // c_k = (2/M)·Σ logmel[m]·cos(πk(m+½)/M); o ganho do bloco só afeta c0, que não é usado
+    for (uint32_t k = 1; k <= VOICEPRINT_CEPS; k++) {
+        int32_t sum = 0;
+        for (uint32_t m = 0; m < VOICEPRINT_MEL_BANDS; m++) {
+            sum += (logmel[m] * cos_q15(4 * k * (2 * m + 1))) >> 15;
+        }
+        feat[k - 1] = clamp_i16(sum >> 3);
+    }
+    utt->energy[utt->frames++] = clamp_i16(log2_q8(total) - (int32_t)(2 * shift * 256));
+}
+
+/**
+ * @brief Prepara a extração de uma nova frase em utt
+ */
+void voiceprint_frontend_init(voiceprint_frontend_t *fe, voiceprint_utterance_t *utt) {
+    fe->fill = 0;
+    fe->dc_q8 = 0;
+    fe->prev = 0;
+    fe->primed = false;
+    fe->utt = utt;
+    utt->frames = 0;
+}
+
+/**
+ * @brief Acrescenta uma amostra do ADC (12-bit); fecha um quadro a cada 128 amostras
+ * @note Amostras além de VOICEPRINT_MAX_FRAMES quadros são descartadas
+ */
+void voiceprint_frontend_push(voiceprint_frontend_t *fe, uint16_t sample) {
+    int32_t x_q8 = (int32_t)sample << 8;
+    if (!fe->primed) {
+        fe->dc_q8 = x_q8;
+        fe->primed = true;
+    }
+    fe->dc_q8 += (x_q8 - fe->dc_q8) >> 6;
+    int32_t x = (x_q8 - fe->dc_q8) >> 8;
+
+    fe->samples[fe->fill++] = clamp_i16(x - ((PREEMPHASIS_Q15 * fe->prev) >> 15));
+    fe->prev = (int16_t)x;
+
+    if (fe->fill == VOICEPRINT_FRAME_SAMPLES) {
+        frontend_frame(fe);
+        memmove(fe->samples, fe->samples + VOICEPRINT_HOP_SAMPLES,
+                (VOICEPRINT_FRAME_SAMPLES - VOICEPRINT_HOP_SAMPLES) * sizeof(int16_t));
+        fe->fill = VOICEPRINT_FRAME_SAMPLES - VOICEPRINT_HOP_SAMPLES;
+    }
+}
+
+/**
+ * @brief Recorta o silêncio das pontas e normaliza a média dos coeficientes
+ * @return false se restar menos que VOICEPRINT_MIN_FRAMES quadros de fala
+ */
+bool voiceprint_utterance_finish(voiceprint_utterance_t *utt) {
+    if (utt->frames == 0) {
+        return false;
+    }
+    int32_t peak = INT16_MIN;
+    for (uint16_t i = 0; i < utt->frames; i++) {
+        if (utt->energy[i] > peak) {
+            peak = utt->energy[i];
+        }
+    }
+    int32_t floor = peak - VOICEPRINT_VAD_RANGE_Q8;
+    uint16_t first = 0, last = utt->frames - 1;
+    while (first < last && utt->energy[first] < floor) {
+        first++;
+    }
+    while (last > first && utt->energy[last] < floor) {
+        last--;
+    }
+    uint16_t n = last - first + 1;
+    memmove(utt->feat, utt->feat[first], n * sizeof(utt->feat[0]));
+    memmove(utt->energy, &utt->energy[first], n * sizeof(utt->energy[0]));
+    utt->frames = n;
+
+    for (uint32_t c = 0; c < VOICEPRINT_CEPS; c++) {
+        int32_t sum = 0;
+        for (uint16_t i = 0; i < n; i++) {
+            sum += utt->feat[i][c];
+        }
+        int32_t mean = sum / n;
+        for (uint16_t i = 0; i < n; i++) {
+            utt->feat[i][c] = clamp_i16(utt->feat[i][c] - mean);
+        }
+    }
+    return n >= VOICEPRINT_MIN_FRAMES;
+}
+
+/**
+ * @brief Guarda a frase (já finalizada) como novo modelo
+ * @return false se o cadastro estiver cheio ou a frase for curta demais
+ */
+bool voiceprint_enroll(voiceprint_store_t *store, const voiceprint_utterance_t *utt) {
+    if (store->count >= VOICEPRINT_MAX_TEMPLATES || utt->frames < VOICEPRINT_MIN_FRAMES) {
+        return false;
+    }
+    voiceprint_template_t *tpl = &store->templates[store->count++];
+    memcpy(tpl->feat, utt->feat, utt->frames * sizeof(utt->feat[0]));
+    tpl->frames = utt->frames;
+    return true;
+}
+
+static uint32_t frame_l1(const int16_t *a, const int16_t *b) {
+    uint32_t d = 0;
+    for (uint32_t c = 0; c < VOICEPRINT_CEPS; c++) {
+        int32_t diff = a[c] - b[c];
+        d += (uint32_t)(diff < 0 ? -diff : diff);
+    }
+    return d;
+}
+
+// Distância DTW média por passo, ou VOICEPRINT_REJECT se ultrapassar limit
+static uint32_t dtw_distance(const int16_t (*a)[VOICEPRINT_CEPS], uint16_t na,
+                             const int16_t (*b)[VOICEPRINT_CEPS], uint16_t nb, uint32_t limit) {
+    if (na == 0 || nb == 0 || na > 2 * nb || nb > 2 * na) {
+        return VOICEPRINT_REJECT;
+    }
+    uint64_t limit_total = (uint64_t)limit * (na + nb);
+    uint32_t *prev = dtw_rows[0];
+    uint32_t *cur = dtw_rows[1];
+
+    prev[0] = 0;
+    for (uint16_t j = 1; j <= nb; j++) {
+        prev[j] = DTW_INF;
+    }
+    for (uint16_t i = 1; i <= na; i++) {
+        // A faixa acompanha a diagonal (i·nb/na), não apenas i = j
+        int32_t center = (int32_t)((uint32_t)i * nb / na);
+        int32_t jlo = center - VOICEPRINT_DTW_BAND < 1 ? 1 : center - VOICEPRINT_DTW_BAND;
+        int32_t jhi = center + VOICEPRINT_DTW_BAND > nb ? nb : center + VOICEPRINT_DTW_BAND;
+        for (uint16_t j = 0; j <= nb; j++) {
+            cur[j] = DTW_INF;
+        }
+        uint32_t row_min = DTW_INF;
+        for (int32_t j = jlo; j <= jhi; j++) {
+            uint32_t d = frame_l1(a[i - 1], b[j - 1]);
+            uint32_t best = prev[j - 1] + 2 * d;
+            if (prev[j] + d < best) {
+                best = prev[j] + d;
+            }
+            if (cur[j - 1] + d < best) {
+                best = cur[j - 1] + d;
+            }
+            cur[j] = best < DTW_INF ? best : DTW_INF;
+            if (cur[j] < row_min) {
+                row_min = cur[j];
+            }
+        }
+        // Todo caminho atravessa esta linha e os custos só crescem
+        if (row_min >= limit_total) {
+            return VOICEPRINT_REJECT;
+        }
+        uint32_t *t = prev;
+        prev = cur;
+        cur = t;
+    }
+    if (prev[nb] >= DTW_INF) {
+        return VOICEPRINT_REJECT;
+    }
+    return prev[nb] / (na + nb);
+}
+
+/**
+ * @brief Menor distância DTW entre a frase e os modelos cadastrados
+ */
+uint32_t voiceprint_distance(const voiceprint_store_t *store, const voiceprint_utterance_t *utt) {
+    uint32_t best = VOICEPRINT_REJECT;
+    for (uint8_t t = 0; t < store->count; t++) {
+        const voiceprint_template_t *tpl = &store->templates[t];
+        uint32_t d = dtw_distance((const int16_t (*)[VOICEPRINT_CEPS])utt->feat, utt->frames,
+                                  (const int16_t (*)[VOICEPRINT_CEPS])tpl->feat, tpl->frames, best);
+        if (d < best) {
+            best = d;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Verifica a frase contra os modelos
+ * @param distance Recebe a menor distância (pode ser NULL)
+ * @return true se a distância ficar abaixo de VOICEPRINT_ACCEPT_DISTANCE
+ */
+bool voiceprint_verify(const voiceprint_store_t *store, const voiceprint_utterance_t *utt, uint32_t *distance) {
+    uint32_t d = utt->frames >= VOICEPRINT_MIN_FRAMES ? voiceprint_distance(store, utt) : VOICEPRINT_REJECT;
+    if (distance != NULL) {
+        *distance = d;
+    }
+    return d <= VOICEPRINT_ACCEPT_DISTANCE;
+}
@@ -0,0 +1,62 @@
+#ifndef VOICEPRINT_H
+#define VOICEPRINT_H
+
+#include "src/hal/hal.h"
+
+// Análise: quadros de 256 amostras (32 ms a 8 kHz) a cada 128 amostras (16 ms)
+#define VOICEPRINT_FRAME_SAMPLES 256
+#define VOICEPRINT_HOP_SAMPLES   128
+#define VOICEPRINT_MEL_BANDS     16     // Filtros triangulares de 125 Hz a 3,8 kHz
+#define VOICEPRINT_CEPS          12     // Coeficientes cepstrais c1..c12 por quadro
+#define VOICEPRINT_MAX_FRAMES    96     // Frase de até ~1,5 s
+#define VOICEPRINT_MAX_TEMPLATES 3
+
+#define VOICEPRINT_VAD_RANGE_Q8  (7 * 256)  // Quadros até ~21 dB abaixo do pico são fala
+#define VOICEPRINT_MIN_FRAMES    12         // Fala mínima para cadastrar ou verificar (~200 ms)
+#define VOICEPRINT_DTW_BAND      12         // Raio da faixa de Sakoe-Chiba (quadros)
+
+// Distância DTW média por quadro aceita na verificação
+#ifndef VOICEPRINT_ACCEPT_DISTANCE
+#define VOICEPRINT_ACCEPT_DISTANCE 600
+#endif
+
+#define VOICEPRINT_REJECT UINT32_MAX
+
+// Sequência de vetores de características (coeficientes em log2 Q8)
+typedef struct {
+    int16_t feat[VOICEPRINT_MAX_FRAMES][VOICEPRINT_CEPS];
+    int16_t energy[VOICEPRINT_MAX_FRAMES];  // Energia do quadro em log2 Q8
+    uint16_t frames;
+} voiceprint_utterance_t;
+
+// Estado da extração incremental; re/im são o espaço de trabalho da FFT
+typedef struct {
+    int16_t samples[VOICEPRINT_FRAME_SAMPLES];
+    uint16_t fill;
+    int32_t dc_q8;
+    int16_t prev;
+    bool primed;
+    int16_t re[VOICEPRINT_FRAME_SAMPLES];
+    int16_t im[VOICEPRINT_FRAME_SAMPLES];
+    voiceprint_utterance_t *utt;
+} voiceprint_frontend_t;
+
+typedef struct {
+    int16_t feat[VOICEPRINT_MAX_FRAMES][VOICEPRINT_CEPS];
+    uint16_t frames;
+} voiceprint_template_t;
+
+typedef struct {
+    voiceprint_template_t templates[VOICEPRINT_MAX_TEMPLATES];
+    uint8_t count;
+} voiceprint_store_t;
+
+// Prototipação das funções de extração, cadastro e verificação
+void voiceprint_frontend_init(voiceprint_frontend_t *fe, voiceprint_utterance_t *utt);
+void voiceprint_frontend_push(voiceprint_frontend_t *fe, uint16_t sample);
+bool voiceprint_utterance_finish(voiceprint_utterance_t *utt);
+bool voiceprint_enroll(voiceprint_store_t *store, const voiceprint_utterance_t *utt);
+uint32_t voiceprint_distance(const voiceprint_store_t *store, const voiceprint_utterance_t *utt);
+bool voiceprint_verify(const voiceprint_store_t *store, const voiceprint_utterance_t *utt, uint32_t *distance);
+
+#endif // VOICEPRINT_H